@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Starts a dedicated server and N headless bot clients on this machine (loopback only),
+# lets them drive for a while and collects the server load report.
+#
+# Usage: Scripts/RunBotSwarm.sh <NumClients> [DurationSeconds]
+#
+# Environment overrides:
+#   BINARIES   Directory with VehicleSimCPPServer and VehicleSimCPP (default Binaries/Linux)
+#   MAP        Map the server loads (default /Engine/Maps/Templates/OpenWorld)
+#   PORT       Server port (default 7777)
+#   TICKRATE   Server tick rate (default 30)
+#   BOTMODE    Random or Scripted (default Random)
+#   INTERVAL   Server stats report interval in seconds (default 10)
+
+set -euo pipefail
+
+NUM_CLIENTS=${1:?usage: RunBotSwarm.sh <NumClients> [DurationSeconds]}
+DURATION=${2:-120}
+
+PROJECT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BINARIES=${BINARIES:-"$PROJECT_DIR/Binaries/Linux"}
+MAP=${MAP:-/Engine/Maps/Templates/OpenWorld}
+PORT=${PORT:-7777}
+TICKRATE=${TICKRATE:-30}
+BOTMODE=${BOTMODE:-Random}
+INTERVAL=${INTERVAL:-10}
+LOG_DIR="$PROJECT_DIR/Saved/BotSwarm/$(date +%Y%m%d-%H%M%S)"
+
+mkdir -p "$LOG_DIR"
+PIDS=()
+
+cleanup()
+{
+    for PID in "${PIDS[@]}"; do
+        kill "$PID" 2>/dev/null || true
+    done
+    wait 2>/dev/null || true
+}
+trap cleanup EXIT
+
+echo "Starting server on port $PORT ($TICKRATE Hz), logs in $LOG_DIR"
+"$BINARIES/VehicleSimCPPServer" "$MAP" -port="$PORT" -TickRate="$TICKRATE" \
+    -VehicleServerStats="$INTERVAL" -unattended -log -abslog="$LOG_DIR/Server.log" &
+SERVER_PID=$!
+PIDS+=("$SERVER_PID")
+
+# Give the server time to load the map before clients connect
+sleep 10
+
+for ((i = 0; i < NUM_CLIENTS; i++)); do
+    "$BINARIES/VehicleSimCPP" 127.0.0.1:"$PORT" -nullrhi -nosound -unattended -nosplash \
+        -VehicleBot="$BOTMODE" -BotSeed="$i" -abslog="$LOG_DIR/Bot_$i.log" >/dev/null 2>&1 &
+    PIDS+=("$!")
+    # Stagger connections so the join burst doesn't dominate the measurement
+    sleep 0.2
+done
+
+echo "$NUM_CLIENTS bots connected, driving for $DURATION seconds"
+sleep "$DURATION"
+
+cleanup
+trap - EXIT
+
+echo "Server report:"
+grep "VehicleServerStats:" "$LOG_DIR/Server.log" | tail -n 5 || true
+echo "CSV reports are in $PROJECT_DIR/Saved/Profiling (ServerStats-*.csv, ServerConnections-*.csv)"
@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# Runs the canned performance scenario (a fixed fleet of scripted bots, see
+# UVehiclePerfScenarioSubsystem) with the CSV profiler and checks the capture against a
+# stored baseline. Exits non-zero when p95 frame time or peak memory regressed.
+#
+# Usage: Scripts/RunPerfGate.sh [--update-baseline]
+#
+# Environment overrides:
+#   BINARIES          Directory with VehicleSimCPP and VehicleTelemetryTool (default Binaries/Linux)
+#   MAP               Map the scenario runs on (default /Game/Maps/MyMap)
+#   BASELINE          Baseline file (default Config/PerfBaseline.csv)
+#   THRESHOLD         Allowed p95 frame time regression in percent (default 5)
+#   MEMORY_THRESHOLD  Allowed peak memory regression in percent (default 5)
+
+set -euo pipefail
+
+PROJECT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BINARIES=${BINARIES:-"$PROJECT_DIR/Binaries/Linux"}
+MAP=${MAP:-/Game/Maps/MyMap}
+BASELINE=${BASELINE:-"$PROJECT_DIR/Config/PerfBaseline.csv"}
+THRESHOLD=${THRESHOLD:-5}
+MEMORY_THRESHOLD=${MEMORY_THRESHOLD:-5}
+CAPTURE_NAME="PerfGate-$(date +%Y%m%d-%H%M%S)"
+CAPTURE="$PROJECT_DIR/Saved/Profiling/CSV/$CAPTURE_NAME.csv"
+
+EXTRA_ARGS=()
+if [[ "${1:-}" == "--update-baseline" ]]; then
+    EXTRA_ARGS+=(-UpdateBaseline)
+fi
+
+# A fixed step keeps the amount of simulated work per frame the same between runs
+echo "Running performance scenario on $MAP, capture $CAPTURE_NAME"
+"$BINARIES/VehicleSimCPP" "$MAP" -VehiclePerfScenario="$CAPTURE_NAME" -UseFixedTimeStep -FPS=60 \
+    -unattended -nosound -nosplash -abslog="$PROJECT_DIR/Saved/Logs/$CAPTURE_NAME.log"
+
+if [[ ! -f "$CAPTURE" ]]; then
+    echo "No capture at $CAPTURE" >&2
+    exit 1
+fi
+
+"$BINARIES/VehicleTelemetryTool" -PerfGate "$CAPTURE" -Baseline="$BASELINE" \
+    -Threshold="$THRESHOLD" -MemoryThreshold="$MEMORY_THRESHOLD" "${EXTRA_ARGS[@]}"
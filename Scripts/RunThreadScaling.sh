@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+# Runs the thread-scaling benchmark (UVehicleThreadScalingSubsystem) once per core limit from 1
+# to MAX_THREADS and prints steps per second, speedup and parallel efficiency per workload.
+# An efficiency that drops off early points at a serial part of that workload.
+#
+# Usage: Scripts/RunThreadScaling.sh [MaxThreads]
+#
+# Environment overrides:
+#   BINARIES   Directory with VehicleSimCPP (default Binaries/Linux)
+#   MAP        Map the benchmark runs on (default /Game/Maps/MyMap)
+
+set -euo pipefail
+
+PROJECT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+MAX_THREADS=${1:-$(nproc)}
+BINARIES=${BINARIES:-"$PROJECT_DIR/Binaries/Linux"}
+MAP=${MAP:-/Game/Maps/MyMap}
+RESULTS="$PROJECT_DIR/Saved/Benchmarks/VehicleThreadScaling.csv"
+LOG_DIR="$PROJECT_DIR/Saved/Benchmarks/ThreadScaling-$(date +%Y%m%d-%H%M%S)"
+
+mkdir -p "$LOG_DIR"
+rm -f "$RESULTS"
+
+# -corelimit caps the cores the engine sizes its task graph and physics workers for
+for ((THREADS = 1; THREADS <= MAX_THREADS; THREADS++)); do
+    echo "Running with -corelimit=$THREADS"
+    "$BINARIES/VehicleSimCPP" "$MAP" -VehicleThreadScaling -corelimit="$THREADS" -benchmark -FPS=60 \
+        -nullrhi -nosound -nosplash -unattended -abslog="$LOG_DIR/Threads_$THREADS.log"
+done
+
+# Speedup and efficiency are relative to each workload's single-thread row
+awk -F, 'NR > 1 && $1 != "Threads" {
+        if (!($3 in Base)) { Base[$3] = $6; BaseThreads[$3] = $1 }
+        Speedup = $6 / Base[$3]
+        printf "%-8s %3d threads %3d workers %10.1f steps/s  speedup %5.2fx  efficiency %5.1f%%\n",
+            $3, $1, $2, $6, Speedup, 100 * Speedup * BaseThreads[$3] / $1
+    }' "$RESULTS" | sort -s -k1,1
+echo "Raw results in $RESULTS, logs in $LOG_DIR"
@@ -0,0 +1,244 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "VehicleBase.h"
+#include "VehicleStats.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Microbenchmarks for the vehicle hot paths. They need no rendering, so they run headless:
+//
+//   UnrealEditor-Cmd VehicleSimCPP.uproject -ExecCmds="Automation RunTests VehicleSim.Benchmarks; Quit" -nullrhi -unattended
+//
+// Every benchmark logs its median and p99 and appends a JSON line to
+// Saved/Benchmarks/VehicleSimBenchmarks.jsonl.
+
+struct FVehicleBaseTestAccess
+{
+    // The mesh sections CreateBoxMesh builds, without its log line (a formatted, flushed
+    // warning would otherwise be a large share of each sample)
+    static void CreateMeshSections(AVehicleBase& Vehicle)
+    {
+        Vehicle.CreateCarBody();
+        Vehicle.CreateWindows();
+        Vehicle.CreateWheels();
+    }
+};
+
+namespace
+{
+    // A standalone game world without a game mode, so nothing but the benchmark runs in it
+    class FVehicleBenchmarkWorld
+    {
+    public:
+        FVehicleBenchmarkWorld()
+        {
+            World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("VehicleBenchmarkWorld"));
+            FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+            Context.SetCurrentWorld(World);
+            World->InitializeActorsForPlay(FURL());
+            World->BeginPlay();
+
+            // What the game mode's StartPlay would do: actors spawned from here on get BeginPlay
+            World->GetWorldSettings()->NotifyBeginPlay();
+        }
+
+        ~FVehicleBenchmarkWorld()
+        {
+            GEngine->DestroyWorldContext(World);
+            World->DestroyWorld(false);
+        }
+
+        AVehicleBase* SpawnVehicle(const FVector& Location) const
+        {
+            const FTransform Transform(Location);
+            AVehicleBase* Vehicle = World->SpawnActorDeferred<AVehicleBase>(AVehicleBase::StaticClass(), Transform);
+            Vehicle->bAutoPossessFirstPlayer = false;
+            Vehicle->FinishSpawning(Transform);
+            return Vehicle;
+        }
+
+        UWorld* World = nullptr;
+    };
+
+    // Vehicles on a grid with room to drive between them
+    FVector GetGridLocation(int32 Index)
+    {
+        return FVector((Index % 32) * 600.0f, (Index / 32) * 400.0f, 100.0f);
+    }
+
+    void ReportBenchmark(FAutomationTestBase& Test, const FString& Name, TArray<double>& SamplesMs)
+    {
+        const FVehicleTimingSummary Summary = FVehicleTimingSummary::FromSamples(SamplesMs);
+        Test.AddInfo(FString::Printf(TEXT("%s: %s (ms)"), *Name, *Summary.ToString()));
+
+        const FString Line = FString::Printf(TEXT("{\"benchmark\":\"%s\",\"time\":\"%s\",\"count\":%d,\"median_ms\":%.6f,\"p99_ms\":%.6f,\"mean_ms\":%.6f,\"min_ms\":%.6f,\"max_ms\":%.6f}\n"),
+            *Name, *FDateTime::UtcNow().ToIso8601(), Summary.Count, Summary.Median, Summary.P99, Summary.Mean, Summary.Min, Summary.Max);
+        const FString Filename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("VehicleSimBenchmarks.jsonl"));
+        FFileHelper::SaveStringToFile(Line, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+    }
+
+    // Times Body once per iteration, after a few untimed warm-up calls
+    template<typename FunctionType>
+    TArray<double> Measure(int32 Iterations, FunctionType&& Body)
+    {
+        constexpr int32 WarmupIterations = 3;
+        for (int32 i = 0; i < WarmupIterations; i++)
+        {
+            Body(i);
+        }
+
+        TArray<double> SamplesMs;
+        SamplesMs.Reserve(Iterations);
+        for (int32 i = 0; i < Iterations; i++)
+        {
+            const uint64 StartCycles = FPlatformTime::Cycles64();
+            Body(i);
+            SamplesMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+        }
+        return SamplesMs;
+    }
+}
+
+// AVehicleBase logs its setup (and missing player controllers) at warning and error level,
+// which is expected in an empty benchmark world
+class FVehicleBenchmarkTestBase : public FAutomationTestBase
+{
+public:
+    FVehicleBenchmarkTestBase(const FString& InName, const bool bInComplexTask)
+        : FAutomationTestBase(InName, bInComplexTask)
+    {
+    }
+
+    virtual bool SuppressLogErrors() override { return true; }
+    virtual bool SuppressLogWarnings() override { return true; }
+};
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FVehicleMeshBenchmark, FVehicleBenchmarkTestBase, "VehicleSim.Benchmarks.MeshGeneration", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FVehicleMeshBenchmark::RunTest(const FString& Parameters)
+{
+    FVehicleBenchmarkWorld BenchmarkWorld;
+    AVehicleBase* Vehicle = BenchmarkWorld.SpawnVehicle(FVector::ZeroVector);
+    if (!TestNotNull(TEXT("Vehicle"), Vehicle))
+    {
+        return false;
+    }
+
+    TArray<double> SamplesMs = Measure(200, [Vehicle](int32)
+    {
+        FVehicleBaseTestAccess::CreateMeshSections(*Vehicle);
+    });
+    ReportBenchmark(*this, TEXT("MeshGeneration"), SamplesMs);
+    return true;
+}
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FVehicleMovementBenchmark, FVehicleBenchmarkTestBase, "VehicleSim.Benchmarks.MovementSolve", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FVehicleMovementBenchmark::RunTest(const FString& Parameters)
+{
+    FVehicleBenchmarkWorld BenchmarkWorld;
+    constexpr int32 NumVehicles = 100;
+    TArray<AVehicleBase*> Vehicles;
+    for (int32 i = 0; i < NumVehicles; i++)
+    {
+        Vehicles.Add(BenchmarkWorld.SpawnVehicle(GetGridLocation(i)));
+    }
+
+    // One sample is one vehicle's move (translate with sweep, then yaw) at 60 Hz
+    uint16 Sequence = 1;
+    TArray<double> SamplesMs = Measure(NumVehicles * 50, [&Vehicles, &Sequence](int32 Iteration)
+    {
+        const float Steering = (Iteration / NumVehicles) % 2 == 0 ? 0.5f : -0.5f;
+        Vehicles[Iteration % NumVehicles]->SimulateMove(FVehicleMoveInput::Make(Sequence++, 1.0f / 60.0f, 1.0f, Steering, false));
+    });
+    ReportBenchmark(*this, TEXT("MovementSolve"), SamplesMs);
+    return true;
+}
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FVehicleSpawnBenchmark, FVehicleBenchmarkTestBase, "VehicleSim.Benchmarks.Spawn", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FVehicleSpawnBenchmark::RunTest(const FString& Parameters)
+{
+    FVehicleBenchmarkWorld BenchmarkWorld;
+
+    // Fewer repeats for the larger batches keep the whole test within a few seconds
+    const TPair<int32, int32> Batches[] = { { 1, 100 }, { 10, 30 }, { 100, 10 }, { 1000, 3 } };
+    for (const TPair<int32, int32>& Batch : Batches)
+    {
+        const int32 NumVehicles = Batch.Key;
+        TArray<double> BatchMs;
+        TArray<double> PerVehicleMs;
+        TArray<AVehicleBase*> Vehicles;
+        Vehicles.Reserve(NumVehicles);
+
+        for (int32 Repeat = 0; Repeat < Batch.Value; Repeat++)
+        {
+            const uint64 BatchStartCycles = FPlatformTime::Cycles64();
+            for (int32 i = 0; i < NumVehicles; i++)
+            {
+                const uint64 StartCycles = FPlatformTime::Cycles64();
+                Vehicles.Add(BenchmarkWorld.SpawnVehicle(GetGridLocation(i)));
+                PerVehicleMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+            }
+            BatchMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BatchStartCycles));
+
+            TestEqual(TEXT("Spawned vehicles"), Vehicles.FilterByPredicate([](const AVehicleBase* Vehicle) { return Vehicle != nullptr; }).Num(), NumVehicles);
+            for (AVehicleBase* Vehicle : Vehicles)
+            {
+                if (Vehicle)
+                {
+                    Vehicle->Destroy();
+                }
+            }
+            Vehicles.Reset();
+        }
+
+        ReportBenchmark(*this, FString::Printf(TEXT("Spawn%d"), NumVehicles), BatchMs);
+        ReportBenchmark(*this, FString::Printf(TEXT("Spawn%d.PerVehicle"), NumVehicles), PerVehicleMs);
+    }
+    return true;
+}
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FVehiclePossessionBenchmark, FVehicleBenchmarkTestBase, "VehicleSim.Benchmarks.Possession", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FVehiclePossessionBenchmark::RunTest(const FString& Parameters)
+{
+    FVehicleBenchmarkWorld BenchmarkWorld;
+    APlayerController* PlayerController = BenchmarkWorld.World->SpawnActor<APlayerController>();
+    AVehicleBase* Vehicle = BenchmarkWorld.SpawnVehicle(FVector::ZeroVector);
+    if (!TestNotNull(TEXT("PlayerController"), PlayerController) || !TestNotNull(TEXT("Vehicle"), Vehicle))
+    {
+        return false;
+    }
+
+    // The same lookup and possess AVehicleBase::BeginPlay does for the first player
+    TArray<double> SamplesMs;
+    for (int32 i = 0; i < 200; i++)
+    {
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+        APlayerController* FirstPlayer = BenchmarkWorld.World->GetFirstPlayerController();
+        if (FirstPlayer)
+        {
+            FirstPlayer->Possess(Vehicle);
+        }
+        SamplesMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+
+        if (!TestTrue(TEXT("Vehicle possessed"), PlayerController->GetPawn() == Vehicle))
+        {
+            return false;
+        }
+        PlayerController->UnPossess();
+    }
+
+    ReportBenchmark(*this, TEXT("Possession"), SamplesMs);
+    return true;
+}
+
+#endif
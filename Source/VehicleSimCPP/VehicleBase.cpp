@@ -1,10 +1,16 @@
 #include "VehicleBase.h"
+#include "VehicleSimCPP.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
 #include "Engine/Engine.h"
 #include "GameFramework/PlayerController.h"
 #include "Engine/World.h"
+#include "ChaosWheeledVehicleMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "VehicleProximitySubsystem.h"
+#include "VehicleReplay.h"
+#include "VehicleSnapshot.h"
 
 AVehicleBase::AVehicleBase()
 {
@@ -12,6 +18,15 @@ AVehicleBase::AVehicleBase()
     
     PrimaryActorTick.bCanEverTick = true;
 
+    // Replicate our own compact state instead of the default full precision FRepMovement
+    bReplicates = true;
+    SetReplicatingMovement(false);
+    NetUpdateFrequency = 30.0f;
+
+#if !UE_SERVER
+    // Visual-only components. Dedicated server builds skip the mesh, spring arm and camera
+    // entirely; movement sweeps use the root component so the simulation is unaffected.
+
     // Create procedural mesh component
     ProceduralMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("ProceduralMesh"));
     ProceduralMesh->SetupAttachment(RootComponent);
@@ -34,6 +49,9 @@ AVehicleBase::AVehicleBase()
     UCameraComponent* Camera = CreateDefaultSubobject<UCameraComponent>(TEXT("Camera"));
     Camera->SetupAttachment(SpringArm);
     Camera->SetFieldOfView(90.0f);                // Wider FOV for racing feel
+#else
+    ProceduralMesh = nullptr;
+#endif
     
     UE_LOG(LogTemp, Warning, TEXT("VehicleBase: Constructor finished - procedural mesh created"));
 }
@@ -44,9 +62,18 @@ void AVehicleBase::BeginPlay()
     
     Super::BeginPlay();
     
-    // Force possession by finding the first player controller
+    // Force possession by finding the first player controller.
+    // In networked games the game mode gives every player their own vehicle, so only do this standalone.
     UWorld* World = GetWorld();
-    if (World)
+    if (World && GetNetMode() != NM_Standalone)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehicleBase: Networked game - leaving possession to the game mode"));
+    }
+    else if (World && !bAutoPossessFirstPlayer)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehicleBase: Auto possession disabled for %s"), *GetName());
+    }
+    else if (World)
     {
         APlayerController* PC = World->GetFirstPlayerController();
         if (PC)
@@ -75,12 +102,417 @@ void AVehicleBase::BeginPlay()
         UE_LOG(LogTemp, Error, TEXT("VehicleBase: World is null!"));
     }
     
+    LastTickLocation = GetActorLocation();
+
+    if (UVehicleProximitySubsystem* Proximity = World ? World->GetSubsystem<UVehicleProximitySubsystem>() : nullptr)
+    {
+        Proximity->RegisterVehicle(this);
+    }
+
+    // Headless load test clients: -VehicleBot=Random|Scripted drives the player's vehicle
+    EVehicleBotMode BotMode = EVehicleBotMode::Disabled;
+    int32 BotSeed = 0;
+    if (GetNetMode() != NM_DedicatedServer && FVehicleBotInputGenerator::ParseCommandLine(BotMode, BotSeed))
+    {
+        EnableBotDriver(BotMode, BotSeed);
+    }
+
     UE_LOG(LogTemp, Warning, TEXT("VehicleBase: BeginPlay() completed"));
 }
 
+void AVehicleBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UVehicleProximitySubsystem* Proximity = GetWorld() ? GetWorld()->GetSubsystem<UVehicleProximitySubsystem>() : nullptr)
+    {
+        Proximity->UnregisterVehicle(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void AVehicleBase::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
+
+    if (BotDriver.IsEnabled() && (IsLocallyControlled() || (HasAuthority() && !GetController())))
+    {
+        BotDriver.Generate(DeltaTime, ThrottleInput, SteeringInput, bBrakeInput);
+    }
+
+    if (GetLocalRole() == ROLE_AutonomousProxy)
+    {
+        TickLocalPrediction(DeltaTime);
+    }
+    else if (HasAuthority() && !IsDrivenByRemoteClient())
+    {
+        // Standalone, listen server host or AI driven: simulate the current input directly.
+        // Remote players' moves arrive through ServerSendMoves instead.
+        SimulateMove(FVehicleMoveInput::Make(NextMoveSequence++, DeltaTime, ThrottleInput, SteeringInput, bBrakeInput));
+    }
+
+    if (HasAuthority())
+    {
+        ReplicatedState.SetSnapshot(CaptureNetSnapshot(DeltaTime));
+    }
+
+#if !UE_SERVER
+    UpdateCorrectionSmoothing(DeltaTime);
+#endif
+}
+
+void AVehicleBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(AVehicleBase, ReplicatedState);
+}
+
+FVehicleNetSnapshot AVehicleBase::CaptureNetSnapshot(float DeltaTime)
+{
+    FVehicleNetSnapshot Snapshot;
+    Snapshot.Location = GetActorLocation();
+    Snapshot.Rotation = GetActorQuat();
+    Snapshot.Steering = SteeringInput;
+    Snapshot.Throttle = ThrottleInput;
+    Snapshot.bBraking = bBrakeInput;
+
+    // We move the actor directly, so derive velocity from the distance travelled this tick
+    if (DeltaTime > KINDA_SMALL_NUMBER)
+    {
+        Snapshot.Velocity = (Snapshot.Location - LastTickLocation) / DeltaTime;
+    }
+    LastTickLocation = Snapshot.Location;
+    Snapshot.LastProcessedMove = LastProcessedMove;
+
+    UChaosWheeledVehicleMovementComponent* WheeledMovement = Cast<UChaosWheeledVehicleMovementComponent>(GetVehicleMovementComponent());
+    if (WheeledMovement && WheeledMovement->Wheels.Num() > 0)
+    {
+        for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels && Wheel < WheeledMovement->Wheels.Num(); Wheel++)
+        {
+            if (const UChaosVehicleWheel* VehicleWheel = WheeledMovement->Wheels[Wheel])
+            {
+                Snapshot.WheelSpinDegrees[Wheel] = VehicleWheel->GetRotationAngle();
+                Snapshot.WheelSuspension[Wheel] = VehicleWheel->GetSuspensionOffset();
+            }
+        }
+    }
+    else
+    {
+        // No Chaos wheel setup: spin the wheels from forward travel (25 unit wheel radius)
+        const float ForwardSpeed = FVector::DotProduct(Snapshot.Velocity, GetActorForwardVector());
+        WheelSpinDegrees = FRotator::ClampAxis(WheelSpinDegrees + FMath::RadiansToDegrees(ForwardSpeed * DeltaTime / 25.0f));
+        for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+        {
+            Snapshot.WheelSpinDegrees[Wheel] = WheelSpinDegrees;
+        }
+    }
+
+    return Snapshot;
+}
+
+void AVehicleBase::OnRep_ReplicatedState()
+{
+    if (HasAuthority() || !ReplicatedState.HasValidState())
+    {
+        return;
+    }
+
+    const FVehicleNetSnapshot& Snapshot = ReplicatedState.GetSnapshot();
+
+    if (GetLocalRole() == ROLE_AutonomousProxy)
+    {
+        ReconcileWithServer(Snapshot);
+        return;
+    }
+
+    const FVector OldLocation = GetActorLocation();
+    const FQuat OldRotation = GetActorQuat();
+    SetActorLocationAndRotation(Snapshot.Location, Snapshot.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+    AddCorrectionOffset(OldLocation, OldRotation);
+
+    ThrottleInput = Snapshot.Throttle;
+    SteeringInput = Snapshot.Steering;
+    bBrakeInput = Snapshot.bBraking;
+}
+
+bool AVehicleBase::IsDrivenByRemoteClient() const
+{
+    const APlayerController* PC = Cast<APlayerController>(GetController());
+    return PC && !PC->IsLocalController();
+}
+
+void AVehicleBase::SetDriverInput(float Throttle, float Steering, bool bBrake)
+{
+    ThrottleInput = Throttle;
+    SteeringInput = Steering;
+    bBrakeInput = bBrake;
+}
+
+void AVehicleBase::EnableBotDriver(EVehicleBotMode Mode, int32 Seed)
+{
+    BotDriver.Initialize(Mode, Seed);
+    UE_LOG(LogTemp, Log, TEXT("VehicleBase: %s is bot driven (mode %d, seed %d)"), *GetName(), static_cast<int32>(Mode), Seed);
+}
+
+void AVehicleBase::CaptureSimState(FVehicleSimState& OutState) const
+{
+    OutState.Location = GetActorLocation();
+    OutState.Rotation = GetActorQuat();
+    OutState.LastTickLocation = LastTickLocation;
+
+    const UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(GetRootComponent());
+    const bool bSimulatingPhysics = Root && Root->IsSimulatingPhysics();
+    OutState.LinearVelocity = bSimulatingPhysics ? Root->GetPhysicsLinearVelocity() : FVector::ZeroVector;
+    OutState.AngularVelocity = bSimulatingPhysics ? Root->GetPhysicsAngularVelocityInDegrees() : FVector::ZeroVector;
+
+    OutState.Throttle = ThrottleInput;
+    OutState.Steering = SteeringInput;
+    OutState.bBrake = bBrakeInput;
+    OutState.BotDriver = BotDriver;
+    OutState.NextMoveSequence = NextMoveSequence;
+    OutState.LastProcessedMove = LastProcessedMove;
+    OutState.WheelSpinDegrees = WheelSpinDegrees;
+
+    OutState.NumWheels = 0;
+    if (const UChaosWheeledVehicleMovementComponent* WheeledMovement = Cast<UChaosWheeledVehicleMovementComponent>(GetVehicleMovementComponent()))
+    {
+        for (const UChaosVehicleWheel* VehicleWheel : WheeledMovement->Wheels)
+        {
+            if (OutState.NumWheels == FVehicleSimState::MaxWheels)
+            {
+                break;
+            }
+
+            FVehicleSimState::FWheel& Wheel = OutState.Wheels[OutState.NumWheels++];
+            Wheel.RotationAngle = VehicleWheel ? VehicleWheel->GetRotationAngle() : 0.0f;
+            Wheel.AngularVelocity = VehicleWheel ? VehicleWheel->GetRotationAngularVelocity() : 0.0f;
+            Wheel.SuspensionOffset = VehicleWheel ? VehicleWheel->GetSuspensionOffset() : 0.0f;
+        }
+    }
+}
+
+void AVehicleBase::RestoreSimState(const FVehicleSimState& State)
+{
+    SetActorLocationAndRotation(State.Location, State.Rotation, false, nullptr, ETeleportType::ResetPhysics);
+    LastTickLocation = State.LastTickLocation;
+
+    UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(GetRootComponent());
+    if (Root && Root->IsSimulatingPhysics())
+    {
+        Root->SetPhysicsLinearVelocity(State.LinearVelocity);
+        Root->SetPhysicsAngularVelocityInDegrees(State.AngularVelocity);
+    }
+
+    ThrottleInput = State.Throttle;
+    SteeringInput = State.Steering;
+    bBrakeInput = State.bBrake;
+    BotDriver = State.BotDriver;
+    NextMoveSequence = State.NextMoveSequence;
+    LastProcessedMove = State.LastProcessedMove;
+    WheelSpinDegrees = State.WheelSpinDegrees;
+
+    // Chaos only accepts wheel state from the physics thread, so its wheels restart at rest;
+    // they do not feed back into SimulateMove
+    if (UChaosWheeledVehicleMovementComponent* WheeledMovement = Cast<UChaosWheeledVehicleMovementComponent>(GetVehicleMovementComponent()))
+    {
+        WheeledMovement->ResetVehicle();
+    }
+
+    // Predictions and visual corrections belong to the timeline we left
+    MoveHistory.Reset();
+    CorrectionLocationOffset = FVector::ZeroVector;
+    CorrectionRotationOffset = FQuat::Identity;
+    ApplyCorrectionOffset();
+}
+
+void AVehicleBase::SimulateMove(const FVehicleMoveInput& Move)
+{
+    const float DeltaSeconds = Move.GetDeltaTime();
+    const float Throttle = Move.GetThrottle();
+    const float Steering = Move.GetSteering();
+
+    if (FMath::Abs(Throttle) > InputDeadZone)
+    {
+        // Drive along the current forward vector
+        const FVector MovementVelocity = GetActorForwardVector() * Throttle * MaxForwardSpeed;
+        AddActorWorldOffset(MovementVelocity * DeltaSeconds, true); // true = sweep for collision
+    }
+
+    if (FMath::Abs(Steering) > InputDeadZone)
+    {
+        // Steering rotates the actor around Z
+        AddActorLocalRotation(FRotator(0.0f, Steering * MaxYawRate * DeltaSeconds, 0.0f));
+    }
+
+    // Only authoritative moves are recorded; client prediction replays would duplicate them
+    if (HasAuthority())
+    {
+        if (UVehicleReplaySubsystem* Replay = GetWorld()->GetSubsystem<UVehicleReplaySubsystem>())
+        {
+            Replay->RecordMove(this, Move);
+        }
+    }
+}
+
+void AVehicleBase::TickLocalPrediction(float DeltaTime)
+{
+    // Apply the input immediately instead of waiting for the server round trip
+    const FVehicleMoveInput Move = FVehicleMoveInput::Make(NextMoveSequence++, DeltaTime, ThrottleInput, SteeringInput, bBrakeInput);
+    SimulateMove(Move);
+
+    // Remember the move until the server confirms it (the oldest entry drops if the buffer is full)
+    FPredictedMove Predicted;
+    Predicted.Move = Move;
+    Predicted.PostLocation = GetActorLocation();
+    Predicted.PostRotation = GetActorQuat();
+    MoveHistory.Push(Predicted);
+
+    // Send the newest move plus a few older ones in case the previous packets were lost
+    TArray<FVehicleMoveInput> Moves;
+    const int32 NumToSend = FMath::Min(RedundantMovesPerSend, MoveHistory.Num());
+    Moves.Reserve(NumToSend);
+    for (int32 i = MoveHistory.Num() - NumToSend; i < MoveHistory.Num(); i++)
+    {
+        Moves.Add(MoveHistory[i].Move);
+    }
+    ServerSendMoves(Moves);
+}
+
+void AVehicleBase::ServerSendMoves_Implementation(const TArray<FVehicleMoveInput>& Moves)
+{
+    // The client may simulate as much time as passed here since its last moves
+    const double Now = GetWorld()->GetTimeSeconds();
+    if (LastMoveBudgetTime >= 0.0)
+    {
+        MoveTimeBudget = FMath::Min(MoveTimeBudget + static_cast<float>(Now - LastMoveBudgetTime), MaxMoveTimeBudget);
+    }
+    LastMoveBudgetTime = Now;
+
+    // A well-behaved client never sends more than its redundant moves
+    for (int32 i = FMath::Max(0, Moves.Num() - RedundantMovesPerSend); i < Moves.Num(); i++)
+    {
+        const FVehicleMoveInput& Move = Moves[i];
+
+        // Skip repeats of moves we already applied
+        if (!FVehicleMoveInput::IsNewer(Move.Sequence, LastProcessedMove))
+        {
+            continue;
+        }
+
+        // Moves over budget are acknowledged but not simulated; the next snapshot corrects the client
+        const float DeltaTime = FMath::Min3(Move.GetDeltaTime(), MaxMoveDeltaTime, MoveTimeBudget);
+        if (DeltaTime < Move.GetDeltaTime())
+        {
+            UE_LOG(LogTemp, Verbose, TEXT("VehicleBase: Clamped move %u from %.4f to %.4f seconds"), Move.Sequence, Move.GetDeltaTime(), DeltaTime);
+        }
+        if (DeltaTime > 0.0f)
+        {
+            SimulateMove(FVehicleMoveInput::Make(Move.Sequence, DeltaTime, Move.GetThrottle(), Move.GetSteering(), Move.bBrake));
+            MoveTimeBudget -= DeltaTime;
+        }
+        LastProcessedMove = Move.Sequence;
+
+        ThrottleInput = Move.GetThrottle();
+        SteeringInput = Move.GetSteering();
+        bBrakeInput = Move.bBrake;
+    }
+}
+
+void AVehicleBase::ReconcileWithServer(const FVehicleNetSnapshot& Snapshot)
+{
+    // Drop the moves the server has already applied, keeping the prediction for the last one
+    bool bFoundAckedMove = false;
+    FPredictedMove AckedMove;
+    while (!MoveHistory.IsEmpty() && !FVehicleMoveInput::IsNewer(MoveHistory[0].Move.Sequence, Snapshot.LastProcessedMove))
+    {
+        if (MoveHistory[0].Move.Sequence == Snapshot.LastProcessedMove)
+        {
+            AckedMove = MoveHistory[0];
+            bFoundAckedMove = true;
+        }
+        MoveHistory.PopFront();
+    }
+
+    // Prediction matched the server (within quantization error): nothing to correct
+    constexpr float LocationTolerance = 2.0f;
+    constexpr float RotationTolerance = 0.01f; // radians
+    if (bFoundAckedMove
+        && FVector::DistSquared(AckedMove.PostLocation, Snapshot.Location) < FMath::Square(LocationTolerance)
+        && AckedMove.PostRotation.AngularDistance(Snapshot.Rotation) < RotationTolerance)
+    {
+        return;
+    }
+
+    // Rewind to the authoritative state and replay the moves the server hasn't seen yet
+    const FVector OldLocation = GetActorLocation();
+    const FQuat OldRotation = GetActorQuat();
+    SetActorLocationAndRotation(Snapshot.Location, Snapshot.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+    for (int32 i = 0; i < MoveHistory.Num(); i++)
+    {
+        FPredictedMove& Predicted = MoveHistory[i];
+        SimulateMove(Predicted.Move);
+        Predicted.PostLocation = GetActorLocation();
+        Predicted.PostRotation = GetActorQuat();
+    }
+
+    UE_LOG(LogTemp, Verbose, TEXT("VehicleBase: Corrected prediction by %.1f units, replayed %d moves"),
+           FVector::Dist(OldLocation, GetActorLocation()), MoveHistory.Num());
+
+    AddCorrectionOffset(OldLocation, OldRotation);
+}
+
+void AVehicleBase::AddCorrectionOffset(const FVector& OldLocation, const FQuat& OldRotation)
+{
+    const FVector LocationError = OldLocation - GetActorLocation();
+    if (LocationError.SizeSquared() > FMath::Square(MaxSmoothedCorrection))
+    {
+        // Too far off to blend (e.g. a respawn): snap
+        CorrectionLocationOffset = FVector::ZeroVector;
+        CorrectionRotationOffset = FQuat::Identity;
+    }
+    else
+    {
+        // Keep the visuals where they were on screen; the offset then decays to zero
+        CorrectionLocationOffset += LocationError;
+        CorrectionRotationOffset = CorrectionRotationOffset * OldRotation * GetActorQuat().Inverse();
+    }
+
+    ApplyCorrectionOffset();
+}
+
+void AVehicleBase::UpdateCorrectionSmoothing(float DeltaTime)
+{
+    if (CorrectionLocationOffset.IsNearlyZero() && CorrectionRotationOffset.Equals(FQuat::Identity))
+    {
+        return;
+    }
+
+    const float Alpha = CorrectionSmoothingTime > 0.0f ? 1.0f - FMath::Exp(-DeltaTime / CorrectionSmoothingTime) : 1.0f;
+    CorrectionLocationOffset *= 1.0f - Alpha;
+    CorrectionRotationOffset = FQuat::Slerp(CorrectionRotationOffset, FQuat::Identity, Alpha);
+
+    if (CorrectionLocationOffset.SizeSquared() < 0.01f && CorrectionRotationOffset.Equals(FQuat::Identity, 1.e-4f))
+    {
+        CorrectionLocationOffset = FVector::ZeroVector;
+        CorrectionRotationOffset = FQuat::Identity;
+    }
+
+    ApplyCorrectionOffset();
+}
+
+void AVehicleBase::ApplyCorrectionOffset()
+{
+    if (!ProceduralMesh)
+    {
+        return;
+    }
+
+    // Offsets are in world space; the mesh is attached to the root so convert to local space
+    const FQuat ActorRotation = GetActorQuat();
+    const FVector RelativeLocation = ActorRotation.UnrotateVector(CorrectionLocationOffset);
+    const FQuat RelativeRotation = ActorRotation.Inverse() * CorrectionRotationOffset * ActorRotation;
+    ProceduralMesh->SetRelativeLocationAndRotation(RelativeLocation, RelativeRotation);
 }
 
 void AVehicleBase::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -123,45 +555,25 @@ void AVehicleBase::MoveForward(float Value)
 {
     UE_LOG(LogTemp, Warning, TEXT("VehicleBase: MoveForward called with value: %f"), Value);
     
-    if (FMath::Abs(Value) > 0.1f) // Only move if significant input
-    {
-        // Get current forward vector
-        FVector ForwardVector = GetActorForwardVector();
-        
-        // Calculate movement velocity (simple approach: 500 units/sec max speed)
-        float MovementSpeed = 500.0f;
-        FVector MovementVelocity = ForwardVector * Value * MovementSpeed;
-        
-        // Apply movement to actor location
-        FVector DeltaTime = GetWorld()->GetDeltaSeconds() * MovementVelocity;
-        AddActorWorldOffset(DeltaTime, true); // true = sweep for collision
-        
-        UE_LOG(LogTemp, Warning, TEXT("VehicleBase: Moving forward with velocity: %s"), *MovementVelocity.ToString());
-    }
+    // Movement itself is applied in Tick through SimulateMove so it can be predicted and replayed
+    ThrottleInput = Value;
 }
 
 void AVehicleBase::MoveRight(float Value)
 {
     UE_LOG(LogTemp, Warning, TEXT("VehicleBase: MoveRight called with value: %f"), Value);
     
-    if (FMath::Abs(Value) > 0.1f) // Only move if significant input
-    {
-        // For turning/steering: rotate the actor around Z-axis
-        float TurnSpeed = 90.0f; // degrees per second
-        float DeltaSeconds = GetWorld()->GetDeltaSeconds();
-        FRotator DeltaRotation(0.0f, Value * TurnSpeed * DeltaSeconds, 0.0f);
-        
-        AddActorLocalRotation(DeltaRotation);
-        
-        UE_LOG(LogTemp, Warning, TEXT("VehicleBase: Turning with rotation: %s"), *DeltaRotation.ToString());
-    }
+    // Steering is applied in Tick through SimulateMove
+    SteeringInput = Value;
 }
 
 void AVehicleBase::Brake(float Value)
 {
     UE_LOG(LogTemp, Warning, TEXT("VehicleBase: Brake called with value: %f"), Value);
     
-    if (FMath::Abs(Value) > 0.1f) // Only brake if significant input
+    bBrakeInput = FMath::Abs(Value) > InputDeadZone;
+
+    if (bBrakeInput)
     {
         // Simple braking: just log for now since we're using direct transform movement
         // In a real vehicle system, this would affect the vehicle's momentum/physics
@@ -196,6 +608,8 @@ void AVehicleBase::OnSpacePressed()
 
 void AVehicleBase::CreateBoxMesh()
 {
+    LLM_SCOPE_BYTAG(VehicleSim_Mesh);
+
     if (!ProceduralMesh)
     {
         UE_LOG(LogTemp, Error, TEXT("ProceduralMesh component is null!"));
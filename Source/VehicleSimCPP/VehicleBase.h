@@ -4,8 +4,13 @@
 #include "ChaosVehicleWheel.h"
 #include "WheeledVehiclePawn.h"
 #include "ProceduralMeshComponent.h"
+#include "VehicleNetState.h"
+#include "VehicleRingBuffer.h"
+#include "VehicleBotInput.h"
 #include "VehicleBase.generated.h"
 
+struct FVehicleSimState;
+
 UCLASS()
 class VEHICLESIMCPP_API AVehicleBase : public AWheeledVehiclePawn
 {
@@ -16,18 +21,68 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Mesh")
     UProceduralMeshComponent* ProceduralMesh;
 
+    // Quantized, delta-compressed state sent to clients instead of FRepMovement
+    UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+    FVehicleReplicatedState ReplicatedState;
+
+    UFUNCTION()
+    void OnRep_ReplicatedState();
+
+    // Owning client -> server: the newest predicted moves (plus a few repeats to cover packet loss)
+    UFUNCTION(Server, Unreliable)
+    void ServerSendMoves(const TArray<FVehicleMoveInput>& Moves);
+
+    // How long a prediction error takes to blend out visually
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Networking")
+    float CorrectionSmoothingTime = 0.15f;
+
+    // Corrections larger than this snap instead of blending
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Networking")
+    float MaxSmoothedCorrection = 300.0f;
+
 public:
     virtual void Tick(float DeltaTime) override;
     virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
     void MoveForward(float Value);
     void MoveRight(float Value);
     void Brake(float Value);
 
+    // Drive the vehicle without a player (AI, bots, scripted scenarios)
+    void SetDriverInput(float Throttle, float Steering, bool bBrake);
+
+    float GetThrottleInput() const { return ThrottleInput; }
+    float GetSteeringInput() const { return SteeringInput; }
+    bool GetBrakeInput() const { return bBrakeInput; }
+
+    // Let a generated input stream drive this vehicle instead of the keyboard.
+    // Applies when the vehicle is locally controlled, or on the server when it has no controller.
+    void EnableBotDriver(EVehicleBotMode Mode, int32 Seed);
+    const FVehicleBotInputGenerator& GetBotDriver() const { return BotDriver; }
+
+    // One step of the movement model. Run by the server, by client prediction and when replaying.
+    void SimulateMove(const FVehicleMoveInput& Move);
+
+    // Full simulation state for checkpoints (UVehicleSnapshotSubsystem)
+    void CaptureSimState(FVehicleSimState& OutState) const;
+    void RestoreSimState(const FVehicleSimState& State);
+
+    // Movement model limits
+    static constexpr float MaxForwardSpeed = 500.0f;   // units per second
+    static constexpr float MaxYawRate = 90.0f;         // degrees per second
+    static constexpr float InputDeadZone = 0.1f;
+
+    // Standalone only: take over the first player controller on BeginPlay.
+    // Vehicles spawned for traffic or scenarios turn this off.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Vehicle")
+    bool bAutoPossessFirstPlayer = true;
+
     // Input action functions for debugging
     void OnWPressed();
     void OnSPressed();
@@ -36,6 +91,59 @@ public:
     void OnSpacePressed();
 
 private:
+    // Lets the automation benchmarks time the private mesh builders
+    friend struct FVehicleBaseTestAccess;
+
+    // Builds the replicated snapshot from the current actor state (server only)
+    FVehicleNetSnapshot CaptureNetSnapshot(float DeltaTime);
+
+    // Last input values, replicated as part of the vehicle state
+    float ThrottleInput = 0.0f;
+    float SteeringInput = 0.0f;
+    bool bBrakeInput = false;
+
+    FVehicleBotInputGenerator BotDriver;
+
+    FVector LastTickLocation = FVector::ZeroVector;
+    float WheelSpinDegrees = 0.0f;
+
+    // Client-side prediction
+    struct FPredictedMove
+    {
+        FVehicleMoveInput Move;
+        FVector PostLocation = FVector::ZeroVector;
+        FQuat PostRotation = FQuat::Identity;
+    };
+
+    static constexpr int32 MoveHistorySize = 64;
+    static constexpr int32 RedundantMovesPerSend = 3;
+
+    void TickLocalPrediction(float DeltaTime);
+    void ReconcileWithServer(const FVehicleNetSnapshot& Snapshot);
+    bool IsDrivenByRemoteClient() const;
+
+    TVehicleRingBuffer<FPredictedMove, MoveHistorySize> MoveHistory;
+    uint16 NextMoveSequence = 1;
+
+    // Server: last move received from the owning client (0 = none yet)
+    uint16 LastProcessedMove = 0;
+
+    // Server: limits on client moves. A single move covers at most MaxMoveDeltaTime, and the
+    // moves of a client may not simulate more time than has passed on the server, plus a small
+    // allowance for network jitter.
+    static constexpr float MaxMoveDeltaTime = 0.1f;
+    static constexpr float MaxMoveTimeBudget = 0.25f;
+    float MoveTimeBudget = 0.0f;
+    double LastMoveBudgetTime = -1.0;
+
+    // Visual-only offset that hides prediction corrections and snaps of remote vehicles
+    void AddCorrectionOffset(const FVector& OldLocation, const FQuat& OldRotation);
+    void UpdateCorrectionSmoothing(float DeltaTime);
+    void ApplyCorrectionOffset();
+
+    FVector CorrectionLocationOffset = FVector::ZeroVector;
+    FQuat CorrectionRotationOffset = FQuat::Identity;
+
     void CreateBoxMesh();
     void CreateCarBody();
     void CreateWindows();
@@ -0,0 +1,77 @@
+#include "VehicleBotInput.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+void FVehicleBotInputGenerator::Initialize(EVehicleBotMode InMode, int32 InSeed)
+{
+    Mode = InMode;
+    Random.Initialize(InSeed);
+    Time = 0.0f;
+    TimeUntilNewTarget = 0.0f;
+    Throttle = 0.0f;
+    Steering = 0.0f;
+}
+
+void FVehicleBotInputGenerator::Generate(float DeltaTime, float& OutThrottle, float& OutSteering, bool& bOutBrake)
+{
+    Time += DeltaTime;
+
+    if (Mode == EVehicleBotMode::Scripted)
+    {
+        // Full throttle while weaving left and right, with a one second brake every 20 seconds
+        OutThrottle = 1.0f;
+        OutSteering = 0.6f * FMath::Sin(Time * (2.0f * PI / 8.0f));
+        bOutBrake = FMath::Fmod(Time, 20.0f) > 19.0f;
+        return;
+    }
+
+    if (Mode == EVehicleBotMode::Random)
+    {
+        TimeUntilNewTarget -= DeltaTime;
+        if (TimeUntilNewTarget <= 0.0f)
+        {
+            PickNewRandomTarget();
+        }
+
+        // Move towards the target like a driver would rather than jumping to it
+        const float ResponseRate = 2.0f; // full range in half a second
+        Throttle = FMath::FInterpConstantTo(Throttle, TargetThrottle, DeltaTime, ResponseRate);
+        Steering = FMath::FInterpConstantTo(Steering, TargetSteering, DeltaTime, ResponseRate);
+
+        OutThrottle = Throttle;
+        OutSteering = Steering;
+        bOutBrake = bTargetBrake;
+        return;
+    }
+
+    OutThrottle = 0.0f;
+    OutSteering = 0.0f;
+    bOutBrake = false;
+}
+
+void FVehicleBotInputGenerator::PickNewRandomTarget()
+{
+    TimeUntilNewTarget = Random.FRandRange(0.5f, 2.5f);
+    TargetThrottle = Random.FRandRange(-0.3f, 1.0f);
+    TargetSteering = Random.FRandRange(-1.0f, 1.0f);
+    bTargetBrake = Random.FRand() < 0.1f;
+}
+
+bool FVehicleBotInputGenerator::ParseCommandLine(EVehicleBotMode& OutMode, int32& OutSeed)
+{
+    FString ModeName;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("VehicleBot="), ModeName))
+    {
+        return false;
+    }
+
+    OutMode = ModeName.Equals(TEXT("Scripted"), ESearchCase::IgnoreCase) ? EVehicleBotMode::Scripted : EVehicleBotMode::Random;
+
+    OutSeed = 0;
+    if (!FParse::Value(FCommandLine::Get(), TEXT("BotSeed="), OutSeed))
+    {
+        // Every bot process gets a different stream unless a seed was given
+        OutSeed = static_cast<int32>(FPlatformProcess::GetCurrentProcessId());
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+
+enum class EVehicleBotMode : uint8
+{
+    Disabled,
+    Random,     // Smoothed random throttle/steering targets
+    Scripted    // Repeating weave pattern, identical every run
+};
+
+// Generates driver input for vehicles without a human at the keyboard (load test bots, scenarios).
+// Fully determined by its mode and seed.
+struct VEHICLESIMCPP_API FVehicleBotInputGenerator
+{
+public:
+    void Initialize(EVehicleBotMode InMode, int32 InSeed);
+    bool IsEnabled() const { return Mode != EVehicleBotMode::Disabled; }
+
+    void Generate(float DeltaTime, float& OutThrottle, float& OutSteering, bool& bOutBrake);
+
+    // Reads -VehicleBot=Random|Scripted and -BotSeed=N. Returns false if bot mode wasn't requested.
+    static bool ParseCommandLine(EVehicleBotMode& OutMode, int32& OutSeed);
+
+    EVehicleBotMode GetMode() const { return Mode; }
+    const FRandomStream& GetRandomStream() const { return Random; }
+
+private:
+    void PickNewRandomTarget();
+
+    EVehicleBotMode Mode = EVehicleBotMode::Disabled;
+    FRandomStream Random;
+    float Time = 0.0f;
+
+    // Random mode
+    float TimeUntilNewTarget = 0.0f;
+    float TargetThrottle = 0.0f;
+    float TargetSteering = 0.0f;
+    bool bTargetBrake = false;
+    float Throttle = 0.0f;
+    float Steering = 0.0f;
+};
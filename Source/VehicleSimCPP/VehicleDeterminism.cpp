@@ -0,0 +1,167 @@
+#include "VehicleDeterminism.h"
+#include "VehicleBase.h"
+#include "VehicleSnapshot.h"
+#include "VehicleSimCPP.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Hash/xxhash.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+bool UVehicleDeterminismSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    FString Name;
+    return FParse::Value(FCommandLine::Get(), TEXT("VehicleDigest="), Name) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UVehicleDeterminismSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleDeterminismSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    FString Name;
+    FParse::Value(FCommandLine::Get(), TEXT("VehicleDigest="), Name);
+    const FString Filename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Determinism"), FPaths::SetExtension(Name, TEXT("vdigest")));
+
+    File = IFileManager::Get().CreateFileWriter(*Filename);
+    if (!File)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleDeterminism: Could not create %s"), *Filename);
+        return;
+    }
+
+    uint32 Magic = VehicleDigestFormat::Magic;
+    uint32 Version = VehicleDigestFormat::Version;
+    *File << Magic << Version;
+    UE_LOG(LogTemp, Log, TEXT("VehicleDeterminism: Writing step digests to %s"), *Filename);
+}
+
+void UVehicleDeterminismSubsystem::Deinitialize()
+{
+    if (File)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehicleDeterminism: %llu steps, final digest %016llx"), NumSteps, LastDigest);
+        File->Close();
+        delete File;
+        File = nullptr;
+    }
+
+    Super::Deinitialize();
+}
+
+TStatId UVehicleDeterminismSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleDeterminismSubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleDeterminismSubsystem::GatherFields(const AVehicleBase* Vehicle, VehicleDigestFormat::FVehicleFields& OutFields)
+{
+    FVehicleSimState State;
+    Vehicle->CaptureSimState(State);
+
+    OutFields = VehicleDigestFormat::FVehicleFields();
+    OutFields.NameHash = FCrc::StrCrc32(*Vehicle->GetName());
+    OutFields.RandomSeed = static_cast<uint32>(State.BotDriver.GetRandomStream().GetCurrentSeed());
+    for (int32 Axis = 0; Axis < 3; Axis++)
+    {
+        OutFields.Location[Axis] = State.Location[Axis];
+        OutFields.LinearVelocity[Axis] = State.LinearVelocity[Axis];
+        OutFields.AngularVelocity[Axis] = State.AngularVelocity[Axis];
+    }
+    OutFields.Rotation[0] = State.Rotation.X;
+    OutFields.Rotation[1] = State.Rotation.Y;
+    OutFields.Rotation[2] = State.Rotation.Z;
+    OutFields.Rotation[3] = State.Rotation.W;
+    OutFields.Throttle = State.Throttle;
+    OutFields.Steering = State.Steering;
+    OutFields.WheelSpinDegrees = State.WheelSpinDegrees;
+    OutFields.NextMoveSequence = State.NextMoveSequence;
+    OutFields.bBrake = State.bBrake ? 1 : 0;
+    for (int32 Wheel = 0; Wheel < FMath::Min(State.NumWheels, VehicleDigestFormat::MaxWheels); Wheel++)
+    {
+        OutFields.WheelRotation[Wheel] = State.Wheels[Wheel].RotationAngle;
+        OutFields.WheelSuspension[Wheel] = State.Wheels[Wheel].SuspensionOffset;
+    }
+}
+
+void UVehicleDeterminismSubsystem::UpdateVehicleOrder()
+{
+    // Only re-sorted when vehicles come or go: with none destroyed, an unchanged count means
+    // an unchanged set
+    int32 NumVehicles = 0;
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        NumVehicles++;
+    }
+    const bool bAllValid = !OrderedVehicles.ContainsByPredicate([](const TWeakObjectPtr<AVehicleBase>& Vehicle) { return !Vehicle.IsValid(); });
+    if (bAllValid && NumVehicles == OrderedVehicles.Num())
+    {
+        return;
+    }
+
+    OrderedVehicles.Reset();
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        OrderedVehicles.Add(*It);
+    }
+    OrderedVehicles.Sort([](const TWeakObjectPtr<AVehicleBase>& A, const TWeakObjectPtr<AVehicleBase>& B)
+    {
+        return A->GetFName().LexicalLess(B->GetFName());
+    });
+
+    // The stream identifies vehicles by name hash; the log maps them back
+    for (const TWeakObjectPtr<AVehicleBase>& Vehicle : OrderedVehicles)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehicleDeterminism: %08x = %s"), FCrc::StrCrc32(*Vehicle->GetName()), *Vehicle->GetName());
+    }
+    UE_LOG(LogTemp, Log, TEXT("VehicleDeterminism: Hashing %d vehicles from step %llu"), OrderedVehicles.Num(), NumSteps);
+}
+
+void UVehicleDeterminismSubsystem::Tick(float DeltaTime)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Telemetry);
+
+    if (!File)
+    {
+        return;
+    }
+
+    // Ticks after the world's tick groups, so every vehicle has finished this step
+    UpdateVehicleOrder();
+    Fields.SetNum(OrderedVehicles.Num(), EAllowShrinking::No);
+    for (int32 i = 0; i < OrderedVehicles.Num(); i++)
+    {
+        GatherFields(OrderedVehicles[i].Get(), Fields[i]);
+    }
+
+    VehicleDigestFormat::FStepHeader Header;
+    Header.Step = NumSteps++;
+    Header.Digest = FXxHash64::HashBuffer(Fields.GetData(), Fields.Num() * sizeof(VehicleDigestFormat::FVehicleFields)).Hash;
+    Header.DeltaTime = DeltaTime;
+    Header.NumVehicles = Fields.Num();
+    LastDigest = Header.Digest;
+
+    File->Serialize(&Header, sizeof(Header));
+    File->Serialize(Fields.GetData(), Fields.Num() * sizeof(VehicleDigestFormat::FVehicleFields));
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs DeterminismStatsCommand(
+        TEXT("vehicle.Determinism.Stats"),
+        TEXT("Logs the number of hashed steps and the latest digest"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (const UVehicleDeterminismSubsystem* Determinism = World ? World->GetSubsystem<UVehicleDeterminismSubsystem>() : nullptr)
+            {
+                UE_LOG(LogTemp, Log, TEXT("VehicleDeterminism: %llu steps, digest %016llx"), Determinism->GetNumSteps(), Determinism->GetLastDigest());
+            }
+        }));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleDigestFormat.h"
+#include "VehicleDeterminism.generated.h"
+
+class AVehicleBase;
+
+// Hashes the full state of every vehicle once per world step into a digest stream, enabled
+// with -VehicleDigest=<Name> (written to Saved/Determinism/<Name>.vdigest). Two runs of the
+// same scenario are compared with VehicleTelemetryTool -CompareDigests A B, which reports the
+// first step that differs and the fields that changed. Runs need a fixed step (-UseFixedTimeStep
+// -FPS=N) for their steps to line up.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleDeterminismSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    uint64 GetNumSteps() const { return NumSteps; }
+    uint64 GetLastDigest() const { return LastDigest; }
+
+    // Fields hashed for one vehicle
+    static void GatherFields(const AVehicleBase* Vehicle, VehicleDigestFormat::FVehicleFields& OutFields);
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    void UpdateVehicleOrder();
+
+    FArchive* File = nullptr;
+
+    // Vehicles sorted by name, so both runs hash them in the same order
+    TArray<TWeakObjectPtr<AVehicleBase>> OrderedVehicles;
+    TArray<VehicleDigestFormat::FVehicleFields> Fields;
+
+    uint64 NumSteps = 0;
+    uint64 LastDigest = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Determinism digest stream (little-endian), written by UVehicleDeterminismSubsystem:
+//
+//   Header    'VDGS', version
+//   Steps     FStepHeader, then NumVehicles x FVehicleFields ordered by vehicle name
+//
+// Digest is the 64-bit xxHash of the step's FVehicleFields, so two runs are compared step by
+// step on one number and the fields are only looked at once the digests differ. Both structs
+// have no padding, which keeps the hash of identical state identical.
+//
+// Only depends on Core; VehicleTelemetryTool -CompareDigests reads these files.
+namespace VehicleDigestFormat
+{
+    constexpr uint32 Magic = 0x53474456;    // "VDGS"
+    constexpr uint32 Version = 1;
+    constexpr int64 HeaderSize = 8;
+    constexpr int32 MaxWheels = 4;
+
+    struct FStepHeader
+    {
+        uint64 Step = 0;
+        uint64 Digest = 0;
+        double DeltaTime = 0.0;
+        uint32 NumVehicles = 0;
+        uint32 Reserved = 0;
+    };
+
+    struct FVehicleFields
+    {
+        uint32 NameHash = 0;
+        uint32 RandomSeed = 0;      // current seed of the bot driver's random stream
+        double Location[3] = {};
+        double Rotation[4] = {};    // x, y, z, w
+        double LinearVelocity[3] = {};
+        double AngularVelocity[3] = {};
+        float Throttle = 0.0f;
+        float Steering = 0.0f;
+        float WheelSpinDegrees = 0.0f;
+        uint16 NextMoveSequence = 0;
+        uint8 bBrake = 0;
+        uint8 Reserved = 0;
+        float WheelRotation[MaxWheels] = {};
+        float WheelSuspension[MaxWheels] = {};
+    };
+
+    static_assert(sizeof(FStepHeader) == 32, "Step header layout changed");
+    static_assert(sizeof(FVehicleFields) == 160, "Vehicle fields must not contain padding");
+}
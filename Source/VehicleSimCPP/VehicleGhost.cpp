@@ -0,0 +1,372 @@
+#include "VehicleGhost.h"
+#include "VehicleBase.h"
+#include "Algo/BinarySearch.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Paths.h"
+#include "UObject/ConstructorHelpers.h"
+
+namespace
+{
+    // Cube mesh scaled to the AVehicleBase body (240 x 100)
+    const FVector GhostInstanceScale(2.4f, 1.0f, 0.8f);
+
+    // Longest run of samples one key interval may replace, to bound compression time
+    constexpr int32 MaxSamplesPerKey = 256;
+
+    constexpr uint32 GhostFileMagic = 0x54534847;   // "GHST"
+    constexpr uint32 GhostFileVersion = 1;
+
+    FVector EvaluatePosition(const FVehicleGhostKey& A, const FVehicleGhostKey& B, float Alpha)
+    {
+        const float Span = B.Time - A.Time;
+        return FMath::CubicInterp(A.Location, FVector(A.Velocity) * Span, B.Location, FVector(B.Velocity) * Span, Alpha);
+    }
+
+    FQuat EvaluateRotation(const FVehicleGhostKey& A, const FVehicleGhostKey& B, float Alpha)
+    {
+        return FQuat(FQuat4f::Slerp(A.Rotation, B.Rotation, Alpha));
+    }
+}
+
+FVehicleGhostTrack FVehicleGhostTrack::Compress(TConstArrayView<FVehicleGhostSample> Samples, float PositionTolerance, float AngleTolerance)
+{
+    FVehicleGhostTrack Track;
+    const int32 NumSamples = Samples.Num();
+    if (NumSamples == 0)
+    {
+        return Track;
+    }
+
+    // Tangents from the raw samples (central differences)
+    auto MakeKey = [&Samples, NumSamples](int32 i)
+    {
+        const int32 Previous = FMath::Max(i - 1, 0);
+        const int32 Next = FMath::Min(i + 1, NumSamples - 1);
+        const float Span = Samples[Next].Time - Samples[Previous].Time;
+
+        FVehicleGhostKey Key;
+        Key.Time = Samples[i].Time;
+        Key.Location = Samples[i].Location;
+        Key.Velocity = Span > UE_SMALL_NUMBER ? FVector3f((Samples[Next].Location - Samples[Previous].Location) / Span) : FVector3f::ZeroVector;
+        Key.Rotation = FQuat4f(Samples[i].Rotation);
+        return Key;
+    };
+
+    const float AngleToleranceRadians = FMath::DegreesToRadians(AngleTolerance);
+    auto Fits = [&](const FVehicleGhostKey& A, const FVehicleGhostKey& B, int32 First, int32 Last)
+    {
+        const float Span = B.Time - A.Time;
+        for (int32 i = First; i <= Last; i++)
+        {
+            const float Alpha = Span > UE_SMALL_NUMBER ? (Samples[i].Time - A.Time) / Span : 0.0f;
+            if (FVector::DistSquared(EvaluatePosition(A, B, Alpha), Samples[i].Location) > FMath::Square(PositionTolerance)
+                || EvaluateRotation(A, B, Alpha).AngularDistance(Samples[i].Rotation) > AngleToleranceRadians)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Greedy: from each kept key, reach as far as the curve still fits every sample in between
+    Track.Keys.Add(MakeKey(0));
+    int32 Start = 0;
+    while (Start < NumSamples - 1)
+    {
+        const FVehicleGhostKey& StartKey = Track.Keys.Last();
+        int32 End = Start + 1;
+        while (End + 1 < NumSamples && End + 1 - Start <= MaxSamplesPerKey && Fits(StartKey, MakeKey(End + 1), Start + 1, End))
+        {
+            End++;
+        }
+        Track.Keys.Add(MakeKey(End));
+        Start = End;
+    }
+
+    return Track;
+}
+
+FTransform FVehicleGhostTrack::Evaluate(float Time, int32& InOutHint) const
+{
+    if (Keys.Num() == 0)
+    {
+        return FTransform::Identity;
+    }
+    if (Keys.Num() == 1 || Time <= Keys[0].Time)
+    {
+        return FTransform(FQuat(Keys[0].Rotation), Keys[0].Location);
+    }
+    if (Time >= Keys.Last().Time)
+    {
+        return FTransform(FQuat(Keys.Last().Rotation), Keys.Last().Location);
+    }
+
+    // Usually the same or the next interval; search only when the hint is off
+    int32 Index = FMath::Clamp(InOutHint, 0, Keys.Num() - 2);
+    if (Keys[Index].Time > Time || Keys[Index + 1].Time < Time)
+    {
+        if (Index + 2 < Keys.Num() && Keys[Index + 1].Time <= Time && Keys[Index + 2].Time >= Time)
+        {
+            Index++;
+        }
+        else
+        {
+            Index = FMath::Clamp(Algo::UpperBoundBy(Keys, Time, &FVehicleGhostKey::Time) - 1, 0, Keys.Num() - 2);
+        }
+    }
+    InOutHint = Index;
+
+    const FVehicleGhostKey& A = Keys[Index];
+    const FVehicleGhostKey& B = Keys[Index + 1];
+    const float Alpha = (Time - A.Time) / FMath::Max(B.Time - A.Time, UE_SMALL_NUMBER);
+    return FTransform(EvaluateRotation(A, B, Alpha), EvaluatePosition(A, B, Alpha));
+}
+
+FArchive& operator<<(FArchive& Ar, FVehicleGhostTrack& Track)
+{
+    int32 NumKeys = Track.Keys.Num();
+    Ar << NumKeys;
+    if (Ar.IsLoading())
+    {
+        Track.Keys.SetNum(NumKeys);
+    }
+    for (FVehicleGhostKey& Key : Track.Keys)
+    {
+        Ar << Key.Time << Key.Location << Key.Velocity << Key.Rotation;
+    }
+    return Ar;
+}
+
+bool FVehicleGhostTrack::SaveToFile(const FString& Filename) const
+{
+    TUniquePtr<FArchive> File(IFileManager::Get().CreateFileWriter(*Filename));
+    if (!File)
+    {
+        return false;
+    }
+
+    uint32 Magic = GhostFileMagic;
+    uint32 Version = GhostFileVersion;
+    *File << Magic << Version << const_cast<FVehicleGhostTrack&>(*this);
+    return File->Close();
+}
+
+bool FVehicleGhostTrack::LoadFromFile(const FString& Filename)
+{
+    TUniquePtr<FArchive> File(IFileManager::Get().CreateFileReader(*Filename));
+    if (!File)
+    {
+        return false;
+    }
+
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    *File << Magic << Version;
+    if (Magic != GhostFileMagic || Version != GhostFileVersion)
+    {
+        return false;
+    }
+    *File << *this;
+    return !File->IsError();
+}
+
+AVehicleGhostManager::AVehicleGhostManager()
+{
+    PrimaryActorTick.bCanEverTick = true;
+    // After the vehicles have moved, so a recorded lap sees this frame's pose
+    PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+    GhostInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("GhostInstances"));
+    RootComponent = GhostInstances;
+    GhostInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    GhostInstances->SetCastShadow(false);
+    GhostInstances->SetMobility(EComponentMobility::Movable);
+
+    static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMesh(TEXT("/Engine/BasicShapes/Cube.Cube"));
+    if (CubeMesh.Succeeded())
+    {
+        GhostInstances->SetStaticMesh(CubeMesh.Object);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleGhostManager: Failed to load ghost mesh"));
+    }
+}
+
+AVehicleGhostManager* AVehicleGhostManager::Get(UWorld* World)
+{
+    if (!World)
+    {
+        return nullptr;
+    }
+    for (TActorIterator<AVehicleGhostManager> It(World); It; ++It)
+    {
+        return *It;
+    }
+    return World->SpawnActor<AVehicleGhostManager>();
+}
+
+FString AVehicleGhostManager::GetBestLapPath() const
+{
+    const FString MapName = UGameplayStatics::GetCurrentLevelName(this, true);
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Ghosts"), MapName + TEXT(".ghost"));
+}
+
+void AVehicleGhostManager::BeginPlay()
+{
+    Super::BeginPlay();
+
+    TSharedRef<FVehicleGhostTrack> Saved = MakeShared<FVehicleGhostTrack>();
+    if (Saved->LoadFromFile(GetBestLapPath()))
+    {
+        BestLap = Saved;
+        UE_LOG(LogTemp, Log, TEXT("VehicleGhostManager: Loaded best lap, %.2f s in %d keys"), Saved->GetDuration(), Saved->GetNumKeys());
+    }
+}
+
+void AVehicleGhostManager::StartLap(AVehicleBase* Vehicle)
+{
+    RecordedVehicle = Vehicle;
+    Samples.Reset();
+    LapStartTime = GetWorld()->GetTimeSeconds();
+}
+
+void AVehicleGhostManager::FinishLap()
+{
+    if (!RecordedVehicle.IsValid() || Samples.Num() < 2)
+    {
+        return;
+    }
+    RecordedVehicle.Reset();
+
+    TSharedRef<FVehicleGhostTrack> Lap = MakeShared<FVehicleGhostTrack>(FVehicleGhostTrack::Compress(Samples, PositionTolerance, AngleTolerance));
+    UE_LOG(LogTemp, Log, TEXT("VehicleGhostManager: Lap %.2f s, %d samples compressed to %d keys"), Lap->GetDuration(), Samples.Num(), Lap->GetNumKeys());
+
+    if (!BestLap.IsValid() || Lap->GetDuration() < BestLap->GetDuration())
+    {
+        BestLap = Lap;
+        Lap->SaveToFile(GetBestLapPath());
+        UE_LOG(LogTemp, Log, TEXT("VehicleGhostManager: New best lap"));
+    }
+    Samples.Reset();
+}
+
+void AVehicleGhostManager::SpawnGhosts(int32 Count, float Spacing)
+{
+    if (!BestLap.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleGhostManager: No best lap to race against"));
+        return;
+    }
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    for (int32 i = 0; i < Count; i++)
+    {
+        Ghosts.Add(FGhost{ BestLap.ToSharedRef(), Now + i * Spacing, 0 });
+    }
+
+    GhostTransforms.SetNum(Ghosts.Num());
+    GhostInstances->ClearInstances();
+    GhostInstances->AddInstances(GhostTransforms, false, true);
+}
+
+void AVehicleGhostManager::ClearGhosts()
+{
+    Ghosts.Reset();
+    GhostTransforms.Reset();
+    GhostInstances->ClearInstances();
+}
+
+void AVehicleGhostManager::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    if (const AVehicleBase* Vehicle = RecordedVehicle.Get())
+    {
+        Samples.Add(FVehicleGhostSample{ static_cast<float>(Now - LapStartTime), Vehicle->GetActorLocation(), Vehicle->GetActorQuat() });
+    }
+
+    if (Ghosts.Num() == 0)
+    {
+        return;
+    }
+
+    for (int32 i = 0; i < Ghosts.Num(); i++)
+    {
+        FGhost& Ghost = Ghosts[i];
+        const float Duration = Ghost.Track->GetDuration();
+        float Time = static_cast<float>(Now - Ghost.StartTime);
+        if (bLoopGhosts && Duration > 0.0f && Time > Duration)
+        {
+            Time = FMath::Fmod(Time, Duration);
+        }
+
+        // Ghosts waiting for their start, or finished without looping, are hidden
+        FTransform& Transform = GhostTransforms[i];
+        Transform = Ghost.Track->Evaluate(Time, Ghost.Hint);
+        Transform.SetScale3D(Time < 0.0f || Time > Duration ? FVector::ZeroVector : GhostInstanceScale);
+    }
+
+    GhostInstances->BatchUpdateInstancesTransforms(0, GhostTransforms, true, true);
+}
+
+namespace
+{
+    AVehicleBase* GetPlayerVehicle(UWorld* World)
+    {
+        const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+        return PlayerController ? Cast<AVehicleBase>(PlayerController->GetPawn()) : nullptr;
+    }
+
+    FAutoConsoleCommandWithWorldAndArgs GhostStartLapCommand(
+        TEXT("vehicle.Ghost.StartLap"),
+        TEXT("Starts recording a lap of the player's vehicle"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            AVehicleBase* Vehicle = GetPlayerVehicle(World);
+            AVehicleGhostManager* Ghosts = Vehicle ? AVehicleGhostManager::Get(World) : nullptr;
+            if (Ghosts)
+            {
+                Ghosts->StartLap(Vehicle);
+            }
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs GhostFinishLapCommand(
+        TEXT("vehicle.Ghost.FinishLap"),
+        TEXT("Ends the recorded lap and keeps it if it is the best"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (AVehicleGhostManager* Ghosts = AVehicleGhostManager::Get(World))
+            {
+                Ghosts->FinishLap();
+            }
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs GhostRaceCommand(
+        TEXT("vehicle.Ghost.Race"),
+        TEXT("Replays the best lap as ghosts: vehicle.Ghost.Race [Count] [SpacingSeconds], Count 0 clears them"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            AVehicleGhostManager* Ghosts = AVehicleGhostManager::Get(World);
+            if (!Ghosts)
+            {
+                return;
+            }
+
+            const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1;
+            if (Count <= 0)
+            {
+                Ghosts->ClearGhosts();
+                return;
+            }
+            Ghosts->SpawnGhosts(Count, Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1.0f);
+        }));
+}
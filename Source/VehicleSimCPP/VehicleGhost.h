@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "VehicleGhost.generated.h"
+
+class AVehicleBase;
+class UInstancedStaticMeshComponent;
+
+// One raw pose captured while recording a lap
+struct FVehicleGhostSample
+{
+    float Time = 0.0f;
+    FVector Location = FVector::ZeroVector;
+    FQuat Rotation = FQuat::Identity;
+};
+
+// Key of a compressed track. Position is a cubic Hermite curve through the keys using the
+// stored velocities as tangents; rotation is slerped.
+struct FVehicleGhostKey
+{
+    float Time = 0.0f;
+    FVector Location = FVector::ZeroVector;
+    FVector3f Velocity = FVector3f::ZeroVector;
+    FQuat4f Rotation = FQuat4f::Identity;
+};
+
+// A lap's transform track, decimated so the curve through the kept keys stays within a
+// tolerance of every recorded sample
+class VEHICLESIMCPP_API FVehicleGhostTrack
+{
+public:
+    static FVehicleGhostTrack Compress(TConstArrayView<FVehicleGhostSample> Samples, float PositionTolerance = 2.0f, float AngleTolerance = 0.5f);
+
+    // Pose at Time (clamped to the track). Hint caches the key interval between calls, so
+    // playing forwards costs O(1) per sample.
+    FTransform Evaluate(float Time, int32& InOutHint) const;
+
+    float GetDuration() const { return Keys.Num() > 0 ? Keys.Last().Time : 0.0f; }
+    int32 GetNumKeys() const { return Keys.Num(); }
+
+    bool SaveToFile(const FString& Filename) const;
+    bool LoadFromFile(const FString& Filename);
+
+    friend FArchive& operator<<(FArchive& Ar, FVehicleGhostTrack& Track);
+
+private:
+    TArray<FVehicleGhostKey> Keys;
+};
+
+// Records the player's laps and replays the best one as render-only ghosts: one instanced
+// mesh for every ghost, no collision and no physics, so each ghost costs a curve evaluation
+// and an instance transform per frame.
+UCLASS()
+class VEHICLESIMCPP_API AVehicleGhostManager : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AVehicleGhostManager();
+
+    virtual void Tick(float DeltaTime) override;
+
+    void StartLap(AVehicleBase* Vehicle);
+
+    // Ends the lap; it becomes the best lap (and is saved) if it was the fastest so far
+    void FinishLap();
+
+    // Adds Count ghosts of the best lap, each starting Spacing seconds after the previous
+    void SpawnGhosts(int32 Count, float Spacing);
+    void ClearGhosts();
+
+    const FVehicleGhostTrack* GetBestLap() const { return BestLap.IsValid() ? BestLap.Get() : nullptr; }
+
+    // Found in the world or spawned on first use
+    static AVehicleGhostManager* Get(UWorld* World);
+
+protected:
+    virtual void BeginPlay() override;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Ghost")
+    UInstancedStaticMeshComponent* GhostInstances;
+
+    // Largest distance between the compressed curve and the recorded path
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+    float PositionTolerance = 2.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+    float AngleTolerance = 0.5f;    // degrees
+
+    // Ghosts start over when they finish the lap
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost")
+    bool bLoopGhosts = true;
+
+private:
+    FString GetBestLapPath() const;
+
+    TWeakObjectPtr<AVehicleBase> RecordedVehicle;
+    TArray<FVehicleGhostSample> Samples;
+    double LapStartTime = 0.0;
+
+    TSharedPtr<const FVehicleGhostTrack> BestLap;
+
+    struct FGhost
+    {
+        TSharedRef<const FVehicleGhostTrack> Track;
+        double StartTime = 0.0;
+        int32 Hint = 0;
+    };
+    TArray<FGhost> Ghosts;
+    TArray<FTransform> GhostTransforms;
+};
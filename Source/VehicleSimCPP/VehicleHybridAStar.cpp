@@ -0,0 +1,606 @@
+#include "VehicleHybridAStar.h"
+#include "VehicleBase.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+
+TSharedRef<FVehicleOccupancyGrid, ESPMode::ThreadSafe> FVehicleOccupancyGrid::BuildFromStaticCollision(UWorld* World, const FVector& Center, float HalfExtent,
+    float InCellSize, float MinHeight, float MaxHeight, const AActor* IgnoreActor)
+{
+    TSharedRef<FVehicleOccupancyGrid, ESPMode::ThreadSafe> Grid = MakeShared<FVehicleOccupancyGrid, ESPMode::ThreadSafe>();
+    Grid->CellSize = FMath::Max(InCellSize, 1.0f);
+    Grid->SizeX = FMath::CeilToInt32(2.0f * HalfExtent / Grid->CellSize);
+    Grid->SizeY = Grid->SizeX;
+    Grid->Origin = FVector2D(Center) - FVector2D(HalfExtent);
+    Grid->Occupied.Init(0, Grid->SizeX * Grid->SizeY);
+
+    if (World)
+    {
+        // One query for everything in the height band, then rasterize each component: its
+        // bounds pick the candidate cells and an overlap test against its own collision decides
+        // each one. Bounds alone would mark every cell under a landscape or terrain mesh.
+        const float BandCenterZ = Center.Z + 0.5f * (MinHeight + MaxHeight);
+        const float BandHalfHeight = 0.5f * (MaxHeight - MinHeight);
+        const FCollisionShape CellShape = FCollisionShape::MakeBox(FVector(0.5f * Grid->CellSize, 0.5f * Grid->CellSize, BandHalfHeight));
+
+        TArray<FOverlapResult> Overlaps;
+        FCollisionQueryParams Params(SCENE_QUERY_STAT(VehicleOccupancyGrid), false, IgnoreActor);
+        World->OverlapMultiByObjectType(Overlaps, FVector(Center.X, Center.Y, BandCenterZ), FQuat::Identity,
+            FCollisionObjectQueryParams(ECC_WorldStatic), FCollisionShape::MakeBox(FVector(HalfExtent, HalfExtent, BandHalfHeight)), Params);
+
+        for (const FOverlapResult& Overlap : Overlaps)
+        {
+            const UPrimitiveComponent* Component = Overlap.GetComponent();
+            if (!Component)
+            {
+                continue;
+            }
+
+            const FBox WorldBox = Component->Bounds.GetBox();
+
+            const int32 MinX = FMath::Clamp(FMath::FloorToInt32((WorldBox.Min.X - Grid->Origin.X) / Grid->CellSize), 0, Grid->SizeX - 1);
+            const int32 MinY = FMath::Clamp(FMath::FloorToInt32((WorldBox.Min.Y - Grid->Origin.Y) / Grid->CellSize), 0, Grid->SizeY - 1);
+            const int32 MaxX = FMath::Clamp(FMath::FloorToInt32((WorldBox.Max.X - Grid->Origin.X) / Grid->CellSize), 0, Grid->SizeX - 1);
+            const int32 MaxY = FMath::Clamp(FMath::FloorToInt32((WorldBox.Max.Y - Grid->Origin.Y) / Grid->CellSize), 0, Grid->SizeY - 1);
+
+            for (int32 Y = MinY; Y <= MaxY; Y++)
+            {
+                for (int32 X = MinX; X <= MaxX; X++)
+                {
+                    uint8& Cell = Grid->Occupied[Y * Grid->SizeX + X];
+                    if (!Cell && Component->OverlapComponent(FVector(Grid->GetCellCenter(X, Y), BandCenterZ), FQuat::Identity, CellShape))
+                    {
+                        Cell = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    Grid->UpdateClearance();
+    return Grid;
+}
+
+bool FVehicleOccupancyGrid::GetCell(const FVector2D& Location, int32& OutX, int32& OutY) const
+{
+    OutX = FMath::FloorToInt32((Location.X - Origin.X) / CellSize);
+    OutY = FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize);
+    return OutX >= 0 && OutY >= 0 && OutX < SizeX && OutY < SizeY;
+}
+
+FVector2D FVehicleOccupancyGrid::GetCellCenter(int32 X, int32 Y) const
+{
+    return Origin + FVector2D(X + 0.5, Y + 0.5) * CellSize;
+}
+
+float FVehicleOccupancyGrid::GetClearance(const FVector2D& Location) const
+{
+    int32 X, Y;
+    return GetCell(Location, X, Y) ? Clearance[Y * SizeX + X] : 0.0f;
+}
+
+void FVehicleOccupancyGrid::UpdateClearance()
+{
+    // Two pass chamfer distance transform (1 and sqrt 2 steps)
+    const float Straight = CellSize;
+    const float Diagonal = CellSize * UE_SQRT_2;
+    Clearance.SetNumUninitialized(SizeX * SizeY);
+    for (int32 i = 0; i < Clearance.Num(); i++)
+    {
+        Clearance[i] = Occupied[i] ? 0.0f : UE_BIG_NUMBER;
+    }
+
+    auto Relax = [this](int32 X, int32 Y, int32 NeighbourX, int32 NeighbourY, float Step)
+    {
+        if (NeighbourX >= 0 && NeighbourY >= 0 && NeighbourX < SizeX && NeighbourY < SizeY)
+        {
+            float& Value = Clearance[Y * SizeX + X];
+            Value = FMath::Min(Value, Clearance[NeighbourY * SizeX + NeighbourX] + Step);
+        }
+    };
+
+    for (int32 Y = 0; Y < SizeY; Y++)
+    {
+        for (int32 X = 0; X < SizeX; X++)
+        {
+            Relax(X, Y, X - 1, Y, Straight);
+            Relax(X, Y, X - 1, Y - 1, Diagonal);
+            Relax(X, Y, X, Y - 1, Straight);
+            Relax(X, Y, X + 1, Y - 1, Diagonal);
+        }
+    }
+    for (int32 Y = SizeY - 1; Y >= 0; Y--)
+    {
+        for (int32 X = SizeX - 1; X >= 0; X--)
+        {
+            Relax(X, Y, X + 1, Y, Straight);
+            Relax(X, Y, X + 1, Y + 1, Diagonal);
+            Relax(X, Y, X, Y + 1, Straight);
+            Relax(X, Y, X - 1, Y + 1, Diagonal);
+        }
+    }
+
+    // Measured between cell centres; the obstacle's edge is half a cell nearer
+    for (float& Value : Clearance)
+    {
+        Value = FMath::Max(Value - 0.5f * CellSize, 0.0f);
+    }
+}
+
+namespace
+{
+    struct FMotionPrimitive
+    {
+        float Throttle;
+        float Steering;
+    };
+
+    constexpr FMotionPrimitive MotionPrimitives[] =
+    {
+        { 1.0f, -1.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f },
+        { -1.0f, -1.0f }, { -1.0f, 0.0f }, { -1.0f, 1.0f },
+    };
+    constexpr int32 NumMotionPrimitives = UE_ARRAY_COUNT(MotionPrimitives);
+
+    FVector2D YawToDirection(float Yaw)
+    {
+        float Sin, Cos;
+        FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Yaw));
+        return FVector2D(Cos, Sin);
+    }
+
+    int32 GetHeadingBin(float Yaw, int32 HeadingBins)
+    {
+        const float BinSize = 360.0f / HeadingBins;
+        return FMath::FloorToInt32(FRotator::ClampAxis(Yaw) / BinSize + 0.5f) % HeadingBins;
+    }
+
+    bool IsFootprintFree(const FVehicleOccupancyGrid& Grid, const FVector2D& Location, float Yaw, const FVehicleHybridAStarSettings& Settings)
+    {
+        const FVector2D Forward = YawToDirection(Yaw) * Settings.CircleOffset;
+        return Grid.GetClearance(Location) >= Settings.CircleRadius
+            && Grid.GetClearance(Location + Forward) >= Settings.CircleRadius
+            && Grid.GetClearance(Location - Forward) >= Settings.CircleRadius;
+    }
+
+    // Integrates one primitive exactly like AVehicleBase::SimulateMove (translate, then yaw).
+    // Returns false if Grid is given and the footprint hits something on the way.
+    bool SimulatePrimitive(const FVehicleOccupancyGrid* Grid, const FMotionPrimitive& Primitive, const FVehicleHybridAStarSettings& Settings,
+        FVector2D& InOutLocation, float& InOutYaw)
+    {
+        const int32 NumSteps = FMath::Max(FMath::RoundToInt32(Settings.StepTime / Settings.SimulationStep), 1);
+        const float DeltaSeconds = Settings.StepTime / NumSteps;
+        for (int32 Step = 0; Step < NumSteps; Step++)
+        {
+            InOutLocation += YawToDirection(InOutYaw) * (Primitive.Throttle * AVehicleBase::MaxForwardSpeed * DeltaSeconds);
+            InOutYaw = FRotator::NormalizeAxis(InOutYaw + Primitive.Steering * AVehicleBase::MaxYawRate * DeltaSeconds);
+            if (Grid && !IsFootprintFree(*Grid, InOutLocation, InOutYaw, Settings))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    float GetPrimitiveCost(const FMotionPrimitive& Primitive, const FVehicleHybridAStarSettings& Settings)
+    {
+        float Cost = AVehicleBase::MaxForwardSpeed * Settings.StepTime;
+        if (Primitive.Throttle < 0.0f)
+        {
+            Cost *= Settings.ReversePenalty;
+        }
+        if (Primitive.Steering != 0.0f)
+        {
+            Cost *= Settings.SteeringPenalty;
+        }
+        return Cost;
+    }
+
+    // Obstacle-free cost from the origin facing +X to every nearby relative pose
+    struct FHeuristicTable
+    {
+        static constexpr float CellSize = 50.0f;
+        static constexpr int32 HalfSize = 30;
+        static constexpr int32 Size = 2 * HalfSize + 1;
+
+        int32 HeadingBins = 72;
+        TArray<float> Costs;
+
+        int32 GetIndex(int32 X, int32 Y, int32 Heading) const
+        {
+            return ((Y + HalfSize) * Size + (X + HalfSize)) * HeadingBins + Heading;
+        }
+
+        // Cost to move by Offset (in the mover's frame) and turn by DeltaYaw; negative if outside the table
+        float Lookup(const FVector2D& Offset, float DeltaYaw) const
+        {
+            const int32 X = FMath::RoundToInt32(Offset.X / CellSize);
+            const int32 Y = FMath::RoundToInt32(Offset.Y / CellSize);
+            if (FMath::Abs(X) > HalfSize || FMath::Abs(Y) > HalfSize)
+            {
+                return -1.0f;
+            }
+            const float Cost = Costs[GetIndex(X, Y, GetHeadingBin(DeltaYaw, HeadingBins))];
+            return Cost < UE_BIG_NUMBER ? Cost : -1.0f;
+        }
+
+        void Build(const FVehicleHybridAStarSettings& Settings)
+        {
+            HeadingBins = Settings.HeadingBins;
+            const int32 NumStates = Size * Size * HeadingBins;
+            Costs.Init(UE_BIG_NUMBER, NumStates);
+
+            // Each lattice state remembers the continuous pose that reached it most cheaply
+            TArray<FVector2D> Locations;
+            TArray<float> Yaws;
+            Locations.SetNumZeroed(NumStates);
+            Yaws.SetNumZeroed(NumStates);
+
+            struct FOpenEntry
+            {
+                float Cost;
+                int32 State;
+                bool operator<(const FOpenEntry& Other) const { return Cost < Other.Cost; }
+            };
+            TArray<FOpenEntry> Open;
+
+            const int32 StartState = GetIndex(0, 0, 0);
+            Costs[StartState] = 0.0f;
+            Open.HeapPush(FOpenEntry{ 0.0f, StartState });
+
+            while (Open.Num() > 0)
+            {
+                FOpenEntry Entry;
+                Open.HeapPop(Entry, EAllowShrinking::No);
+                if (Entry.Cost > Costs[Entry.State])
+                {
+                    continue;
+                }
+
+                for (const FMotionPrimitive& Primitive : MotionPrimitives)
+                {
+                    FVector2D Location = Locations[Entry.State];
+                    float Yaw = Yaws[Entry.State];
+                    SimulatePrimitive(nullptr, Primitive, Settings, Location, Yaw);
+
+                    const int32 X = FMath::RoundToInt32(Location.X / CellSize);
+                    const int32 Y = FMath::RoundToInt32(Location.Y / CellSize);
+                    if (FMath::Abs(X) > HalfSize || FMath::Abs(Y) > HalfSize)
+                    {
+                        continue;
+                    }
+
+                    const int32 State = GetIndex(X, Y, GetHeadingBin(Yaw, HeadingBins));
+                    const float Cost = Entry.Cost + GetPrimitiveCost(Primitive, Settings);
+                    if (Cost < Costs[State])
+                    {
+                        Costs[State] = Cost;
+                        Locations[State] = Location;
+                        Yaws[State] = Yaw;
+                        Open.HeapPush(FOpenEntry{ Cost, State });
+                    }
+                }
+            }
+        }
+    };
+
+    // The table only depends on the primitives and their costs, so it is built once per set
+    // of settings and shared by every plan
+    TSharedRef<const FHeuristicTable, ESPMode::ThreadSafe> GetHeuristicTable(const FVehicleHybridAStarSettings& Settings)
+    {
+        static FCriticalSection TablesLock;
+        static TMap<uint32, TSharedRef<const FHeuristicTable, ESPMode::ThreadSafe>> Tables;
+
+        uint32 Key = GetTypeHash(Settings.StepTime);
+        Key = HashCombine(Key, GetTypeHash(Settings.SimulationStep));
+        Key = HashCombine(Key, GetTypeHash(Settings.HeadingBins));
+        Key = HashCombine(Key, GetTypeHash(Settings.ReversePenalty));
+        Key = HashCombine(Key, GetTypeHash(Settings.SteeringPenalty));
+
+        FScopeLock Lock(&TablesLock);
+        if (const TSharedRef<const FHeuristicTable, ESPMode::ThreadSafe>* Found = Tables.Find(Key))
+        {
+            return *Found;
+        }
+
+        const double StartTime = FPlatformTime::Seconds();
+        TSharedRef<FHeuristicTable, ESPMode::ThreadSafe> Table = MakeShared<FHeuristicTable, ESPMode::ThreadSafe>();
+        Table->Build(Settings);
+        UE_LOG(LogTemp, Log, TEXT("VehicleHybridAStar: built heuristic table in %.1f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+        Tables.Add(Key, Table);
+        return Table;
+    }
+
+    // Shortest 8-connected distance from every cell to the goal, through cells the car's
+    // centre can occupy
+    TArray<float> BuildObstacleHeuristic(const FVehicleOccupancyGrid& Grid, const FVector2D& Goal, float MinClearance)
+    {
+        TArray<float> Distances;
+        Distances.Init(UE_BIG_NUMBER, Grid.SizeX * Grid.SizeY);
+
+        int32 GoalX, GoalY;
+        if (!Grid.GetCell(Goal, GoalX, GoalY))
+        {
+            return Distances;
+        }
+
+        struct FOpenEntry
+        {
+            float Distance;
+            int32 Cell;
+            bool operator<(const FOpenEntry& Other) const { return Distance < Other.Distance; }
+        };
+        TArray<FOpenEntry> Open;
+
+        const int32 GoalCell = GoalY * Grid.SizeX + GoalX;
+        Distances[GoalCell] = 0.0f;
+        Open.HeapPush(FOpenEntry{ 0.0f, GoalCell });
+
+        while (Open.Num() > 0)
+        {
+            FOpenEntry Entry;
+            Open.HeapPop(Entry, EAllowShrinking::No);
+            if (Entry.Distance > Distances[Entry.Cell])
+            {
+                continue;
+            }
+
+            const int32 X = Entry.Cell % Grid.SizeX;
+            const int32 Y = Entry.Cell / Grid.SizeX;
+            for (int32 OffsetY = -1; OffsetY <= 1; OffsetY++)
+            {
+                for (int32 OffsetX = -1; OffsetX <= 1; OffsetX++)
+                {
+                    const int32 NeighbourX = X + OffsetX;
+                    const int32 NeighbourY = Y + OffsetY;
+                    if ((OffsetX == 0 && OffsetY == 0) || NeighbourX < 0 || NeighbourY < 0 || NeighbourX >= Grid.SizeX || NeighbourY >= Grid.SizeY)
+                    {
+                        continue;
+                    }
+
+                    const int32 Neighbour = NeighbourY * Grid.SizeX + NeighbourX;
+                    if (Grid.Clearance[Neighbour] < MinClearance)
+                    {
+                        continue;
+                    }
+
+                    const float Distance = Entry.Distance + Grid.CellSize * (OffsetX != 0 && OffsetY != 0 ? UE_SQRT_2 : 1.0f);
+                    if (Distance < Distances[Neighbour])
+                    {
+                        Distances[Neighbour] = Distance;
+                        Open.HeapPush(FOpenEntry{ Distance, Neighbour });
+                    }
+                }
+            }
+        }
+
+        return Distances;
+    }
+
+    struct FSearchNode
+    {
+        FVector2D Location;
+        float Yaw;
+        float Cost;
+        int32 Parent;
+        int32 State;
+        int8 Primitive;         // primitive that reached this node, INDEX_NONE for the start
+        bool bClosed;
+    };
+
+    // A successor computed on a worker, merged into the search afterwards
+    struct FSuccessor
+    {
+        FVector2D Location;
+        float Yaw;
+        float Cost;
+        float Heuristic;
+        int32 State;
+        bool bValid;
+    };
+}
+
+namespace VehicleHybridAStar
+{
+    FVehiclePlannedPath Plan(const FVehicleOccupancyGrid& Grid, const FVehiclePathPose& Start, const FVehiclePathPose& Goal, const FVehicleHybridAStarSettings& Settings)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        FVehiclePlannedPath Result;
+
+        if (!IsFootprintFree(Grid, Start.Location, Start.Yaw, Settings) || !IsFootprintFree(Grid, Goal.Location, Goal.Yaw, Settings))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("VehicleHybridAStar: start or goal pose is blocked or outside the grid"));
+            Result.PlanningSeconds = FPlatformTime::Seconds() - StartTime;
+            return Result;
+        }
+
+        const TSharedRef<const FHeuristicTable, ESPMode::ThreadSafe> Table = GetHeuristicTable(Settings);
+        const TArray<float> ObstacleDistances = BuildObstacleHeuristic(Grid, Goal.Location, Settings.CircleRadius - 0.75f * Grid.CellSize);
+
+        auto GetHeuristic = [&](const FVector2D& Location, float Yaw)
+        {
+            int32 X, Y;
+            Grid.GetCell(Location, X, Y);
+            const float ObstacleDistance = ObstacleDistances[Y * Grid.SizeX + X];
+
+            // Goal offset in the mover's frame
+            const FVector2D Forward = YawToDirection(Yaw);
+            const FVector2D Delta = Goal.Location - Location;
+            const FVector2D Offset(Delta.X * Forward.X + Delta.Y * Forward.Y, Delta.Y * Forward.X - Delta.X * Forward.Y);
+            const float TableCost = Table->Lookup(Offset, Goal.Yaw - Yaw);
+            const float KinematicCost = TableCost >= 0.0f ? TableCost : Delta.Size();
+
+            return FMath::Max(KinematicCost, ObstacleDistance);
+        };
+
+        auto GetState = [&](const FVector2D& Location, float Yaw)
+        {
+            int32 X, Y;
+            Grid.GetCell(Location, X, Y);
+            return (Y * Grid.SizeX + X) * Settings.HeadingBins + GetHeadingBin(Yaw, Settings.HeadingBins);
+        };
+
+        struct FOpenEntry
+        {
+            float Priority;
+            int32 Node;
+            bool operator<(const FOpenEntry& Other) const { return Priority < Other.Priority; }
+        };
+
+        TArray<FSearchNode> Nodes;
+        TArray<FOpenEntry> Open;
+        TMap<int32, int32> StateToNode;
+        Nodes.Reserve(Settings.MaxExpansions * 2);
+
+        const int32 StartState = GetState(Start.Location, Start.Yaw);
+        Nodes.Add(FSearchNode{ Start.Location, Start.Yaw, 0.0f, INDEX_NONE, StartState, INDEX_NONE, false });
+        StateToNode.Add(StartState, 0);
+        Open.HeapPush(FOpenEntry{ GetHeuristic(Start.Location, Start.Yaw), 0 });
+
+        const int32 BatchSize = FMath::Max(Settings.ExpansionBatch, 1);
+        TArray<int32> Batch;
+        TArray<FSuccessor> Successors;
+        int32 GoalNode = INDEX_NONE;
+
+        while (Open.Num() > 0 && GoalNode == INDEX_NONE && Result.NumExpanded < Settings.MaxExpansions)
+        {
+            // Take the best few open nodes; a slightly wider frontier costs little optimality
+            // and lets the expensive collision checks run side by side
+            Batch.Reset();
+            while (Open.Num() > 0 && Batch.Num() < BatchSize)
+            {
+                FOpenEntry Entry;
+                Open.HeapPop(Entry, EAllowShrinking::No);
+                FSearchNode& Node = Nodes[Entry.Node];
+                if (Node.bClosed || StateToNode.FindRef(Node.State) != Entry.Node)
+                {
+                    continue;
+                }
+                Node.bClosed = true;
+
+                if (FVector2D::Distance(Node.Location, Goal.Location) <= Settings.GoalPositionTolerance
+                    && FMath::Abs(FRotator::NormalizeAxis(Node.Yaw - Goal.Yaw)) <= Settings.GoalYawTolerance)
+                {
+                    GoalNode = Entry.Node;
+                    break;
+                }
+                Batch.Add(Entry.Node);
+            }
+            if (GoalNode != INDEX_NONE)
+            {
+                break;
+            }
+            Result.NumExpanded += Batch.Num();
+
+            Successors.SetNumUninitialized(Batch.Num() * NumMotionPrimitives);
+            ParallelFor(Batch.Num(), [&](int32 BatchIndex)
+            {
+                const FSearchNode& Node = Nodes[Batch[BatchIndex]];
+                const FMotionPrimitive* Previous = Node.Primitive != INDEX_NONE ? &MotionPrimitives[Node.Primitive] : nullptr;
+                for (int32 PrimitiveIndex = 0; PrimitiveIndex < NumMotionPrimitives; PrimitiveIndex++)
+                {
+                    const FMotionPrimitive& Primitive = MotionPrimitives[PrimitiveIndex];
+                    FSuccessor& Successor = Successors[BatchIndex * NumMotionPrimitives + PrimitiveIndex];
+                    Successor.Location = Node.Location;
+                    Successor.Yaw = Node.Yaw;
+                    Successor.bValid = SimulatePrimitive(&Grid, Primitive, Settings, Successor.Location, Successor.Yaw);
+                    if (!Successor.bValid)
+                    {
+                        continue;
+                    }
+
+                    Successor.Cost = Node.Cost + GetPrimitiveCost(Primitive, Settings);
+                    if (Previous && Previous->Throttle != Primitive.Throttle)
+                    {
+                        Successor.Cost += Settings.DirectionSwitchPenalty;
+                    }
+                    if (Previous && Previous->Steering != Primitive.Steering)
+                    {
+                        Successor.Cost += Settings.SteeringChangePenalty;
+                    }
+
+                    Successor.Heuristic = GetHeuristic(Successor.Location, Successor.Yaw);
+                    Successor.State = GetState(Successor.Location, Successor.Yaw);
+                    Successor.bValid = Successor.Heuristic < UE_BIG_NUMBER;    // the goal is unreachable from here
+                }
+            });
+
+            // Merge in a fixed order so the result does not depend on thread timing
+            for (int32 i = 0; i < Successors.Num(); i++)
+            {
+                const FSuccessor& Successor = Successors[i];
+                if (!Successor.bValid)
+                {
+                    continue;
+                }
+
+                int32& ExistingNode = StateToNode.FindOrAdd(Successor.State, INDEX_NONE);
+                if (ExistingNode != INDEX_NONE && (Nodes[ExistingNode].bClosed || Nodes[ExistingNode].Cost <= Successor.Cost))
+                {
+                    continue;
+                }
+
+                ExistingNode = Nodes.Add(FSearchNode{ Successor.Location, Successor.Yaw, Successor.Cost, Batch[i / NumMotionPrimitives],
+                    Successor.State, static_cast<int8>(i % NumMotionPrimitives), false });
+                Open.HeapPush(FOpenEntry{ Successor.Cost + Successor.Heuristic, ExistingNode });
+            }
+        }
+
+        Result.PlanningSeconds = FPlatformTime::Seconds() - StartTime;
+        if (GoalNode == INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("VehicleHybridAStar: no path after %d expansions (%.1f ms)"), Result.NumExpanded, Result.PlanningSeconds * 1000.0);
+            return Result;
+        }
+
+        TArray<int32> Chain;
+        for (int32 NodeIndex = GoalNode; NodeIndex != INDEX_NONE; NodeIndex = Nodes[NodeIndex].Parent)
+        {
+            Chain.Add(NodeIndex);
+        }
+        Algo::Reverse(Chain);
+
+        for (int32 NodeIndex : Chain)
+        {
+            const FSearchNode& Node = Nodes[NodeIndex];
+            const bool bReverse = Node.Primitive != INDEX_NONE && MotionPrimitives[Node.Primitive].Throttle < 0.0f;
+            Result.Poses.Add(FVehiclePathPose{ Node.Location, Node.Yaw, bReverse });
+
+            if (Node.Primitive == INDEX_NONE)
+            {
+                continue;
+            }
+
+            // Consecutive steps with the same input become one segment
+            const FMotionPrimitive& Primitive = MotionPrimitives[Node.Primitive];
+            if (Result.Segments.Num() > 0 && Result.Segments.Last().Throttle == Primitive.Throttle && Result.Segments.Last().Steering == Primitive.Steering)
+            {
+                Result.Segments.Last().Duration += Settings.StepTime;
+            }
+            else
+            {
+                Result.Segments.Add(FVehiclePathSegment{ Primitive.Throttle, Primitive.Steering, Settings.StepTime });
+            }
+        }
+
+        Result.bSuccess = true;
+        Result.Cost = Nodes[GoalNode].Cost;
+        return Result;
+    }
+
+    UE::Tasks::TTask<FVehiclePlannedPath> PlanAsync(TSharedRef<const FVehicleOccupancyGrid, ESPMode::ThreadSafe> Grid,
+        const FVehiclePathPose& Start, const FVehiclePathPose& Goal, const FVehicleHybridAStarSettings& Settings)
+    {
+        return UE::Tasks::Launch(UE_SOURCE_LOCATION, [Grid, Start, Goal, Settings]()
+        {
+            return Plan(*Grid, Start, Goal, Settings);
+        });
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+
+class UWorld;
+
+// 2D occupancy of static collision around an area, with each cell's distance to the nearest
+// obstacle so a vehicle footprint can be checked with a few lookups
+struct VEHICLESIMCPP_API FVehicleOccupancyGrid
+{
+    FVector2D Origin = FVector2D::ZeroVector;   // world location of cell (0, 0)'s corner
+    float CellSize = 25.0f;
+    int32 SizeX = 0;
+    int32 SizeY = 0;
+
+    TArray<uint8> Occupied;
+    TArray<float> Clearance;    // distance from the cell centre to the nearest occupied cell
+
+    // Rasterizes WorldStatic collision that sticks up between MinHeight and MaxHeight above Center.Z
+    // (so the ground itself is not an obstacle). Runs scene queries, so call it on the game thread.
+    static TSharedRef<FVehicleOccupancyGrid, ESPMode::ThreadSafe> BuildFromStaticCollision(UWorld* World, const FVector& Center, float HalfExtent,
+        float InCellSize = 25.0f, float MinHeight = 20.0f, float MaxHeight = 200.0f, const AActor* IgnoreActor = nullptr);
+
+    bool GetCell(const FVector2D& Location, int32& OutX, int32& OutY) const;
+    FVector2D GetCellCenter(int32 X, int32 Y) const;
+
+    // 0 outside the grid, which counts as blocked
+    float GetClearance(const FVector2D& Location) const;
+
+    void UpdateClearance();
+};
+
+// A pose the planned path passes through
+struct FVehiclePathPose
+{
+    FVector2D Location = FVector2D::ZeroVector;
+    float Yaw = 0.0f;           // degrees
+    bool bReverse = false;
+};
+
+// Constant driver input for a stretch of the path. Feeding these to AVehicleBase::SetDriverInput
+// in order reproduces the path, because the planner uses the same movement model.
+struct FVehiclePathSegment
+{
+    float Throttle = 0.0f;
+    float Steering = 0.0f;
+    float Duration = 0.0f;      // seconds
+};
+
+struct FVehiclePlannedPath
+{
+    bool bSuccess = false;
+    TArray<FVehiclePathPose> Poses;
+    TArray<FVehiclePathSegment> Segments;
+    float Cost = 0.0f;
+    int32 NumExpanded = 0;
+    double PlanningSeconds = 0.0;
+};
+
+struct FVehicleHybridAStarSettings
+{
+    // Motion primitives: full left/straight/full right, forwards and in reverse, for StepTime
+    // seconds each, integrated the way AVehicleBase::SimulateMove does at SimulationStep
+    float StepTime = 0.3f;
+    float SimulationStep = 1.0f / 30.0f;
+    int32 HeadingBins = 72;
+
+    // Car footprint as three circles along its length
+    float CircleOffset = 80.0f;
+    float CircleRadius = 80.0f;
+
+    // Cost multipliers and penalties (cost is path length in world units)
+    float ReversePenalty = 2.0f;
+    float DirectionSwitchPenalty = 300.0f;
+    float SteeringPenalty = 1.1f;
+    float SteeringChangePenalty = 20.0f;
+
+    float GoalPositionTolerance = 50.0f;
+    float GoalYawTolerance = 10.0f;     // degrees
+
+    int32 MaxExpansions = 60000;
+    int32 ExpansionBatch = 8;           // open nodes expanded together in parallel
+};
+
+// Hybrid A*: searches continuous (x, y, yaw) poses reached by the vehicle's own motion model,
+// de-duplicated on a (cell, heading bin) lattice. The heuristic is the larger of
+//  - a cached table of obstacle-free costs between relative poses under the same primitives,
+//    which accounts for the turning radius and reversing (a discrete Reeds-Shepp distance)
+//  - the obstacle-aware 2D distance from a Dijkstra pass over the grid from the goal
+namespace VehicleHybridAStar
+{
+    VEHICLESIMCPP_API FVehiclePlannedPath Plan(const FVehicleOccupancyGrid& Grid, const FVehiclePathPose& Start, const FVehiclePathPose& Goal,
+        const FVehicleHybridAStarSettings& Settings = FVehicleHybridAStarSettings());
+
+    // Same as Plan, on a worker thread
+    VEHICLESIMCPP_API UE::Tasks::TTask<FVehiclePlannedPath> PlanAsync(TSharedRef<const FVehicleOccupancyGrid, ESPMode::ThreadSafe> Grid,
+        const FVehiclePathPose& Start, const FVehiclePathPose& Goal, const FVehicleHybridAStarSettings& Settings = FVehicleHybridAStarSettings());
+}
@@ -0,0 +1,392 @@
+#include "VehicleInertialSensorComponent.h"
+#include "VehicleBase.h"
+#include "VehicleSimCPP.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Components/PrimitiveComponent.h"
+#include "Containers/CircularQueue.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include "UObject/UObjectIterator.h"
+#include <atomic>
+
+namespace
+{
+    // Enough for a one second hitch at 1 kHz
+    constexpr uint32 ImuQueueCapacity = 2048;
+    constexpr uint32 GnssQueueCapacity = 64;
+
+    constexpr double EarthRadius = 6378137.0;   // metres
+
+    float Gaussian(FRandomStream& Random)
+    {
+        // Box-Muller
+        const float U1 = FMath::Max(Random.GetFraction(), UE_SMALL_NUMBER);
+        const float U2 = Random.GetFraction();
+        return FMath::Sqrt(-2.0f * FMath::Loge(U1)) * FMath::Cos(UE_TWO_PI * U2);
+    }
+
+    FVector3f GaussianVector(FRandomStream& Random)
+    {
+        return FVector3f(Gaussian(Random), Gaussian(Random), Gaussian(Random));
+    }
+
+    // Angular velocity (rad/s) that turns From into To over Seconds
+    FVector AngularVelocityBetween(const FQuat& From, const FQuat& To, double Seconds)
+    {
+        FQuat DeltaRotation = To * From.Inverse();
+        if (DeltaRotation.W < 0.0)
+        {
+            DeltaRotation = FQuat(-DeltaRotation.X, -DeltaRotation.Y, -DeltaRotation.Z, -DeltaRotation.W);
+        }
+        FVector Axis;
+        double Angle;
+        DeltaRotation.ToAxisAndAngle(Axis, Angle);
+        return Axis * (Angle / Seconds);
+    }
+
+    // Bias plus white noise, with the bias random walk advanced by one sample
+    struct FImuAxisModel
+    {
+        FVector3f Bias = FVector3f::ZeroVector;
+
+        void Initialize(const FVehicleImuNoise& Noise, FRandomStream& Random)
+        {
+            Bias = GaussianVector(Random) * Noise.TurnOnBiasStdDev;
+        }
+
+        FVector3f Apply(const FVector3f& Value, const FVehicleImuNoise& Noise, float SampleInterval, FRandomStream& Random)
+        {
+            Bias += GaussianVector(Random) * (Noise.BiasRandomWalk * FMath::Sqrt(SampleInterval));
+            return Value + Bias + GaussianVector(Random) * Noise.NoiseStdDev;
+        }
+    };
+}
+
+// Runs before every physics step on the physics thread. Everything it owns apart from the
+// queues is only touched there.
+class FVehicleInertialSimCallback : public Chaos::TSimCallbackObject<Chaos::FSimCallbackNoInput, Chaos::FSimCallbackNoOutput>
+{
+public:
+    FVehicleInertialSensorSettings Settings;
+    FSingleParticlePhysicsProxy* Proxy = nullptr;
+
+    TCircularQueue<FVehicleImuSample> ImuQueue{ ImuQueueCapacity };
+    TCircularQueue<FVehicleGnssSample> GnssQueue{ GnssQueueCapacity };
+    std::atomic<int64> NumDropped{ 0 };
+    std::atomic<bool> bImuRateCapped{ false };
+
+    virtual void OnPreSimulate_Internal() override
+    {
+        Chaos::FRigidBodyHandle_Internal* Body = Proxy ? Proxy->GetPhysicsThreadAPI() : nullptr;
+        if (!Body)
+        {
+            return;
+        }
+
+        // The body state is the end of the previous step, so the motion below describes the step
+        // that just finished, [Time - DeltaTime, Time]
+        const double Time = GetSimTime_Internal();
+        const FVector Location = Body->X();
+        const FQuat Rotation = Body->R();
+
+        if (!bHasPose)
+        {
+            Random.Initialize(Settings.Seed);
+            Accelerometer.Initialize(Settings.AccelerometerNoise, Random);
+            Gyroscope.Initialize(Settings.GyroscopeNoise, Random);
+            NextImuTime = Time;
+            LastImuTime = Time;
+            NextGnssTime = Time;
+            PreviousTime = Time;
+            PreviousLocation = Location;
+            KinematicTime = Time;
+            KinematicLocation = Location;
+            KinematicRotation = Rotation;
+            bHasPose = true;
+            return;
+        }
+
+        const double DeltaTime = Time - PreviousTime;
+        if (DeltaTime <= UE_SMALL_NUMBER)
+        {
+            return;
+        }
+
+        FVector Velocity;
+        FVector AngularVelocity;
+        FVector Acceleration;
+        if (Body->ObjectState() == Chaos::EObjectStateType::Dynamic)
+        {
+            // Simulated bodies carry the solver's own velocities
+            Velocity = Body->V();
+            AngularVelocity = Body->W();
+            Acceleration = bHasVelocity ? (Velocity - PreviousVelocity) / DeltaTime : FVector::ZeroVector;
+        }
+        else
+        {
+            UpdateKinematicMotion(Time, Location, Rotation);
+            Velocity = KinematicVelocity;
+            AngularVelocity = KinematicAngularVelocity;
+            Acceleration = KinematicAcceleration;
+        }
+
+        if (Settings.ImuRate > 0.0f)
+        {
+            // Specific force is what an accelerometer feels: acceleration minus gravity
+            const FVector3f BodyAcceleration(Rotation.UnrotateVector(Acceleration - FVector(0.0, 0.0, Settings.GravityZ)) / 100.0);
+            const FVector3f BodyAngularVelocity(Rotation.UnrotateVector(AngularVelocity));
+            const double SampleInterval = 1.0 / Settings.ImuRate;
+
+            // One sample per step at most, stamped at the end of the step it describes. A step
+            // longer than the sample interval skips the slots it covers, capping the rate.
+            if (NextImuTime <= Time)
+            {
+                const float SinceLastSample = static_cast<float>(Time - LastImuTime);
+                FVehicleImuSample Sample;
+                Sample.Time = Time;
+                Sample.Acceleration = Accelerometer.Apply(BodyAcceleration, Settings.AccelerometerNoise, SinceLastSample, Random);
+                Sample.AngularVelocity = Gyroscope.Apply(BodyAngularVelocity, Settings.GyroscopeNoise, SinceLastSample, Random);
+                if (!ImuQueue.Enqueue(Sample))
+                {
+                    NumDropped++;
+                }
+                LastImuTime = Time;
+
+                NextImuTime += SampleInterval;
+                if (NextImuTime <= Time)
+                {
+                    bImuRateCapped = true;
+                    NextImuTime = Time + SampleInterval;
+                }
+            }
+        }
+
+        if (Settings.GnssRate > 0.0f)
+        {
+            while (NextGnssTime <= Time)
+            {
+                const double Alpha = FMath::Clamp((NextGnssTime - PreviousTime) / DeltaTime, 0.0, 1.0);
+                const FVector Position = FMath::Lerp(PreviousLocation, Location, Alpha) / 100.0;
+
+                const double East = Position.X + Gaussian(Random) * Settings.GnssHorizontalStdDev;
+                const double North = -Position.Y + Gaussian(Random) * Settings.GnssHorizontalStdDev;
+                const double Up = Position.Z + Gaussian(Random) * Settings.GnssVerticalStdDev;
+
+                // Flat earth around the origin is plenty for test tracks
+                FVehicleGnssSample Sample;
+                Sample.Time = NextGnssTime;
+                Sample.Latitude = Settings.OriginLatitude + FMath::RadiansToDegrees(North / EarthRadius);
+                Sample.Longitude = Settings.OriginLongitude + FMath::RadiansToDegrees(East / (EarthRadius * FMath::Cos(FMath::DegreesToRadians(Settings.OriginLatitude))));
+                Sample.Altitude = Settings.OriginAltitude + Up;
+                Sample.Velocity = FVector3f(Velocity.X, -Velocity.Y, Velocity.Z) / 100.0f;
+                if (!GnssQueue.Enqueue(Sample))
+                {
+                    NumDropped++;
+                }
+                NextGnssTime += 1.0 / Settings.GnssRate;
+            }
+        }
+
+        PreviousTime = Time;
+        PreviousLocation = Location;
+        PreviousVelocity = Velocity;
+        bHasVelocity = true;
+    }
+
+private:
+    // Kinematic bodies (AVehicleBase) are moved on the game thread, so their pose jumps once per
+    // game frame and stands still over the physics steps in between. Differencing per step
+    // would give zero velocity with a spike every frame; differencing between pose updates
+    // gives the movement model's velocity, held until the next update.
+    void UpdateKinematicMotion(double Time, const FVector& Location, const FQuat& Rotation)
+    {
+        const double Interval = Time - KinematicTime;
+        const bool bMoved = !Location.Equals(KinematicLocation, UE_KINDA_SMALL_NUMBER) || !Rotation.Equals(KinematicRotation, UE_KINDA_SMALL_NUMBER);
+
+        // No update for well over a frame means the vehicle stopped
+        const bool bStopped = !bMoved && KinematicInterval > 0.0 && Interval > 1.5 * KinematicInterval;
+        if (!bMoved && !bStopped)
+        {
+            return;
+        }
+
+        const FVector Velocity = (Location - KinematicLocation) / Interval;
+        KinematicAcceleration = bHasKinematicVelocity ? (Velocity - KinematicVelocity) / Interval : FVector::ZeroVector;
+        KinematicVelocity = Velocity;
+        KinematicAngularVelocity = AngularVelocityBetween(KinematicRotation, Rotation, Interval);
+        bHasKinematicVelocity = true;
+
+        // A stop is not a new frame interval
+        if (bMoved)
+        {
+            KinematicInterval = Interval;
+        }
+        KinematicTime = Time;
+        KinematicLocation = Location;
+        KinematicRotation = Rotation;
+    }
+
+    FRandomStream Random;
+    FImuAxisModel Accelerometer;
+    FImuAxisModel Gyroscope;
+
+    double NextImuTime = 0.0;
+    double LastImuTime = 0.0;
+    double NextGnssTime = 0.0;
+    double PreviousTime = 0.0;
+    FVector PreviousLocation = FVector::ZeroVector;
+    FVector PreviousVelocity = FVector::ZeroVector;
+    bool bHasPose = false;
+    bool bHasVelocity = false;
+
+    double KinematicTime = 0.0;
+    double KinematicInterval = 0.0;
+    FVector KinematicLocation = FVector::ZeroVector;
+    FQuat KinematicRotation = FQuat::Identity;
+    FVector KinematicVelocity = FVector::ZeroVector;
+    FVector KinematicAngularVelocity = FVector::ZeroVector;
+    FVector KinematicAcceleration = FVector::ZeroVector;
+    bool bHasKinematicVelocity = false;
+};
+
+UVehicleInertialSensorComponent::UVehicleInertialSensorComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UVehicleInertialSensorComponent::BeginPlay()
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Sensors);
+
+    Super::BeginPlay();
+
+    const UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(GetOwner()->GetRootComponent());
+    const FBodyInstance* BodyInstance = Root ? Root->GetBodyInstance() : nullptr;
+    FPhysScene* PhysicsScene = GetWorld()->GetPhysicsScene();
+    if (!BodyInstance || !BodyInstance->GetPhysicsActorHandle() || !PhysicsScene)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleInertialSensor: %s has no physics body to sample"), *GetOwner()->GetName());
+        return;
+    }
+
+    FVehicleInertialSensorSettings Settings;
+    Settings.ImuRate = ImuRate;
+    Settings.GnssRate = GnssRate;
+    Settings.AccelerometerNoise = AccelerometerNoise;
+    Settings.GyroscopeNoise = GyroscopeNoise;
+    Settings.GnssHorizontalStdDev = GnssHorizontalStdDev;
+    Settings.GnssVerticalStdDev = GnssVerticalStdDev;
+    Settings.OriginLatitude = OriginLatitude;
+    Settings.OriginLongitude = OriginLongitude;
+    Settings.OriginAltitude = OriginAltitude;
+    Settings.GravityZ = GetWorld()->GetGravityZ();
+    Settings.Seed = Seed;
+
+    // Registration is queued as a solver command, so the physics thread cannot run the
+    // callback before it is set up here
+    Callback = PhysicsScene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FVehicleInertialSimCallback>();
+    Callback->Settings = Settings;
+    Callback->Proxy = BodyInstance->GetPhysicsActorHandle();
+}
+
+void UVehicleInertialSensorComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (Callback)
+    {
+        if (FPhysScene* PhysicsScene = GetWorld()->GetPhysicsScene())
+        {
+            PhysicsScene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(Callback);
+        }
+        Callback = nullptr;
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+int64 UVehicleInertialSensorComponent::GetNumDroppedSamples() const
+{
+    return Callback ? Callback->NumDropped.load() : 0;
+}
+
+void UVehicleInertialSensorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Sensors);
+
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    ImuSamples.Reset();
+    GnssSamples.Reset();
+    if (!Callback)
+    {
+        return;
+    }
+
+    FVehicleImuSample ImuSample;
+    while (Callback->ImuQueue.Dequeue(ImuSample))
+    {
+        ImuSamples.Add(ImuSample);
+    }
+    FVehicleGnssSample GnssSample;
+    while (Callback->GnssQueue.Dequeue(GnssSample))
+    {
+        GnssSamples.Add(GnssSample);
+    }
+    NumImuSamples += ImuSamples.Num();
+
+    if (!bWarnedImuRateCapped && Callback->bImuRateCapped.load())
+    {
+        bWarnedImuRateCapped = true;
+        UE_LOG(LogTemp, Warning, TEXT("VehicleInertialSensor: %s physics steps are longer than 1/%.0f s, so the IMU runs at the step rate; raise the async physics rate or substepping"),
+            *GetOwner()->GetName(), ImuRate);
+    }
+
+    if (ImuSamples.Num() > 0)
+    {
+        OnImuSamples.Broadcast(ImuSamples);
+    }
+    if (GnssSamples.Num() > 0)
+    {
+        OnGnssSamples.Broadcast(GnssSamples);
+    }
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs AttachInertialSensorCommand(
+        TEXT("vehicle.Sensors.AttachInertial"),
+        TEXT("Adds an IMU/GNSS sensor to the player's vehicle: vehicle.Sensors.AttachInertial [ImuRate] [GnssRate]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+            AVehicleBase* Vehicle = PlayerController ? Cast<AVehicleBase>(PlayerController->GetPawn()) : nullptr;
+            if (!Vehicle)
+            {
+                return;
+            }
+
+            UVehicleInertialSensorComponent* Sensor = NewObject<UVehicleInertialSensorComponent>(Vehicle);
+            Sensor->ImuRate = Args.Num() > 0 ? FCString::Atof(*Args[0]) : Sensor->ImuRate;
+            Sensor->GnssRate = Args.Num() > 1 ? FCString::Atof(*Args[1]) : Sensor->GnssRate;
+            Sensor->RegisterComponent();
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs InertialSensorStatsCommand(
+        TEXT("vehicle.Sensors.InertialStats"),
+        TEXT("Logs sample counts for every IMU/GNSS sensor"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            for (TObjectIterator<UVehicleInertialSensorComponent> It; It; ++It)
+            {
+                if (It->GetWorld() == World)
+                {
+                    UE_LOG(LogTemp, Log, TEXT("VehicleInertialSensor: %s %lld IMU samples (%d last frame), %lld dropped"),
+                        *It->GetOwner()->GetName(), It->GetNumImuSamples(), It->GetImuSamples().Num(), It->GetNumDroppedSamples());
+                }
+            }
+        }));
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "VehicleInertialSensorComponent.generated.h"
+
+class FVehicleInertialSimCallback;
+
+// One IMU reading in the vehicle body frame, SI units
+struct FVehicleImuSample
+{
+    double Time = 0.0;                                      // physics simulation time, seconds
+    FVector3f Acceleration = FVector3f::ZeroVector;         // specific force, m/s^2 (reads +9.81 up at rest)
+    FVector3f AngularVelocity = FVector3f::ZeroVector;      // rad/s
+};
+
+// One GNSS fix
+struct FVehicleGnssSample
+{
+    double Time = 0.0;
+    double Latitude = 0.0;          // degrees
+    double Longitude = 0.0;
+    double Altitude = 0.0;          // metres
+    FVector3f Velocity = FVector3f::ZeroVector;             // east, north, up in m/s
+};
+
+// Noise model of one IMU axis group: white noise, a fixed turn-on bias and a bias random walk
+USTRUCT(BlueprintType)
+struct FVehicleImuNoise
+{
+    GENERATED_BODY()
+
+    FVehicleImuNoise() = default;
+    FVehicleImuNoise(float InNoiseStdDev, float InTurnOnBiasStdDev, float InBiasRandomWalk)
+        : NoiseStdDev(InNoiseStdDev), TurnOnBiasStdDev(InTurnOnBiasStdDev), BiasRandomWalk(InBiasRandomWalk)
+    {
+    }
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
+    float NoiseStdDev = 0.0f;       // per sample
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
+    float TurnOnBiasStdDev = 0.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
+    float BiasRandomWalk = 0.0f;    // per sqrt(second)
+};
+
+// Plain copy of the component settings owned by the physics thread
+struct FVehicleInertialSensorSettings
+{
+    float ImuRate = 1000.0f;
+    float GnssRate = 10.0f;
+    FVehicleImuNoise AccelerometerNoise;
+    FVehicleImuNoise GyroscopeNoise;
+    float GnssHorizontalStdDev = 1.5f;
+    float GnssVerticalStdDev = 3.0f;
+    double OriginLatitude = 0.0;
+    double OriginLongitude = 0.0;
+    double OriginAltitude = 0.0;
+    float GravityZ = -980.0f;       // cm/s^2, from the world
+    int32 Seed = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnVehicleImuSamples, TConstArrayView<FVehicleImuSample> /*Samples*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnVehicleGnssSamples, TConstArrayView<FVehicleGnssSample> /*Samples*/);
+
+// IMU and GNSS for the owning vehicle, sampled on the physics thread in a Chaos sim callback
+// that runs every physics (sub)step, so the sample rate follows the physics rate rather than
+// the render frame rate. Each step yields at most one IMU sample: a step has a single motion,
+// and several samples of it would only repeat it with fresh noise. Samples are handed to the
+// game thread through single producer / single consumer lock-free queues and delivered in
+// batches each frame.
+UCLASS(ClassGroup = (Vehicle), meta = (BlueprintSpawnableComponent))
+class VEHICLESIMCPP_API UVehicleInertialSensorComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleInertialSensorComponent();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    // At most one sample per physics (sub)step, so the effective rate is capped by the step rate
+    // (with a warning); raise the async physics rate (or substepping) for 1 kHz
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float ImuRate = 1000.0f;
+
+    // 0 disables GNSS
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float GnssRate = 10.0f;
+
+    // m/s^2
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor|Noise")
+    FVehicleImuNoise AccelerometerNoise = FVehicleImuNoise(0.02f, 0.05f, 0.002f);
+
+    // rad/s
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor|Noise")
+    FVehicleImuNoise GyroscopeNoise = FVehicleImuNoise(0.001f, 0.002f, 0.0001f);
+
+    // metres
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor|Noise")
+    float GnssHorizontalStdDev = 1.5f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor|Noise")
+    float GnssVerticalStdDev = 3.0f;
+
+    // Geodetic position of the world origin (+X east, -Y north)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    double OriginLatitude = 37.4275;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    double OriginLongitude = -122.1697;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    double OriginAltitude = 30.0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    int32 Seed = 0;
+
+    // Samples that arrived this frame
+    TConstArrayView<FVehicleImuSample> GetImuSamples() const { return ImuSamples; }
+    TConstArrayView<FVehicleGnssSample> GetGnssSamples() const { return GnssSamples; }
+
+    int64 GetNumImuSamples() const { return NumImuSamples; }
+    int64 GetNumDroppedSamples() const;
+
+    FOnVehicleImuSamples OnImuSamples;
+    FOnVehicleGnssSamples OnGnssSamples;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    // Owned by the physics solver once registered; only its queues and counters are touched from here
+    FVehicleInertialSimCallback* Callback = nullptr;
+
+    TArray<FVehicleImuSample> ImuSamples;
+    TArray<FVehicleGnssSample> GnssSamples;
+    int64 NumImuSamples = 0;
+    bool bWarnedImuRateCapped = false;
+};
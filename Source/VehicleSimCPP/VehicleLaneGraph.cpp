@@ -0,0 +1,547 @@
+#include "VehicleLaneGraph.h"
+#include "VehicleLaneSpline.h"
+#include "Algo/UpperBound.h"
+#include "Components/SplineComponent.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    constexpr uint32 LaneGraphFileMagic = 0x52474C56; // "VLGR"
+    constexpr int32 LaneGraphFileVersion = 1;
+
+    // Keep the grid at a sane size even for very spread out networks
+    constexpr int32 MaxGridCells = 1 << 20;
+
+    // Guards against successor loops of zero-length lanes
+    constexpr int32 MaxLookAheadLanes = 64;
+
+    void SortLaneActors(TArray<AVehicleLaneSpline*>& LaneActors)
+    {
+        LaneActors.RemoveAll([](const AVehicleLaneSpline* Actor) { return Actor == nullptr || Actor->GetSpline() == nullptr; });
+        LaneActors.Sort([](const AVehicleLaneSpline& A, const AVehicleLaneSpline& B) { return A.GetPathName() < B.GetPathName(); });
+    }
+
+    uint32 HashString(const FString& String, uint32 Crc)
+    {
+        return FCrc::StrCrc32(*String, Crc);
+    }
+
+    template<typename T>
+    uint32 HashValue(const T& Value, uint32 Crc)
+    {
+        return FCrc::MemCrc32(&Value, sizeof(T), Crc);
+    }
+}
+
+FArchive& operator<<(FArchive& Ar, FVehicleLaneGraph::FLane& Lane)
+{
+    Ar << Lane.FirstPoint << Lane.NumPoints;
+    Ar << Lane.FirstSuccessor << Lane.NumSuccessors;
+    Ar << Lane.FirstPredecessor << Lane.NumPredecessors;
+    Ar << Lane.LeftNeighbour << Lane.RightNeighbour;
+    Ar << Lane.Length << Lane.SpeedLimit;
+    return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FVehicleLaneGraph::FSegmentRef& Segment)
+{
+    Ar << Segment.Lane << Segment.Point;
+    return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FVehicleLaneGraph& Graph)
+{
+    Ar << Graph.Lanes;
+    Ar << Graph.Points;
+    Ar << Graph.PointDistances;
+    Ar << Graph.Links;
+    Ar << Graph.CellSize;
+    Ar << Graph.GridOrigin;
+    Ar << Graph.GridSizeX << Graph.GridSizeY;
+    Ar << Graph.CellStart;
+    Ar << Graph.CellSegments;
+    return Ar;
+}
+
+void FVehicleLaneGraph::Reset()
+{
+    Lanes.Reset();
+    Points.Reset();
+    PointDistances.Reset();
+    Links.Reset();
+    CellStart.Reset();
+    CellSegments.Reset();
+    GridSizeX = 0;
+    GridSizeY = 0;
+    MaxSpeedLimit = 0.0f;
+    SourceHash = 0;
+}
+
+void FVehicleLaneGraph::UpdateMaxSpeedLimit()
+{
+    MaxSpeedLimit = 0.0f;
+    for (const FLane& Lane : Lanes)
+    {
+        MaxSpeedLimit = FMath::Max(MaxSpeedLimit, Lane.SpeedLimit);
+    }
+}
+
+uint32 FVehicleLaneGraph::ComputeSourceHash(const TArray<AVehicleLaneSpline*>& InLaneActors, float InCellSize)
+{
+    TArray<AVehicleLaneSpline*> LaneActors = InLaneActors;
+    SortLaneActors(LaneActors);
+
+    uint32 Crc = HashValue(LaneGraphFileVersion, 0);
+    Crc = HashValue(InCellSize, Crc);
+    Crc = HashValue(SampleSpacing, Crc);
+    for (const AVehicleLaneSpline* Actor : LaneActors)
+    {
+        const USplineComponent* Spline = Actor->GetSpline();
+        Crc = HashString(Actor->GetPathName(), Crc);
+        Crc = HashValue(Actor->SpeedLimit, Crc);
+        Crc = HashValue(Spline->IsClosedLoop(), Crc);
+
+        const int32 NumSplinePoints = Spline->GetNumberOfSplinePoints();
+        Crc = HashValue(NumSplinePoints, Crc);
+        for (int32 i = 0; i < NumSplinePoints; i++)
+        {
+            Crc = HashValue(Spline->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World), Crc);
+            Crc = HashValue(Spline->GetArriveTangentAtSplinePoint(i, ESplineCoordinateSpace::World), Crc);
+            Crc = HashValue(Spline->GetLeaveTangentAtSplinePoint(i, ESplineCoordinateSpace::World), Crc);
+        }
+
+        for (const AVehicleLaneSpline* Successor : Actor->Successors)
+        {
+            Crc = HashString(Successor ? Successor->GetPathName() : FString(), Crc);
+        }
+        Crc = HashString(Actor->LeftNeighbour ? Actor->LeftNeighbour->GetPathName() : FString(), Crc);
+        Crc = HashString(Actor->RightNeighbour ? Actor->RightNeighbour->GetPathName() : FString(), Crc);
+    }
+    return Crc;
+}
+
+void FVehicleLaneGraph::Build(TArray<AVehicleLaneSpline*> LaneActors, float InCellSize)
+{
+    Reset();
+    SourceHash = ComputeSourceHash(LaneActors, InCellSize);
+    CellSize = FMath::Max(InCellSize, SampleSpacing);
+
+    SortLaneActors(LaneActors);
+
+    TMap<const AVehicleLaneSpline*, int32> LaneIndices;
+    for (int32 i = 0; i < LaneActors.Num(); i++)
+    {
+        LaneIndices.Add(LaneActors[i], i);
+    }
+
+    auto GetLaneIndex = [&LaneIndices](const AVehicleLaneSpline* Actor)
+    {
+        const int32* Index = Actor ? LaneIndices.Find(Actor) : nullptr;
+        return Index ? *Index : INDEX_NONE;
+    };
+
+    // Sample every spline into a polyline
+    Lanes.SetNum(LaneActors.Num());
+    for (int32 LaneIndex = 0; LaneIndex < LaneActors.Num(); LaneIndex++)
+    {
+        const AVehicleLaneSpline* Actor = LaneActors[LaneIndex];
+        const USplineComponent* Spline = Actor->GetSpline();
+        const float SplineLength = Spline->GetSplineLength();
+        const int32 NumSamples = FMath::Max(2, FMath::CeilToInt(SplineLength / SampleSpacing) + 1);
+
+        FLane& Lane = Lanes[LaneIndex];
+        Lane.FirstPoint = Points.Num();
+        Lane.NumPoints = NumSamples;
+        Lane.SpeedLimit = Actor->SpeedLimit;
+        Lane.LeftNeighbour = GetLaneIndex(Actor->LeftNeighbour);
+        Lane.RightNeighbour = GetLaneIndex(Actor->RightNeighbour);
+
+        float Distance = 0.0f;
+        for (int32 i = 0; i < NumSamples; i++)
+        {
+            const float SplineDistance = SplineLength * i / (NumSamples - 1);
+            const FVector3f Point(Spline->GetLocationAtDistanceAlongSpline(SplineDistance, ESplineCoordinateSpace::World));
+            if (i > 0)
+            {
+                Distance += FVector3f::Dist(Points.Last(), Point);
+            }
+            Points.Add(Point);
+            PointDistances.Add(Distance);
+        }
+        Lane.Length = Distance;
+    }
+
+    // Successors first, then predecessors derived from them
+    for (int32 LaneIndex = 0; LaneIndex < LaneActors.Num(); LaneIndex++)
+    {
+        FLane& Lane = Lanes[LaneIndex];
+        Lane.FirstSuccessor = Links.Num();
+        for (const AVehicleLaneSpline* Successor : LaneActors[LaneIndex]->Successors)
+        {
+            const int32 SuccessorIndex = GetLaneIndex(Successor);
+            if (SuccessorIndex != INDEX_NONE)
+            {
+                Links.Add(SuccessorIndex);
+            }
+        }
+        Lane.NumSuccessors = Links.Num() - Lane.FirstSuccessor;
+    }
+
+    for (int32 LaneIndex = 0; LaneIndex < Lanes.Num(); LaneIndex++)
+    {
+        const int32 FirstPredecessor = Links.Num();
+        for (int32 Other = 0; Other < Lanes.Num(); Other++)
+        {
+            if (GetSuccessors(Other).Contains(LaneIndex))
+            {
+                Links.Add(Other);
+            }
+        }
+        Lanes[LaneIndex].FirstPredecessor = FirstPredecessor;
+        Lanes[LaneIndex].NumPredecessors = Links.Num() - FirstPredecessor;
+    }
+
+    BuildGrid();
+    UpdateMaxSpeedLimit();
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleLaneGraph: Built %d lanes, %d points, %dx%d grid (%llu bytes)"),
+        Lanes.Num(), Points.Num(), GridSizeX, GridSizeY, static_cast<uint64>(GetAllocatedSize()));
+}
+
+void FVehicleLaneGraph::BuildGrid()
+{
+    CellStart.Reset();
+    CellSegments.Reset();
+    if (Points.Num() == 0)
+    {
+        GridSizeX = 0;
+        GridSizeY = 0;
+        return;
+    }
+
+    FVector2f Min(TNumericLimits<float>::Max());
+    FVector2f Max(TNumericLimits<float>::Lowest());
+    for (const FVector3f& Point : Points)
+    {
+        Min = Min.ComponentMin(FVector2f(Point.X, Point.Y));
+        Max = Max.ComponentMax(FVector2f(Point.X, Point.Y));
+    }
+
+    // Grow cells until the grid fits the budget
+    while (true)
+    {
+        GridSizeX = FMath::FloorToInt((Max.X - Min.X) / CellSize) + 1;
+        GridSizeY = FMath::FloorToInt((Max.Y - Min.Y) / CellSize) + 1;
+        if (static_cast<int64>(GridSizeX) * GridSizeY <= MaxGridCells)
+        {
+            break;
+        }
+        CellSize *= 2.0f;
+    }
+    GridOrigin = Min;
+
+    // Two passes: count segments per cell, then fill the flat array
+    auto ForEachSegmentCell = [this](int32 Point, TFunctionRef<void(int32)> Visit)
+    {
+        const FVector3f& A = Points[Point];
+        const FVector3f& B = Points[Point + 1];
+        const int32 MinX = FMath::FloorToInt((FMath::Min(A.X, B.X) - GridOrigin.X) / CellSize);
+        const int32 MaxX = FMath::FloorToInt((FMath::Max(A.X, B.X) - GridOrigin.X) / CellSize);
+        const int32 MinY = FMath::FloorToInt((FMath::Min(A.Y, B.Y) - GridOrigin.Y) / CellSize);
+        const int32 MaxY = FMath::FloorToInt((FMath::Max(A.Y, B.Y) - GridOrigin.Y) / CellSize);
+        for (int32 Y = FMath::Max(MinY, 0); Y <= FMath::Min(MaxY, GridSizeY - 1); Y++)
+        {
+            for (int32 X = FMath::Max(MinX, 0); X <= FMath::Min(MaxX, GridSizeX - 1); X++)
+            {
+                Visit(Y * GridSizeX + X);
+            }
+        }
+    };
+
+    const int32 NumCells = GridSizeX * GridSizeY;
+    CellStart.SetNumZeroed(NumCells + 1);
+    for (int32 LaneIndex = 0; LaneIndex < Lanes.Num(); LaneIndex++)
+    {
+        const FLane& Lane = Lanes[LaneIndex];
+        for (int32 Point = Lane.FirstPoint; Point < Lane.FirstPoint + Lane.NumPoints - 1; Point++)
+        {
+            ForEachSegmentCell(Point, [this](int32 Cell) { CellStart[Cell + 1]++; });
+        }
+    }
+
+    for (int32 Cell = 0; Cell < NumCells; Cell++)
+    {
+        CellStart[Cell + 1] += CellStart[Cell];
+    }
+
+    TArray<int32> WriteCursor(CellStart.GetData(), NumCells);
+    CellSegments.SetNumUninitialized(CellStart[NumCells]);
+    for (int32 LaneIndex = 0; LaneIndex < Lanes.Num(); LaneIndex++)
+    {
+        const FLane& Lane = Lanes[LaneIndex];
+        for (int32 Point = Lane.FirstPoint; Point < Lane.FirstPoint + Lane.NumPoints - 1; Point++)
+        {
+            ForEachSegmentCell(Point, [&](int32 Cell)
+            {
+                FSegmentRef& Segment = CellSegments[WriteCursor[Cell]++];
+                Segment.Lane = LaneIndex;
+                Segment.Point = Point;
+            });
+        }
+    }
+}
+
+bool FVehicleLaneGraph::SaveToFile(const FString& Filename) const
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+
+    uint32 Magic = LaneGraphFileMagic;
+    int32 Version = LaneGraphFileVersion;
+    uint32 Hash = SourceHash;
+    Writer << Magic << Version << Hash;
+    Writer << const_cast<FVehicleLaneGraph&>(*this);
+
+    return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FVehicleLaneGraph::LoadFromFile(const FString& Filename, uint32 ExpectedSourceHash)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *Filename, FILEREAD_Silent))
+    {
+        return false;
+    }
+
+    FMemoryReader Reader(Bytes);
+    uint32 Magic = 0;
+    int32 Version = 0;
+    uint32 Hash = 0;
+    Reader << Magic << Version << Hash;
+    if (Reader.IsError() || Magic != LaneGraphFileMagic || Version != LaneGraphFileVersion || Hash != ExpectedSourceHash)
+    {
+        return false;
+    }
+
+    Reader << *this;
+    if (Reader.IsError() || CellStart.Num() != GridSizeX * GridSizeY + 1)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleLaneGraph: Cache file %s is corrupt"), *Filename);
+        Reset();
+        return false;
+    }
+
+    SourceHash = Hash;
+    UpdateMaxSpeedLimit();
+    return true;
+}
+
+bool FVehicleLaneGraph::GetCellCoord(const FVector& Location, int32& OutX, int32& OutY) const
+{
+    OutX = FMath::FloorToInt((Location.X - GridOrigin.X) / CellSize);
+    OutY = FMath::FloorToInt((Location.Y - GridOrigin.Y) / CellSize);
+    return OutX >= 0 && OutX < GridSizeX && OutY >= 0 && OutY < GridSizeY;
+}
+
+void FVehicleLaneGraph::MakePosition(int32 Lane, int32 Point, float Alpha, const FVector& Location, FVehicleLanePosition& OutPosition) const
+{
+    const FVector3f& A = Points[Point];
+    const FVector3f& B = Points[Point + 1];
+
+    OutPosition.Lane = Lane;
+    OutPosition.Location = FMath::Lerp(A, B, Alpha);
+    OutPosition.Direction = (B - A).GetSafeNormal(UE_SMALL_NUMBER, OutPosition.Direction);
+    OutPosition.Distance = FMath::Lerp(PointDistances[Point], PointDistances[Point + 1], Alpha);
+
+    // Right of the direction of travel in the ground plane
+    const FVector3f Right(-OutPosition.Direction.Y, OutPosition.Direction.X, 0.0f);
+    OutPosition.LateralOffset = FVector3f::DotProduct(FVector3f(Location) - OutPosition.Location, Right);
+}
+
+bool FVehicleLaneGraph::FindNearestLane(const FVector& Location, float MaxDistance, FVehicleLanePosition& OutPosition) const
+{
+    if (CellSegments.Num() == 0 || MaxDistance <= 0.0f)
+    {
+        return false;
+    }
+
+    const FVector3f Query(Location);
+    float BestDistanceSquared = FMath::Square(MaxDistance);
+    int32 BestLane = INDEX_NONE;
+    int32 BestPoint = 0;
+    float BestAlpha = 0.0f;
+
+    auto VisitCell = [&](int32 X, int32 Y)
+    {
+        const int32 Cell = Y * GridSizeX + X;
+        for (int32 i = CellStart[Cell]; i < CellStart[Cell + 1]; i++)
+        {
+            const FSegmentRef& Segment = CellSegments[i];
+            const FVector3f& A = Points[Segment.Point];
+            const FVector3f AB = Points[Segment.Point + 1] - A;
+            const float LengthSquared = AB.SizeSquared();
+            const float Alpha = LengthSquared > UE_SMALL_NUMBER ? FMath::Clamp(FVector3f::DotProduct(Query - A, AB) / LengthSquared, 0.0f, 1.0f) : 0.0f;
+            const float DistanceSquared = FVector3f::DistSquared(Query, A + AB * Alpha);
+            if (DistanceSquared < BestDistanceSquared)
+            {
+                BestDistanceSquared = DistanceSquared;
+                BestLane = Segment.Lane;
+                BestPoint = Segment.Point;
+                BestAlpha = Alpha;
+            }
+        }
+    };
+
+    // Search rings of cells outwards from the query. Anything beyond ring R is at least
+    // R * CellSize away, so stop once the best hit is closer than that.
+    int32 CenterX, CenterY;
+    GetCellCoord(Location, CenterX, CenterY);
+    const int32 RingsToCoverGrid = FMath::Max(
+        FMath::Max(FMath::Abs(CenterX), FMath::Abs(GridSizeX - 1 - CenterX)),
+        FMath::Max(FMath::Abs(CenterY), FMath::Abs(GridSizeY - 1 - CenterY)));
+    const int32 MaxRing = FMath::Min(RingsToCoverGrid, FMath::CeilToInt(MaxDistance / CellSize));
+
+    for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+    {
+        if (Ring > 0 && BestDistanceSquared <= FMath::Square((Ring - 1) * CellSize))
+        {
+            break;
+        }
+
+        const int32 MinY = FMath::Max(CenterY - Ring, 0);
+        const int32 MaxY = FMath::Min(CenterY + Ring, GridSizeY - 1);
+        for (int32 Y = MinY; Y <= MaxY; Y++)
+        {
+            const bool bFullRow = FMath::Abs(Y - CenterY) == Ring;
+            const int32 Step = bFullRow ? 1 : FMath::Max(2 * Ring, 1);
+            for (int32 X = CenterX - Ring; X <= CenterX + Ring; X += Step)
+            {
+                if (X >= 0 && X < GridSizeX)
+                {
+                    VisitCell(X, Y);
+                }
+            }
+        }
+    }
+
+    if (BestLane == INDEX_NONE)
+    {
+        return false;
+    }
+
+    MakePosition(BestLane, BestPoint, BestAlpha, Location, OutPosition);
+    return true;
+}
+
+bool FVehicleLaneGraph::GetLanePosition(int32 Lane, const FVector& Location, FVehicleLanePosition& OutPosition) const
+{
+    if (!Lanes.IsValidIndex(Lane))
+    {
+        return false;
+    }
+
+    const FVector3f Query(Location);
+    const FLane& LaneData = Lanes[Lane];
+    float BestDistanceSquared = TNumericLimits<float>::Max();
+    int32 BestPoint = LaneData.FirstPoint;
+    float BestAlpha = 0.0f;
+
+    for (int32 Point = LaneData.FirstPoint; Point < LaneData.FirstPoint + LaneData.NumPoints - 1; Point++)
+    {
+        const FVector3f& A = Points[Point];
+        const FVector3f AB = Points[Point + 1] - A;
+        const float LengthSquared = AB.SizeSquared();
+        const float Alpha = LengthSquared > UE_SMALL_NUMBER ? FMath::Clamp(FVector3f::DotProduct(Query - A, AB) / LengthSquared, 0.0f, 1.0f) : 0.0f;
+        const float DistanceSquared = FVector3f::DistSquared(Query, A + AB * Alpha);
+        if (DistanceSquared < BestDistanceSquared)
+        {
+            BestDistanceSquared = DistanceSquared;
+            BestPoint = Point;
+            BestAlpha = Alpha;
+        }
+    }
+
+    MakePosition(Lane, BestPoint, BestAlpha, Location, OutPosition);
+    return true;
+}
+
+bool FVehicleLaneGraph::GetPositionAtDistance(int32 Lane, float Distance, FVehicleLanePosition& OutPosition) const
+{
+    if (!Lanes.IsValidIndex(Lane))
+    {
+        return false;
+    }
+
+    const FLane& LaneData = Lanes[Lane];
+    const TConstArrayView<float> Distances(PointDistances.GetData() + LaneData.FirstPoint, LaneData.NumPoints);
+    Distance = FMath::Clamp(Distance, 0.0f, LaneData.Length);
+
+    // Segment whose start is the last point at or before Distance
+    const int32 Segment = FMath::Clamp(Algo::UpperBound(Distances, Distance) - 1, 0, LaneData.NumPoints - 2);
+    const int32 Point = LaneData.FirstPoint + Segment;
+    const float SegmentLength = PointDistances[Point + 1] - PointDistances[Point];
+    const float Alpha = SegmentLength > UE_SMALL_NUMBER ? (Distance - PointDistances[Point]) / SegmentLength : 0.0f;
+
+    const FVector3f Location = FMath::Lerp(Points[Point], Points[Point + 1], Alpha);
+    MakePosition(Lane, Point, Alpha, FVector(Location), OutPosition);
+    return true;
+}
+
+bool FVehicleLaneGraph::GetLookAheadPosition(const FVehicleLanePosition& From, float Distance, FVehicleLanePosition& OutPosition, int32 RouteChoice) const
+{
+    if (!Lanes.IsValidIndex(From.Lane))
+    {
+        return false;
+    }
+
+    int32 Lane = From.Lane;
+    float LaneDistance = From.Distance + Distance;
+    RouteChoice = FMath::Abs(RouteChoice);
+
+    for (int32 Step = 0; Step < MaxLookAheadLanes; Step++)
+    {
+        const FLane& LaneData = Lanes[Lane];
+        if (LaneDistance > LaneData.Length && LaneData.NumSuccessors > 0)
+        {
+            LaneDistance -= LaneData.Length;
+            Lane = Links[LaneData.FirstSuccessor + RouteChoice % LaneData.NumSuccessors];
+        }
+        else if (LaneDistance < 0.0f && LaneData.NumPredecessors > 0)
+        {
+            Lane = Links[LaneData.FirstPredecessor + RouteChoice % LaneData.NumPredecessors];
+            LaneDistance += Lanes[Lane].Length;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return GetPositionAtDistance(Lane, LaneDistance, OutPosition);
+}
+
+TConstArrayView<int32> FVehicleLaneGraph::GetSuccessors(int32 Lane) const
+{
+    const FLane& LaneData = Lanes[Lane];
+    return TConstArrayView<int32>(Links.GetData() + LaneData.FirstSuccessor, LaneData.NumSuccessors);
+}
+
+TConstArrayView<int32> FVehicleLaneGraph::GetPredecessors(int32 Lane) const
+{
+    const FLane& LaneData = Lanes[Lane];
+    return TConstArrayView<int32>(Links.GetData() + LaneData.FirstPredecessor, LaneData.NumPredecessors);
+}
+
+TConstArrayView<FVector3f> FVehicleLaneGraph::GetLanePoints(int32 Lane) const
+{
+    const FLane& LaneData = Lanes[Lane];
+    return TConstArrayView<FVector3f>(Points.GetData() + LaneData.FirstPoint, LaneData.NumPoints);
+}
+
+SIZE_T FVehicleLaneGraph::GetAllocatedSize() const
+{
+    return Lanes.GetAllocatedSize() + Points.GetAllocatedSize() + PointDistances.GetAllocatedSize()
+        + Links.GetAllocatedSize() + CellStart.GetAllocatedSize() + CellSegments.GetAllocatedSize();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AVehicleLaneSpline;
+
+// A point on the lane network
+struct FVehicleLanePosition
+{
+    int32 Lane = INDEX_NONE;
+    float Distance = 0.0f;          // along the lane from its start
+    float LateralOffset = 0.0f;     // signed distance from the centre line, positive to the right
+    FVector3f Location = FVector3f::ZeroVector;     // on the centre line
+    FVector3f Direction = FVector3f::ForwardVector; // direction of travel
+
+    bool IsValid() const { return Lane != INDEX_NONE; }
+};
+
+// Compact, immutable road network: every lane is a polyline sampled from its spline,
+// with successor/predecessor/neighbour links and a uniform grid over all lane segments.
+//
+// All queries are const, never allocate and only read the built arrays, so any number
+// of threads can call them at once. Building or loading replaces the whole graph and
+// must not overlap with queries.
+class VEHICLESIMCPP_API FVehicleLaneGraph
+{
+public:
+    struct FLane
+    {
+        int32 FirstPoint = 0;
+        int32 NumPoints = 0;
+        int32 FirstSuccessor = 0;
+        int32 NumSuccessors = 0;
+        int32 FirstPredecessor = 0;
+        int32 NumPredecessors = 0;
+        int32 LeftNeighbour = INDEX_NONE;
+        int32 RightNeighbour = INDEX_NONE;
+        float Length = 0.0f;
+        float SpeedLimit = 0.0f;
+    };
+
+    // Distance between polyline samples taken from the splines
+    static constexpr float SampleSpacing = 200.0f;
+
+    // Build from lane actors. Lanes are ordered by actor name so the result is stable.
+    void Build(TArray<AVehicleLaneSpline*> LaneActors, float InCellSize = 5000.0f);
+
+    // Hash of everything Build reads from the actors and its settings, used as the cache key
+    static uint32 ComputeSourceHash(const TArray<AVehicleLaneSpline*>& LaneActors, float InCellSize);
+
+    // Binary cache. Load fails if the file is missing, stale or from an older format.
+    bool SaveToFile(const FString& Filename) const;
+    bool LoadFromFile(const FString& Filename, uint32 ExpectedSourceHash);
+
+    void Reset();
+
+    // Closest lane centre line to Location within MaxDistance
+    bool FindNearestLane(const FVector& Location, float MaxDistance, FVehicleLanePosition& OutPosition) const;
+
+    // Project Location onto one specific lane
+    bool GetLanePosition(int32 Lane, const FVector& Location, FVehicleLanePosition& OutPosition) const;
+
+    // Position at a distance along a lane (clamped to the lane)
+    bool GetPositionAtDistance(int32 Lane, float Distance, FVehicleLanePosition& OutPosition) const;
+
+    // Walk Distance further along the network, continuing onto successors at lane ends.
+    // RouteChoice picks among several successors (RouteChoice % NumSuccessors) so a vehicle
+    // can keep a consistent route. Stops at the end of a lane with no successors.
+    bool GetLookAheadPosition(const FVehicleLanePosition& From, float Distance, FVehicleLanePosition& OutPosition, int32 RouteChoice = 0) const;
+
+    int32 GetNumLanes() const { return Lanes.Num(); }
+    const FLane& GetLane(int32 Lane) const { return Lanes[Lane]; }
+    TConstArrayView<int32> GetSuccessors(int32 Lane) const;
+    TConstArrayView<int32> GetPredecessors(int32 Lane) const;
+    TConstArrayView<FVector3f> GetLanePoints(int32 Lane) const;
+
+    // Highest speed limit on any lane, for admissible travel time estimates
+    float GetMaxSpeedLimit() const { return MaxSpeedLimit; }
+
+    uint32 GetSourceHash() const { return SourceHash; }
+    SIZE_T GetAllocatedSize() const;
+
+    friend FArchive& operator<<(FArchive& Ar, FVehicleLaneGraph& Graph);
+
+private:
+    // One polyline segment, from Point to Point + 1 of a lane
+    struct FSegmentRef
+    {
+        int32 Lane = 0;
+        int32 Point = 0;    // global point index
+    };
+
+    friend FArchive& operator<<(FArchive& Ar, FLane& Lane);
+    friend FArchive& operator<<(FArchive& Ar, FSegmentRef& Segment);
+
+    void BuildGrid();
+    void UpdateMaxSpeedLimit();
+    void MakePosition(int32 Lane, int32 Point, float Alpha, const FVector& Location, FVehicleLanePosition& OutPosition) const;
+    bool GetCellCoord(const FVector& Location, int32& OutX, int32& OutY) const;
+
+    TArray<FLane> Lanes;
+    TArray<FVector3f> Points;
+    TArray<float> PointDistances;   // distance along the owning lane for each point
+    TArray<int32> Links;            // successor and predecessor lane indices
+
+    // Uniform grid over lane segments, stored as offsets into one flat array
+    float CellSize = 5000.0f;
+    FVector2f GridOrigin = FVector2f::ZeroVector;
+    int32 GridSizeX = 0;
+    int32 GridSizeY = 0;
+    TArray<int32> CellStart;        // GridSizeX * GridSizeY + 1 entries
+    TArray<FSegmentRef> CellSegments;
+
+    float MaxSpeedLimit = 0.0f;
+    uint32 SourceHash = 0;
+};
@@ -0,0 +1,68 @@
+#include "VehicleLaneGraphSubsystem.h"
+#include "VehicleLaneSpline.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+
+bool UVehicleLaneGraphSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleLaneGraphSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    TArray<AVehicleLaneSpline*> LaneActors;
+    for (TActorIterator<AVehicleLaneSpline> It(&InWorld); It; ++It)
+    {
+        LaneActors.Add(*It);
+    }
+
+    if (LaneActors.Num() == 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehicleLaneGraph: No lane splines in %s"), *InWorld.GetMapName());
+        return;
+    }
+
+    float CellSize = 5000.0f;
+    if (GConfig)
+    {
+        GConfig->GetFloat(TEXT("VehicleSim.Lanes"), TEXT("GridCellSize"), CellSize, GGameIni);
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    const uint32 SourceHash = FVehicleLaneGraph::ComputeSourceHash(LaneActors, CellSize);
+    const FString CacheFilename = GetCacheFilename(InWorld);
+
+    if (LaneGraph.LoadFromFile(CacheFilename, SourceHash))
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehicleLaneGraph: Loaded %d lanes from %s in %.2f ms"),
+            LaneGraph.GetNumLanes(), *CacheFilename, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+        return;
+    }
+
+    LaneGraph.Build(LaneActors, CellSize);
+    if (!LaneGraph.SaveToFile(CacheFilename))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleLaneGraph: Failed to write cache %s"), *CacheFilename);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleLaneGraph: Built %d lanes in %.2f ms"),
+        LaneGraph.GetNumLanes(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void UVehicleLaneGraphSubsystem::Deinitialize()
+{
+    LaneGraph.Reset();
+    Super::Deinitialize();
+}
+
+FString UVehicleLaneGraphSubsystem::GetCacheFilename(const UWorld& InWorld) const
+{
+    // PIE prefixes the map name per instance; all instances share one cache
+    const FString MapName = UWorld::RemovePIEPrefix(InWorld.GetMapName());
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LaneGraph"), MapName + TEXT(".lanegraph"));
+}
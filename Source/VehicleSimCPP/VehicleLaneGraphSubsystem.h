@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleLaneGraph.h"
+#include "VehicleLaneGraphSubsystem.generated.h"
+
+// Owns the world's lane graph. Built from every AVehicleLaneSpline when play begins,
+// or loaded from Saved/LaneGraph when the splines have not changed since the last build.
+// The graph is read-only afterwards, so traffic and AI code may query it from worker threads.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleLaneGraphSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+    const FVehicleLaneGraph& GetLaneGraph() const { return LaneGraph; }
+    bool HasLanes() const { return LaneGraph.GetNumLanes() > 0; }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    FString GetCacheFilename(const UWorld& InWorld) const;
+
+    FVehicleLaneGraph LaneGraph;
+};
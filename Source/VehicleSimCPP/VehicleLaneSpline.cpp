@@ -0,0 +1,11 @@
+#include "VehicleLaneSpline.h"
+#include "Components/SplineComponent.h"
+
+AVehicleLaneSpline::AVehicleLaneSpline()
+{
+    PrimaryActorTick.bCanEverTick = false;
+
+    Spline = CreateDefaultSubobject<USplineComponent>(TEXT("Spline"));
+    RootComponent = Spline;
+    Spline->SetMobility(EComponentMobility::Static);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "VehicleLaneSpline.generated.h"
+
+class USplineComponent;
+
+// One drivable lane placed in the level. Lanes are linked into a road network
+// through their successors and side neighbours; predecessors are derived.
+// Read once at level load by UVehicleLaneGraphSubsystem.
+UCLASS()
+class VEHICLESIMCPP_API AVehicleLaneSpline : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AVehicleLaneSpline();
+
+    USplineComponent* GetSpline() const { return Spline; }
+
+    // Lanes a vehicle can continue onto at the end of this one
+    UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Lane")
+    TArray<AVehicleLaneSpline*> Successors;
+
+    // Parallel lanes in the same direction, for lane changes
+    UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Lane")
+    AVehicleLaneSpline* LeftNeighbour = nullptr;
+
+    UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Lane")
+    AVehicleLaneSpline* RightNeighbour = nullptr;
+
+    // Units per second
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lane")
+    float SpeedLimit = 500.0f;
+
+protected:
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Lane")
+    USplineComponent* Spline;
+};
@@ -0,0 +1,244 @@
+#include "VehicleLidarComponent.h"
+#include "VehicleBase.h"
+#include "VehicleSharedMemorySubsystem.h"
+#include "VehicleSimCPP.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+    const TArray<FVehicleLidarPoint> EmptySweep;
+}
+
+UVehicleLidarComponent::UVehicleLidarComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    // Fire after movement so the rays leave from this frame's pose
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UVehicleLidarComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    TraceDelegate.BindUObject(this, &UVehicleLidarComponent::OnTraceDone);
+    QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(VehicleLidar), false, GetOwner());
+    Configure();
+}
+
+void UVehicleLidarComponent::Configure()
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Sensors);
+
+    Channels = FMath::Clamp(Channels, 1, 256);
+    RotationRate = FMath::Max(RotationRate, 0.1f);
+    HorizontalFOV = FMath::Clamp(HorizontalFOV, 1.0f, 360.0f);
+
+    // A column is one firing of every channel
+    const float ColumnsPerRevolution = FMath::Max(PointsPerSecond / (RotationRate * Channels), 1.0f);
+    ColumnStep = 360.0f / ColumnsPerRevolution;
+    ColumnsPerSweep = FMath::Min(FMath::CeilToInt32(HorizontalFOV / ColumnStep), (1 << RayIndexBits) / Channels);
+
+    const int32 NumRays = ColumnsPerSweep * Channels;
+    RayDirections.SetNumUninitialized(NumRays);
+    for (int32 Column = 0; Column < ColumnsPerSweep; Column++)
+    {
+        const float Azimuth = -0.5f * HorizontalFOV + Column * ColumnStep;
+        for (int32 Channel = 0; Channel < Channels; Channel++)
+        {
+            const float Elevation = Channels > 1 ? FMath::Lerp(LowerFOV, UpperFOV, Channel / float(Channels - 1)) : 0.0f;
+            RayDirections[Column * Channels + Channel] = FVector3f(FRotator3f(Elevation, Azimuth, 0.0f).Vector());
+        }
+    }
+
+    for (FSweepBuffer& Buffer : Buffers)
+    {
+        Buffer.Points.SetNumZeroed(NumRays);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleLidar: %s has %d channels, %d columns per sweep, %.0f rays per second"),
+        *GetOwner()->GetName(), Channels, ColumnsPerSweep, float(NumRays) * RotationRate);
+
+    StartSweep();
+}
+
+const TArray<FVehicleLidarPoint>& UVehicleLidarComponent::GetLatestSweep() const
+{
+    return PublishedBuffer != INDEX_NONE ? Buffers[PublishedBuffer].Points : EmptySweep;
+}
+
+void UVehicleLidarComponent::StartSweep()
+{
+    FSweepBuffer& Buffer = Buffers[FillBuffer];
+    if (Buffer.PendingRays > 0)
+    {
+        // Results are more than two revolutions late; let them fall on the floor
+        RaysDropped += Buffer.PendingRays;
+        Buffer.PendingRays = 0;
+    }
+    if (FillBuffer == PublishedBuffer)
+    {
+        PublishedBuffer = INDEX_NONE;
+    }
+
+    // A new generation makes any straggling results for the old contents miss
+    Buffer.Generation++;
+    Buffer.bFiring = true;
+    FMemory::Memzero(Buffer.Points.GetData(), Buffer.Points.Num() * sizeof(FVehicleLidarPoint));
+    NextColumn = 0;
+}
+
+void UVehicleLidarComponent::FinishSweep()
+{
+    // Columns the budget skipped stay empty
+    if (NextColumn < ColumnsPerSweep)
+    {
+        RaysSkipped += int64(ColumnsPerSweep - NextColumn) * Channels;
+    }
+
+    Buffers[FillBuffer].bFiring = false;
+    TryPublish(FillBuffer);
+    FillBuffer = (FillBuffer + 1) % NumBuffers;
+    StartSweep();
+}
+
+void UVehicleLidarComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Sensors);
+
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (RayDirections.Num() == 0)
+    {
+        return;
+    }
+
+    int32 RayBudget = MaxRaysPerFrame;
+    float Remaining = 360.0f * RotationRate * DeltaTime;
+    while (Remaining > 0.0f)
+    {
+        const float Advance = FMath::Min(Remaining, 360.0f - SweepAngle);
+        SweepAngle += Advance;
+        Remaining -= Advance;
+
+        // Every column the head has passed in this revolution, as far as the budget allows
+        const int32 ReachedColumn = FMath::Min(FMath::FloorToInt32(SweepAngle / ColumnStep) + 1, ColumnsPerSweep);
+        if (ReachedColumn > NextColumn)
+        {
+            const int32 AffordableColumns = FMath::Max(RayBudget / Channels, 0);
+            const int32 EndColumn = FMath::Min(ReachedColumn, NextColumn + AffordableColumns);
+            FireColumns(NextColumn, EndColumn);
+            RayBudget -= (EndColumn - NextColumn) * Channels;
+            RaysSkipped += int64(ReachedColumn - EndColumn) * Channels;
+            NextColumn = ReachedColumn;
+        }
+
+        if (SweepAngle >= 360.0f)
+        {
+            SweepAngle = 0.0f;
+            FinishSweep();
+        }
+    }
+}
+
+void UVehicleLidarComponent::FireColumns(int32 FirstColumn, int32 EndColumn)
+{
+    UWorld* World = GetWorld();
+    const FTransform& SensorTransform = GetComponentTransform();
+    const FVector Start = SensorTransform.GetLocation();
+    FSweepBuffer& Buffer = Buffers[FillBuffer];
+    const uint32 Tag = (uint32(FillBuffer) << RayIndexBits) | (Buffer.Generation << (RayIndexBits + BufferBits));
+
+    for (int32 Ray = FirstColumn * Channels; Ray < EndColumn * Channels; Ray++)
+    {
+        const FVector Direction = SensorTransform.TransformVectorNoScale(FVector(RayDirections[Ray]));
+        World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, Start + Direction * Range, TraceChannel,
+            QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, Tag | uint32(Ray));
+    }
+
+    const int32 NumRays = (EndColumn - FirstColumn) * Channels;
+    Buffer.PendingRays += NumRays;
+    RaysFired += NumRays;
+}
+
+void UVehicleLidarComponent::OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+    const int32 Ray = Datum.UserData & ((1u << RayIndexBits) - 1);
+    const int32 BufferIndex = (Datum.UserData >> RayIndexBits) & ((1u << BufferBits) - 1);
+    const uint32 Generation = Datum.UserData >> (RayIndexBits + BufferBits);
+
+    FSweepBuffer& Buffer = Buffers[BufferIndex];
+    const uint32 GenerationMask = (1u << (32 - RayIndexBits - BufferBits)) - 1;
+    if ((Buffer.Generation & GenerationMask) != Generation || !Buffer.Points.IsValidIndex(Ray))
+    {
+        return;
+    }
+
+    if (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit)
+    {
+        const float Distance = Datum.OutHits[0].Distance;
+        Buffer.Points[Ray].Location = RayDirections[Ray] * Distance;
+        Buffer.Points[Ray].Range = Distance;
+    }
+
+    Buffer.PendingRays--;
+    TryPublish(BufferIndex);
+}
+
+void UVehicleLidarComponent::TryPublish(int32 BufferIndex)
+{
+    const FSweepBuffer& Buffer = Buffers[BufferIndex];
+    if (Buffer.bFiring || Buffer.PendingRays > 0)
+    {
+        return;
+    }
+
+    PublishedBuffer = BufferIndex;
+    NumSweeps++;
+    OnSweep.Broadcast(Buffer.Points);
+
+    if (UVehicleSharedMemorySubsystem* SharedMemory = GetWorld()->GetSubsystem<UVehicleSharedMemorySubsystem>())
+    {
+        SharedMemory->PublishLidarSweep(GetOwner(), Buffer.Points);
+    }
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs LidarAttachCommand(
+        TEXT("vehicle.Lidar.Attach"),
+        TEXT("Adds a lidar to the player's vehicle: vehicle.Lidar.Attach [Channels] [PointsPerSecond]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+            AVehicleBase* Vehicle = PlayerController ? Cast<AVehicleBase>(PlayerController->GetPawn()) : nullptr;
+            if (!Vehicle)
+            {
+                return;
+            }
+
+            UVehicleLidarComponent* Lidar = NewObject<UVehicleLidarComponent>(Vehicle);
+            Lidar->Channels = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : Lidar->Channels;
+            Lidar->PointsPerSecond = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : Lidar->PointsPerSecond;
+            Lidar->SetupAttachment(Vehicle->GetRootComponent());
+            Lidar->SetRelativeLocation(FVector(0.0f, 0.0f, 150.0f));
+            Lidar->RegisterComponent();
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs LidarStatsCommand(
+        TEXT("vehicle.Lidar.Stats"),
+        TEXT("Logs ray counts for every lidar in the world"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            for (TObjectIterator<UVehicleLidarComponent> It; It; ++It)
+            {
+                if (It->GetWorld() == World)
+                {
+                    UE_LOG(LogTemp, Log, TEXT("VehicleLidar: %s sweeps %d, rays fired %lld, skipped %lld, dropped %lld"),
+                        *It->GetOwner()->GetName(), It->GetNumSweeps(), It->GetRaysFired(), It->GetRaysSkipped(), It->GetRaysDropped());
+                }
+            }
+        }));
+}
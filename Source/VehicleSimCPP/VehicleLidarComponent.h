@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "VehicleLidarComponent.generated.h"
+
+// One lidar return in the sensor's frame at the moment the ray was fired
+struct FVehicleLidarPoint
+{
+    FVector3f Location = FVector3f::ZeroVector;
+    float Range = 0.0f;         // 0 when the ray hit nothing
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnVehicleLidarSweep, const TArray<FVehicleLidarPoint>& /*Points*/);
+
+// Spinning multi-channel lidar. Each frame fires the columns the head swept past as async line
+// traces; the physics scene runs them on worker threads and the results arrive on the game
+// thread a frame later, so the game frame never waits for rays. Returns go straight into
+// preallocated sweep buffers (channel-major within each column) that are published once every
+// ray of a revolution has come back.
+UCLASS(ClassGroup = (Vehicle), meta = (BlueprintSpawnableComponent))
+class VEHICLESIMCPP_API UVehicleLidarComponent : public USceneComponent
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleLidarComponent();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    int32 Channels = 32;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    float UpperFOV = 15.0f;         // degrees above the horizontal
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    float LowerFOV = -25.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    float HorizontalFOV = 360.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    float RotationRate = 10.0f;     // revolutions per second
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    int32 PointsPerSecond = 600000;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    float Range = 10000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+    // Columns beyond this in one frame (after a hitch) are skipped rather than traced
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lidar")
+    int32 MaxRaysPerFrame = 50000;
+
+    // The most recent complete revolution; valid until the next one is published
+    const TArray<FVehicleLidarPoint>& GetLatestSweep() const;
+    int32 GetNumSweeps() const { return NumSweeps; }
+
+    // Rays fired, skipped by the frame budget, and lost because a buffer was reused before
+    // its results came back
+    int64 GetRaysFired() const { return RaysFired; }
+    int64 GetRaysSkipped() const { return RaysSkipped; }
+    int64 GetRaysDropped() const { return RaysDropped; }
+
+    FOnVehicleLidarSweep OnSweep;
+
+protected:
+    virtual void BeginPlay() override;
+
+private:
+    // Three buffers: one being fired, one still waiting for last frame's results, one published
+    static constexpr int32 NumBuffers = 3;
+
+    // FTraceDatum::UserData layout: ray index, buffer, buffer generation
+    static constexpr uint32 RayIndexBits = 24;
+    static constexpr uint32 BufferBits = 2;
+
+    struct FSweepBuffer
+    {
+        TArray<FVehicleLidarPoint> Points;
+        int32 PendingRays = 0;
+        uint32 Generation = 0;
+        bool bFiring = false;
+    };
+
+    void Configure();
+    void StartSweep();
+    void FinishSweep();
+    void FireColumns(int32 FirstColumn, int32 EndColumn);
+    void OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+    void TryPublish(int32 BufferIndex);
+
+    FSweepBuffer Buffers[NumBuffers];
+    int32 FillBuffer = 0;
+    int32 PublishedBuffer = INDEX_NONE;
+
+    // Ray directions in the sensor frame, indexed like the sweep buffers
+    TArray<FVector3f> RayDirections;
+    int32 ColumnsPerSweep = 0;
+    float ColumnStep = 0.0f;        // degrees of head rotation between columns
+
+    float SweepAngle = 0.0f;
+    int32 NextColumn = 0;
+
+    FTraceDelegate TraceDelegate;
+    FCollisionQueryParams QueryParams;
+
+    int32 NumSweeps = 0;
+    int64 RaysFired = 0;
+    int64 RaysSkipped = 0;
+    int64 RaysDropped = 0;
+};
@@ -0,0 +1,604 @@
+#include "VehicleNetState.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ConfigCacheIni.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include <atomic>
+
+CSV_DEFINE_CATEGORY(VehicleNet, true);
+
+namespace
+{
+    // Quantization ranges
+    constexpr int32 PositionBits = 22;              // +-20.9 km at 1 cm
+    constexpr int32 PositionMax = (1 << (PositionBits - 1)) - 1;
+    constexpr int32 RotationComponentBits = 10;
+    constexpr int32 RotationComponentMax = (1 << RotationComponentBits) - 1;
+    constexpr float RotationComponentRange = 0.70710678f; // 1/sqrt(2)
+    constexpr int32 WheelSpinBits = 6;
+    constexpr int32 WheelSpinSteps = 1 << WheelSpinBits;
+    constexpr int32 WheelSuspensionBits = 4;
+    constexpr float WheelSuspensionRange = 10.0f;   // +-10 cm of suspension travel
+    constexpr int32 SequenceBits = 8;
+    constexpr int32 SequenceMask = (1 << SequenceBits) - 1;
+
+    // Each delta is sent as a 2 bit size class followed by a zigzag encoded value.
+    // The last class is wide enough to hold any difference for that field.
+    struct FDeltaClasses
+    {
+        uint8 Bits[4];
+    };
+
+    constexpr FDeltaClasses PositionClasses = { { 4, 8, 12, PositionBits + 2 } };
+    constexpr FDeltaClasses VelocityClasses = { { 4, 8, 12, 17 } };
+    constexpr FDeltaClasses RotationClasses = { { 3, 5, 8, RotationComponentBits + 1 } };
+    constexpr FDeltaClasses WheelSpinClasses = { { 2, 3, 4, WheelSpinBits } };
+    constexpr FDeltaClasses MoveSequenceClasses = { { 2, 4, 8, 17 } };
+
+    uint32 ZigZag(int32 Value)
+    {
+        return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+    }
+
+    int32 UnZigZag(uint32 Value)
+    {
+        return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+    }
+
+    void WriteBits(FBitWriter& Writer, uint32 Value, int32 NumBits)
+    {
+        Writer.SerializeBits(&Value, NumBits);
+    }
+
+    uint32 ReadBits(FBitReader& Reader, int32 NumBits)
+    {
+        uint32 Value = 0;
+        Reader.SerializeBits(&Value, NumBits);
+        return Value;
+    }
+
+    void WriteDeltaValue(FBitWriter& Writer, int32 Delta, const FDeltaClasses& Classes)
+    {
+        const uint32 Encoded = ZigZag(Delta);
+        uint32 Class = 0;
+        while (Class < 3 && Encoded >= (1u << Classes.Bits[Class]))
+        {
+            ++Class;
+        }
+        WriteBits(Writer, Class, 2);
+        WriteBits(Writer, Encoded, Classes.Bits[Class]);
+    }
+
+    int32 ReadDeltaValue(FBitReader& Reader, const FDeltaClasses& Classes)
+    {
+        const uint32 Class = ReadBits(Reader, 2);
+        return UnZigZag(ReadBits(Reader, Classes.Bits[Class]));
+    }
+
+    // Wraps a wheel spin difference into [-WheelSpinSteps/2, WheelSpinSteps/2)
+    int32 WrapSpinDelta(int32 Delta)
+    {
+        Delta &= WheelSpinSteps - 1;
+        return Delta >= WheelSpinSteps / 2 ? Delta - WheelSpinSteps : Delta;
+    }
+
+    int32 QuantizeSigned(float Value, float Scale, int32 Max)
+    {
+        return FMath::Clamp(FMath::RoundToInt(Value * Scale), -Max, Max);
+    }
+
+    // Base state UE hands back to us for the next delta against this connection
+    class FVehicleNetDeltaBase : public INetDeltaBaseState
+    {
+    public:
+        FVehicleQuantizedState State;
+        int32 Sequence = 0;
+        int32 DeltaChain = 0;
+
+        virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+        {
+            const FVehicleNetDeltaBase* Other = static_cast<FVehicleNetDeltaBase*>(OtherState);
+            return Other && Other->State == State;
+        }
+    };
+
+    std::atomic<int64> GNumUpdates(0);
+    std::atomic<int64> GNumDeltaUpdates(0);
+    std::atomic<int64> GTotalBits(0);
+
+    FAutoConsoleCommand DumpBandwidthCommand(
+        TEXT("vehicle.Net.DumpBandwidth"),
+        TEXT("Logs the average size of replicated vehicle state updates"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            UE_LOG(LogTemp, Log, TEXT("VehicleNet: %lld updates (%lld deltas), %lld bits total, %.2f bytes/update"),
+                FVehicleNetStats::GetNumUpdates(), FVehicleNetStats::GetNumDeltaUpdates(),
+                FVehicleNetStats::GetTotalBits(), FVehicleNetStats::GetAverageBytesPerUpdate());
+        }));
+
+    FAutoConsoleCommand ResetBandwidthCommand(
+        TEXT("vehicle.Net.ResetBandwidth"),
+        TEXT("Resets the replicated vehicle state bandwidth counters"),
+        FConsoleCommandDelegate::CreateStatic(&FVehicleNetStats::Reset));
+}
+
+bool FVehicleQuantizedState::operator==(const FVehicleQuantizedState& Other) const
+{
+    return FMemory::Memcmp(Position, Other.Position, sizeof(Position)) == 0
+        && Rotation == Other.Rotation
+        && FMemory::Memcmp(Velocity, Other.Velocity, sizeof(Velocity)) == 0
+        && Steering == Other.Steering
+        && Throttle == Other.Throttle
+        && bBraking == Other.bBraking
+        && FMemory::Memcmp(WheelSpin, Other.WheelSpin, sizeof(WheelSpin)) == 0
+        && FMemory::Memcmp(WheelSuspension, Other.WheelSuspension, sizeof(WheelSuspension)) == 0
+        && LastProcessedMove == Other.LastProcessedMove;
+}
+
+FVehicleMoveInput FVehicleMoveInput::Make(uint16 InSequence, float DeltaTime, float InThrottle, float InSteering, bool bInBrake)
+{
+    FVehicleMoveInput Move;
+    Move.Sequence = InSequence;
+    Move.DeltaTimeQuantized = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(DeltaTime * 10000.0f), 1, MAX_uint16));
+    Move.Throttle = static_cast<int8>(QuantizeSigned(InThrottle, 127.0f, 127));
+    Move.Steering = static_cast<int8>(QuantizeSigned(InSteering, 127.0f, 127));
+    Move.bBrake = bInBrake;
+    return Move;
+}
+
+bool FVehicleMoveInput::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    Ar << Sequence;
+    Ar << DeltaTimeQuantized;
+    Ar << Throttle;
+    Ar << Steering;
+
+    uint8 BrakeBit = bBrake ? 1 : 0;
+    Ar.SerializeBits(&BrakeBit, 1);
+    bBrake = BrakeBit != 0;
+
+    bOutSuccess = true;
+    return true;
+}
+
+const FVector& VehicleNetQuantization::GetTrackOrigin()
+{
+    static FVector TrackOrigin = []()
+    {
+        FVector Origin = FVector::ZeroVector;
+        if (GConfig)
+        {
+            GConfig->GetVector(TEXT("VehicleSim.Net"), TEXT("TrackOrigin"), Origin, GGameIni);
+        }
+        return Origin;
+    }();
+    return TrackOrigin;
+}
+
+uint32 VehicleNetQuantization::PackRotation(const FQuat& Rotation)
+{
+    FQuat Q = Rotation.GetNormalized();
+    float Components[4] = { static_cast<float>(Q.X), static_cast<float>(Q.Y), static_cast<float>(Q.Z), static_cast<float>(Q.W) };
+
+    // Drop the largest component; it can be rebuilt from the other three
+    int32 LargestIndex = 0;
+    for (int32 i = 1; i < 4; i++)
+    {
+        if (FMath::Abs(Components[i]) > FMath::Abs(Components[LargestIndex]))
+        {
+            LargestIndex = i;
+        }
+    }
+
+    // q and -q are the same rotation, so make the dropped component positive
+    const float Sign = Components[LargestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    uint32 Packed = static_cast<uint32>(LargestIndex);
+    int32 Shift = 2;
+    for (int32 i = 0; i < 4; i++)
+    {
+        if (i == LargestIndex)
+        {
+            continue;
+        }
+        const float Normalized = (Components[i] * Sign + RotationComponentRange) / (2.0f * RotationComponentRange);
+        const uint32 Value = static_cast<uint32>(FMath::Clamp(FMath::RoundToInt(Normalized * RotationComponentMax), 0, RotationComponentMax));
+        Packed |= Value << Shift;
+        Shift += RotationComponentBits;
+    }
+    return Packed;
+}
+
+FQuat VehicleNetQuantization::UnpackRotation(uint32 Packed)
+{
+    const int32 LargestIndex = Packed & 3;
+    float Components[4];
+    float SumSquares = 0.0f;
+    int32 Shift = 2;
+    for (int32 i = 0; i < 4; i++)
+    {
+        if (i == LargestIndex)
+        {
+            continue;
+        }
+        const uint32 Value = (Packed >> Shift) & RotationComponentMax;
+        Components[i] = (static_cast<float>(Value) / RotationComponentMax) * (2.0f * RotationComponentRange) - RotationComponentRange;
+        SumSquares += Components[i] * Components[i];
+        Shift += RotationComponentBits;
+    }
+    Components[LargestIndex] = FMath::Sqrt(FMath::Max(0.0f, 1.0f - SumSquares));
+
+    return FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+}
+
+FVehicleQuantizedState VehicleNetQuantization::Quantize(const FVehicleNetSnapshot& Snapshot)
+{
+    FVehicleQuantizedState State;
+
+    const FVector Relative = Snapshot.Location - GetTrackOrigin();
+    for (int32 Axis = 0; Axis < 3; Axis++)
+    {
+        State.Position[Axis] = QuantizeSigned(Relative[Axis], 1.0f, PositionMax);
+        State.Velocity[Axis] = static_cast<int16>(QuantizeSigned(Snapshot.Velocity[Axis], 1.0f, MAX_int16));
+    }
+
+    State.Rotation = PackRotation(Snapshot.Rotation);
+    State.Steering = static_cast<int8>(QuantizeSigned(Snapshot.Steering, 127.0f, 127));
+    State.Throttle = static_cast<int8>(QuantizeSigned(Snapshot.Throttle, 127.0f, 127));
+    State.bBraking = Snapshot.bBraking;
+
+    for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+    {
+        const float Spin = FRotator::ClampAxis(Snapshot.WheelSpinDegrees[Wheel]) / 360.0f;
+        State.WheelSpin[Wheel] = static_cast<uint8>(FMath::RoundToInt(Spin * WheelSpinSteps) & (WheelSpinSteps - 1));
+
+        const float Suspension = (FMath::Clamp(Snapshot.WheelSuspension[Wheel], -WheelSuspensionRange, WheelSuspensionRange) + WheelSuspensionRange) / (2.0f * WheelSuspensionRange);
+        State.WheelSuspension[Wheel] = static_cast<uint8>(FMath::RoundToInt(Suspension * ((1 << WheelSuspensionBits) - 1)));
+    }
+
+    State.LastProcessedMove = Snapshot.LastProcessedMove;
+
+    return State;
+}
+
+FVehicleNetSnapshot VehicleNetQuantization::Dequantize(const FVehicleQuantizedState& State)
+{
+    FVehicleNetSnapshot Snapshot;
+
+    Snapshot.Location = GetTrackOrigin() + FVector(State.Position[0], State.Position[1], State.Position[2]);
+    Snapshot.Rotation = UnpackRotation(State.Rotation);
+    Snapshot.Velocity = FVector(State.Velocity[0], State.Velocity[1], State.Velocity[2]);
+    Snapshot.Steering = State.Steering / 127.0f;
+    Snapshot.Throttle = State.Throttle / 127.0f;
+    Snapshot.bBraking = State.bBraking;
+
+    for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+    {
+        Snapshot.WheelSpinDegrees[Wheel] = State.WheelSpin[Wheel] * (360.0f / WheelSpinSteps);
+        Snapshot.WheelSuspension[Wheel] = (State.WheelSuspension[Wheel] / static_cast<float>((1 << WheelSuspensionBits) - 1)) * (2.0f * WheelSuspensionRange) - WheelSuspensionRange;
+    }
+
+    Snapshot.LastProcessedMove = State.LastProcessedMove;
+
+    return Snapshot;
+}
+
+void FVehicleNetStats::RecordUpdate(int64 NumBits, bool bWasDelta)
+{
+    GNumUpdates.fetch_add(1, std::memory_order_relaxed);
+    GTotalBits.fetch_add(NumBits, std::memory_order_relaxed);
+    if (bWasDelta)
+    {
+        GNumDeltaUpdates.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CSV_CUSTOM_STAT(VehicleNet, StateUpdates, 1, ECsvCustomStatOp::Accumulate);
+    CSV_CUSTOM_STAT(VehicleNet, StateBits, static_cast<int32>(NumBits), ECsvCustomStatOp::Accumulate);
+}
+
+void FVehicleNetStats::Reset()
+{
+    GNumUpdates = 0;
+    GNumDeltaUpdates = 0;
+    GTotalBits = 0;
+}
+
+int64 FVehicleNetStats::GetNumUpdates()
+{
+    return GNumUpdates.load(std::memory_order_relaxed);
+}
+
+int64 FVehicleNetStats::GetNumDeltaUpdates()
+{
+    return GNumDeltaUpdates.load(std::memory_order_relaxed);
+}
+
+int64 FVehicleNetStats::GetTotalBits()
+{
+    return GTotalBits.load(std::memory_order_relaxed);
+}
+
+double FVehicleNetStats::GetAverageBytesPerUpdate()
+{
+    const int64 Updates = GetNumUpdates();
+    return Updates > 0 ? (GetTotalBits() / 8.0) / Updates : 0.0;
+}
+
+void FVehicleReplicatedState::SetSnapshot(const FVehicleNetSnapshot& InSnapshot)
+{
+    Current = VehicleNetQuantization::Quantize(InSnapshot);
+    Snapshot = VehicleNetQuantization::Dequantize(Current);
+    bHasValidState = true;
+}
+
+bool FVehicleReplicatedState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+    // The state holds no object references, so there is nothing to map or gather
+    if (DeltaParms.bUpdateUnmappedObjects || DeltaParms.GatherGuidReferences || DeltaParms.MoveGuidToUnmapped)
+    {
+        return true;
+    }
+
+    if (DeltaParms.Writer)
+    {
+        return WriteDelta(DeltaParms);
+    }
+    if (DeltaParms.Reader)
+    {
+        return ReadDelta(DeltaParms);
+    }
+    return false;
+}
+
+bool FVehicleReplicatedState::WriteDelta(FNetDeltaSerializeInfo& DeltaParms)
+{
+    // OldState is the last state this connection acknowledged (nullptr on first send)
+    const FVehicleNetDeltaBase* OldBase = static_cast<FVehicleNetDeltaBase*>(DeltaParms.OldState);
+    if (OldBase && OldBase->State == Current)
+    {
+        return false;
+    }
+
+    const bool bHasBase = OldBase && OldBase->DeltaChain < MaxDeltaChain;
+    const FVehicleQuantizedState BaseState = bHasBase ? OldBase->State : FVehicleQuantizedState();
+
+    TSharedPtr<FVehicleNetDeltaBase> NewBase = MakeShared<FVehicleNetDeltaBase>();
+    NewBase->State = Current;
+    NewBase->Sequence = OldBase ? ((OldBase->Sequence + 1) & SequenceMask) : 0;
+    NewBase->DeltaChain = bHasBase ? OldBase->DeltaChain + 1 : 0;
+
+    FBitWriter& Writer = *DeltaParms.Writer;
+    const int64 StartBits = Writer.GetNumBits();
+
+    // Header: which state this is relative to and its own sequence
+    Writer.WriteBit(bHasBase ? 1 : 0);
+    if (bHasBase)
+    {
+        WriteBits(Writer, OldBase->Sequence, SequenceBits);
+    }
+    WriteBits(Writer, NewBase->Sequence, SequenceBits);
+
+    // Position
+    const bool bPositionChanged = FMemory::Memcmp(Current.Position, BaseState.Position, sizeof(Current.Position)) != 0;
+    Writer.WriteBit(bPositionChanged ? 1 : 0);
+    if (bPositionChanged)
+    {
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            WriteDeltaValue(Writer, Current.Position[Axis] - BaseState.Position[Axis], PositionClasses);
+        }
+    }
+
+    // Rotation: small per-component deltas while the dropped component stays the same
+    const bool bRotationChanged = Current.Rotation != BaseState.Rotation;
+    Writer.WriteBit(bRotationChanged ? 1 : 0);
+    if (bRotationChanged)
+    {
+        const bool bSameIndex = (Current.Rotation & 3) == (BaseState.Rotation & 3);
+        Writer.WriteBit(bSameIndex ? 1 : 0);
+        if (bSameIndex)
+        {
+            for (int32 Component = 0; Component < 3; Component++)
+            {
+                const int32 Shift = 2 + Component * RotationComponentBits;
+                const int32 NewValue = (Current.Rotation >> Shift) & RotationComponentMax;
+                const int32 OldValue = (BaseState.Rotation >> Shift) & RotationComponentMax;
+                WriteDeltaValue(Writer, NewValue - OldValue, RotationClasses);
+            }
+        }
+        else
+        {
+            WriteBits(Writer, Current.Rotation, 32);
+        }
+    }
+
+    // Velocity
+    const bool bVelocityChanged = FMemory::Memcmp(Current.Velocity, BaseState.Velocity, sizeof(Current.Velocity)) != 0;
+    Writer.WriteBit(bVelocityChanged ? 1 : 0);
+    if (bVelocityChanged)
+    {
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            WriteDeltaValue(Writer, Current.Velocity[Axis] - BaseState.Velocity[Axis], VelocityClasses);
+        }
+    }
+
+    // Driver controls
+    const bool bControlsChanged = Current.Steering != BaseState.Steering || Current.Throttle != BaseState.Throttle || Current.bBraking != BaseState.bBraking;
+    Writer.WriteBit(bControlsChanged ? 1 : 0);
+    if (bControlsChanged)
+    {
+        WriteBits(Writer, static_cast<uint8>(Current.Steering), 8);
+        WriteBits(Writer, static_cast<uint8>(Current.Throttle), 8);
+        Writer.WriteBit(Current.bBraking ? 1 : 0);
+    }
+
+    // Wheel spin: all wheels usually turn by the same amount, so send that once
+    const bool bSpinChanged = FMemory::Memcmp(Current.WheelSpin, BaseState.WheelSpin, sizeof(Current.WheelSpin)) != 0;
+    Writer.WriteBit(bSpinChanged ? 1 : 0);
+    if (bSpinChanged)
+    {
+        int32 SpinDeltas[FVehicleQuantizedState::NumWheels];
+        bool bUniformSpin = true;
+        for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+        {
+            SpinDeltas[Wheel] = WrapSpinDelta(Current.WheelSpin[Wheel] - BaseState.WheelSpin[Wheel]);
+            bUniformSpin &= SpinDeltas[Wheel] == SpinDeltas[0];
+        }
+
+        Writer.WriteBit(bUniformSpin ? 1 : 0);
+        const int32 NumSpinValues = bUniformSpin ? 1 : FVehicleQuantizedState::NumWheels;
+        for (int32 Wheel = 0; Wheel < NumSpinValues; Wheel++)
+        {
+            WriteDeltaValue(Writer, SpinDeltas[Wheel], WheelSpinClasses);
+        }
+    }
+
+    // Suspension
+    const bool bSuspensionChanged = FMemory::Memcmp(Current.WheelSuspension, BaseState.WheelSuspension, sizeof(Current.WheelSuspension)) != 0;
+    Writer.WriteBit(bSuspensionChanged ? 1 : 0);
+    if (bSuspensionChanged)
+    {
+        for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+        {
+            WriteBits(Writer, Current.WheelSuspension[Wheel], WheelSuspensionBits);
+        }
+    }
+
+    // Last applied client move, used by the owning client to reconcile its prediction
+    const bool bMoveChanged = Current.LastProcessedMove != BaseState.LastProcessedMove;
+    Writer.WriteBit(bMoveChanged ? 1 : 0);
+    if (bMoveChanged)
+    {
+        WriteDeltaValue(Writer, static_cast<int16>(Current.LastProcessedMove - BaseState.LastProcessedMove), MoveSequenceClasses);
+    }
+
+    FVehicleNetStats::RecordUpdate(Writer.GetNumBits() - StartBits, bHasBase);
+
+    *DeltaParms.NewState = NewBase;
+    return true;
+}
+
+bool FVehicleReplicatedState::ReadDelta(FNetDeltaSerializeInfo& DeltaParms)
+{
+    if (!bHistoryInitialized)
+    {
+        for (int32 i = 0; i < HistorySize; i++)
+        {
+            ReceivedSequence[i] = INDEX_NONE;
+        }
+        bHistoryInitialized = true;
+    }
+
+    FBitReader& Reader = *DeltaParms.Reader;
+
+    const bool bHasBase = Reader.ReadBit() != 0;
+    const int32 BaseSequence = bHasBase ? static_cast<int32>(ReadBits(Reader, SequenceBits)) : INDEX_NONE;
+    const int32 NewSequence = static_cast<int32>(ReadBits(Reader, SequenceBits));
+
+    // If the base is gone (e.g. it was in a lost packet) we still have to consume the bits,
+    // but the result is discarded until the next state we can decode
+    bool bBaseAvailable = true;
+    FVehicleQuantizedState State;
+    if (bHasBase)
+    {
+        const int32 Slot = BaseSequence % HistorySize;
+        bBaseAvailable = ReceivedSequence[Slot] == BaseSequence;
+        if (bBaseAvailable)
+        {
+            State = ReceivedHistory[Slot];
+        }
+    }
+
+    if (Reader.ReadBit())
+    {
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            State.Position[Axis] += ReadDeltaValue(Reader, PositionClasses);
+        }
+    }
+
+    if (Reader.ReadBit())
+    {
+        if (Reader.ReadBit())
+        {
+            uint32 Rotation = State.Rotation & 3;
+            for (int32 Component = 0; Component < 3; Component++)
+            {
+                const int32 Shift = 2 + Component * RotationComponentBits;
+                const int32 OldValue = (State.Rotation >> Shift) & RotationComponentMax;
+                const int32 NewValue = (OldValue + ReadDeltaValue(Reader, RotationClasses)) & RotationComponentMax;
+                Rotation |= static_cast<uint32>(NewValue) << Shift;
+            }
+            State.Rotation = Rotation;
+        }
+        else
+        {
+            State.Rotation = ReadBits(Reader, 32);
+        }
+    }
+
+    if (Reader.ReadBit())
+    {
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            State.Velocity[Axis] = static_cast<int16>(State.Velocity[Axis] + ReadDeltaValue(Reader, VelocityClasses));
+        }
+    }
+
+    if (Reader.ReadBit())
+    {
+        State.Steering = static_cast<int8>(ReadBits(Reader, 8));
+        State.Throttle = static_cast<int8>(ReadBits(Reader, 8));
+        State.bBraking = Reader.ReadBit() != 0;
+    }
+
+    if (Reader.ReadBit())
+    {
+        const bool bUniformSpin = Reader.ReadBit() != 0;
+        int32 SpinDeltas[FVehicleQuantizedState::NumWheels];
+        SpinDeltas[0] = ReadDeltaValue(Reader, WheelSpinClasses);
+        for (int32 Wheel = 1; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+        {
+            SpinDeltas[Wheel] = bUniformSpin ? SpinDeltas[0] : ReadDeltaValue(Reader, WheelSpinClasses);
+        }
+        for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+        {
+            State.WheelSpin[Wheel] = static_cast<uint8>((State.WheelSpin[Wheel] + SpinDeltas[Wheel]) & (WheelSpinSteps - 1));
+        }
+    }
+
+    if (Reader.ReadBit())
+    {
+        for (int32 Wheel = 0; Wheel < FVehicleQuantizedState::NumWheels; Wheel++)
+        {
+            State.WheelSuspension[Wheel] = static_cast<uint8>(ReadBits(Reader, WheelSuspensionBits));
+        }
+    }
+
+    if (Reader.ReadBit())
+    {
+        State.LastProcessedMove = static_cast<uint16>(State.LastProcessedMove + ReadDeltaValue(Reader, MoveSequenceClasses));
+    }
+
+    if (Reader.IsError())
+    {
+        return false;
+    }
+
+    if (!bBaseAvailable)
+    {
+        UE_LOG(LogTemp, Verbose, TEXT("VehicleNetState: Dropping state %d, base %d is no longer available"), NewSequence, BaseSequence);
+        return true;
+    }
+
+    const int32 NewSlot = NewSequence % HistorySize;
+    ReceivedHistory[NewSlot] = State;
+    ReceivedSequence[NewSlot] = NewSequence;
+
+    Current = State;
+    Snapshot = VehicleNetQuantization::Dequantize(Current);
+    bHasValidState = true;
+    return true;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "VehicleNetState.generated.h"
+
+class AVehicleBase;
+
+// Quantized vehicle state as it travels over the wire.
+// Everything is stored as integers so deltas and equality checks are exact on both ends.
+struct FVehicleQuantizedState
+{
+    static constexpr int32 NumWheels = 4;
+
+    int32 Position[3] = { 0, 0, 0 };        // 1 cm steps relative to the track origin
+    uint32 Rotation = 0;                    // Smallest-three: 2 bit index + 3 x 10 bit components
+    int16 Velocity[3] = { 0, 0, 0 };        // 1 cm/s steps
+    int8 Steering = 0;                      // -127..127
+    int8 Throttle = 0;                      // -127..127
+    bool bBraking = false;
+    uint8 WheelSpin[NumWheels] = { 0, 0, 0, 0 };       // 6 bit wheel rotation angle
+    uint8 WheelSuspension[NumWheels] = { 0, 0, 0, 0 }; // 4 bit suspension compression
+    uint16 LastProcessedMove = 0;           // Sequence of the last client move the server applied
+
+    bool operator==(const FVehicleQuantizedState& Other) const;
+    bool operator!=(const FVehicleQuantizedState& Other) const { return !(*this == Other); }
+};
+
+// Plain (unquantized) view of the replicated state
+struct FVehicleNetSnapshot
+{
+    FVector Location = FVector::ZeroVector;
+    FQuat Rotation = FQuat::Identity;
+    FVector Velocity = FVector::ZeroVector;
+    float Steering = 0.0f;
+    float Throttle = 0.0f;
+    bool bBraking = false;
+    float WheelSpinDegrees[FVehicleQuantizedState::NumWheels] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float WheelSuspension[FVehicleQuantizedState::NumWheels] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    uint16 LastProcessedMove = 0;
+};
+
+// One tick of driver input, sent from the owning client to the server.
+// Values are stored quantized so client prediction and the server simulate exactly the same move.
+USTRUCT()
+struct VEHICLESIMCPP_API FVehicleMoveInput
+{
+    GENERATED_BODY()
+
+public:
+    uint16 Sequence = 0;
+    uint16 DeltaTimeQuantized = 0;   // 0.1 ms steps
+    int8 Throttle = 0;
+    int8 Steering = 0;
+    bool bBrake = false;
+
+    static FVehicleMoveInput Make(uint16 InSequence, float DeltaTime, float InThrottle, float InSteering, bool bInBrake);
+
+    float GetDeltaTime() const { return DeltaTimeQuantized * 0.0001f; }
+    float GetThrottle() const { return Throttle / 127.0f; }
+    float GetSteering() const { return Steering / 127.0f; }
+
+    // True if sequence A was issued after B, allowing for wrap-around
+    static bool IsNewer(uint16 A, uint16 B) { return static_cast<int16>(A - B) > 0; }
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FVehicleMoveInput> : public TStructOpsTypeTraitsBase2<FVehicleMoveInput>
+{
+    enum
+    {
+        WithNetSerializer = true,
+    };
+};
+
+namespace VehicleNetQuantization
+{
+    // Origin all replicated positions are relative to. Read from [VehicleSim.Net] in Game.ini.
+    VEHICLESIMCPP_API const FVector& GetTrackOrigin();
+
+    VEHICLESIMCPP_API FVehicleQuantizedState Quantize(const FVehicleNetSnapshot& Snapshot);
+    VEHICLESIMCPP_API FVehicleNetSnapshot Dequantize(const FVehicleQuantizedState& State);
+
+    VEHICLESIMCPP_API uint32 PackRotation(const FQuat& Rotation);
+    VEHICLESIMCPP_API FQuat UnpackRotation(uint32 Packed);
+}
+
+// Running bandwidth counters for vehicle state replication (server side)
+struct VEHICLESIMCPP_API FVehicleNetStats
+{
+    static void RecordUpdate(int64 NumBits, bool bWasDelta);
+    static void Reset();
+
+    static int64 GetNumUpdates();
+    static int64 GetNumDeltaUpdates();
+    static int64 GetTotalBits();
+    static double GetAverageBytesPerUpdate();
+};
+
+// Replicated vehicle state. Serialized as a delta against the last state the
+// receiving connection acknowledged (see NetDeltaSerialize).
+USTRUCT()
+struct VEHICLESIMCPP_API FVehicleReplicatedState
+{
+    GENERATED_BODY()
+
+public:
+    // Number of received states the client keeps around to resolve delta bases
+    static constexpr int32 HistorySize = 32;
+
+    // Send a full state at least this often so a client can always recover
+    static constexpr int32 MaxDeltaChain = 64;
+
+    // Server: update the state that will be sent on the next replication pass
+    void SetSnapshot(const FVehicleNetSnapshot& Snapshot);
+
+    // Client: the last state that was successfully decoded
+    const FVehicleNetSnapshot& GetSnapshot() const { return Snapshot; }
+    const FVehicleQuantizedState& GetQuantized() const { return Current; }
+    bool HasValidState() const { return bHasValidState; }
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+private:
+    bool WriteDelta(FNetDeltaSerializeInfo& DeltaParms);
+    bool ReadDelta(FNetDeltaSerializeInfo& DeltaParms);
+
+    FVehicleQuantizedState Current;
+    FVehicleNetSnapshot Snapshot;
+    bool bHasValidState = false;
+
+    // Client side history of received states, indexed by sequence
+    FVehicleQuantizedState ReceivedHistory[HistorySize];
+    int32 ReceivedSequence[HistorySize];
+    bool bHistoryInitialized = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVehicleReplicatedState> : public TStructOpsTypeTraitsBase2<FVehicleReplicatedState>
+{
+    enum
+    {
+        WithNetDeltaSerializer = true,
+    };
+};
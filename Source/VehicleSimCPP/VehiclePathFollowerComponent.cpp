@@ -0,0 +1,242 @@
+#include "VehiclePathFollowerComponent.h"
+#include "VehicleBase.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    // Poses record the direction of the step that arrived at them; the stretch starting at
+    // From runs until that direction changes
+    int32 FindSectionEnd(const TArray<FVehiclePathPose>& Poses, int32 From)
+    {
+        int32 End = FMath::Min(From + 1, Poses.Num() - 1);
+        while (End + 1 < Poses.Num() && Poses[End + 1].bReverse == Poses[From + 1].bReverse)
+        {
+            End++;
+        }
+        return End;
+    }
+
+    FVector2D ClosestPointOnSegment(const FVector2D& Point, const FVector2D& A, const FVector2D& B, float& OutAlpha)
+    {
+        const FVector2D AB = B - A;
+        const float LengthSquared = AB.SizeSquared();
+        OutAlpha = LengthSquared > UE_SMALL_NUMBER ? FMath::Clamp(FVector2D::DotProduct(Point - A, AB) / LengthSquared, 0.0f, 1.0f) : 0.0f;
+        return A + AB * OutAlpha;
+    }
+}
+
+UVehiclePathFollowerComponent::UVehiclePathFollowerComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UVehiclePathFollowerComponent::PlanTo(const FVector& InGoalLocation, float InGoalYaw)
+{
+    GoalLocation = InGoalLocation;
+    GoalYaw = InGoalYaw;
+    NumReplans = 0;
+    StartPlan();
+}
+
+void UVehiclePathFollowerComponent::StartPlan()
+{
+    AVehicleBase* Vehicle = Cast<AVehicleBase>(GetOwner());
+    if (!Vehicle)
+    {
+        return;
+    }
+
+    Stop();
+
+    // Run after the controller's axis bindings (which overwrite the inputs every frame) and
+    // before the vehicle consumes them
+    if (AController* Controller = Vehicle->GetController())
+    {
+        PrimaryComponentTick.AddPrerequisite(Controller, Controller->PrimaryActorTick);
+    }
+    Vehicle->PrimaryActorTick.AddPrerequisite(this, PrimaryComponentTick);
+
+    // Scene queries have to happen here; the search itself runs on a worker
+    const FVector StartLocation = Vehicle->GetActorLocation();
+    const FVector Center = 0.5f * (StartLocation + GoalLocation);
+    const float HalfExtent = 0.5f * FVector2D::Distance(FVector2D(StartLocation), FVector2D(GoalLocation)) + GridMargin;
+    TSharedRef<const FVehicleOccupancyGrid, ESPMode::ThreadSafe> Grid = FVehicleOccupancyGrid::BuildFromStaticCollision(
+        GetWorld(), FVector(Center.X, Center.Y, StartLocation.Z), HalfExtent, GridCellSize, 20.0f, 200.0f, Vehicle);
+
+    const FVehiclePathPose Start{ FVector2D(StartLocation), static_cast<float>(Vehicle->GetActorRotation().Yaw), false };
+    const FVehiclePathPose Goal{ FVector2D(GoalLocation), GoalYaw, false };
+    PlanTask = VehicleHybridAStar::PlanAsync(Grid, Start, Goal, Settings);
+}
+
+void UVehiclePathFollowerComponent::Stop()
+{
+    // An in-flight plan finishes on its own; its result is just ignored
+    PlanTask = {};
+    Path = FVehiclePlannedPath();
+    PoseIndex = 0;
+    SectionEnd = 0;
+    bFollowing = false;
+
+    if (AVehicleBase* Vehicle = Cast<AVehicleBase>(GetOwner()))
+    {
+        Vehicle->SetDriverInput(0.0f, 0.0f, false);
+    }
+}
+
+void UVehiclePathFollowerComponent::FinishSection(AVehicleBase& Vehicle)
+{
+    // Stop for a frame at a direction change or the goal
+    Vehicle.SetDriverInput(0.0f, 0.0f, true);
+
+    if (SectionEnd < Path.Poses.Num() - 1)
+    {
+        PoseIndex = SectionEnd;
+        SectionEnd = FindSectionEnd(Path.Poses, PoseIndex);
+        return;
+    }
+
+    bFollowing = false;
+    const FVehiclePathPose& Goal = Path.Poses.Last();
+    UE_LOG(LogTemp, Log, TEXT("VehiclePathFollower: %s arrived %.0f units and %.1f degrees from the planned goal after %d replans"), *Vehicle.GetName(),
+        FVector2D::Distance(FVector2D(Vehicle.GetActorLocation()), Goal.Location),
+        FMath::Abs(FRotator::NormalizeAxis(Vehicle.GetActorRotation().Yaw - Goal.Yaw)), NumReplans);
+}
+
+void UVehiclePathFollowerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    AVehicleBase* Vehicle = Cast<AVehicleBase>(GetOwner());
+    if (!Vehicle)
+    {
+        return;
+    }
+
+    if (PlanTask.IsValid() && PlanTask.IsCompleted())
+    {
+        Path = MoveTemp(PlanTask.GetResult());
+        PlanTask = {};
+        bFollowing = Path.bSuccess && Path.Poses.Num() > 1;
+        PoseIndex = 0;
+        SectionEnd = bFollowing ? FindSectionEnd(Path.Poses, 0) : 0;
+        UE_LOG(LogTemp, Log, TEXT("VehiclePathFollower: %s %s, %d segments, %d expansions, %.1f ms"), *Vehicle->GetName(),
+            Path.bSuccess ? TEXT("found a path") : TEXT("found no path"), Path.Segments.Num(), Path.NumExpanded, Path.PlanningSeconds * 1000.0);
+    }
+
+    if (!bFollowing)
+    {
+        return;
+    }
+
+    const TArray<FVehiclePathPose>& Poses = Path.Poses;
+    const FVector2D Location(Vehicle->GetActorLocation());
+
+    // Project onto the current stretch, never going back past the segment already reached
+    int32 ClosestSegment = PoseIndex;
+    float ClosestAlpha = 0.0f;
+    float ClosestDistanceSquared = TNumericLimits<float>::Max();
+    for (int32 i = PoseIndex; i < SectionEnd; i++)
+    {
+        float Alpha;
+        const FVector2D Closest = ClosestPointOnSegment(Location, Poses[i].Location, Poses[i + 1].Location, Alpha);
+        const float DistanceSquared = FVector2D::DistSquared(Location, Closest);
+        if (DistanceSquared < ClosestDistanceSquared)
+        {
+            ClosestSegment = i;
+            ClosestAlpha = Alpha;
+            ClosestDistanceSquared = DistanceSquared;
+        }
+    }
+    PoseIndex = ClosestSegment;
+
+    // Knocked off the path: the rest of it is no longer reachable as planned
+    if (ClosestDistanceSquared > FMath::Square(ReplanDistance))
+    {
+        if (NumReplans >= MaxReplans)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("VehiclePathFollower: %s is %.0f units off the path and out of replans; stopping"),
+                *Vehicle->GetName(), FMath::Sqrt(ClosestDistanceSquared));
+            Stop();
+            return;
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("VehiclePathFollower: %s is %.0f units off the path; replanning"), *Vehicle->GetName(), FMath::Sqrt(ClosestDistanceSquared));
+        NumReplans++;
+        StartPlan();
+        return;
+    }
+
+    // Walk forward from the projection for the remaining distance and the lookahead point
+    const FVector2D SegmentStart = Poses[ClosestSegment].Location;
+    const FVector2D SegmentEnd = Poses[ClosestSegment + 1].Location;
+    FVector2D Target = Poses[SectionEnd].Location;
+    float Remaining = (1.0f - ClosestAlpha) * FVector2D::Distance(SegmentStart, SegmentEnd);
+    bool bFoundTarget = Remaining >= LookaheadDistance;
+    if (bFoundTarget)
+    {
+        Target = FMath::Lerp(SegmentStart, SegmentEnd, ClosestAlpha) + (SegmentEnd - SegmentStart).GetSafeNormal() * LookaheadDistance;
+    }
+    for (int32 i = ClosestSegment + 1; i < SectionEnd; i++)
+    {
+        const float Length = FVector2D::Distance(Poses[i].Location, Poses[i + 1].Location);
+        if (!bFoundTarget && Remaining + Length >= LookaheadDistance)
+        {
+            Target = Poses[i].Location + (Poses[i + 1].Location - Poses[i].Location).GetSafeNormal() * (LookaheadDistance - Remaining);
+            bFoundTarget = true;
+        }
+        Remaining += Length;
+    }
+
+    const float Direction = Poses[SectionEnd].bReverse ? -1.0f : 1.0f;
+    const FQuat Rotation = Vehicle->GetActorQuat();
+    const FVector LocalEnd = Rotation.UnrotateVector(FVector(Poses[SectionEnd].Location - Location, 0.0f));
+
+    // Close enough, or already past the end of the last segment
+    if (Remaining < ArrivalTolerance || (ClosestSegment == SectionEnd - 1 && LocalEnd.X * Direction < 0.0f))
+    {
+        FinishSection(*Vehicle);
+        return;
+    }
+
+    const float Throttle = Direction * FMath::Clamp(Remaining / SlowDownDistance, 0.3f, 1.0f);
+
+    // Pure pursuit: the arc through the lookahead point has curvature 2y / L^2 in the frame of the
+    // direction of travel. Reversing flips the lateral axis, and yaw rate is independent of
+    // speed in AVehicleBase's model, so convert curvature to a yaw rate at the commanded speed.
+    const FVector LocalTarget = Rotation.UnrotateVector(FVector(Target - Location, 0.0f));
+    const float Curvature = 2.0f * Direction * LocalTarget.Y / FMath::Max(LocalTarget.SizeSquared2D(), 1.0f);
+    const float YawRate = FMath::RadiansToDegrees(Curvature * FMath::Abs(Throttle) * AVehicleBase::MaxForwardSpeed);
+    const float Steering = FMath::Clamp(YawRate / AVehicleBase::MaxYawRate, -1.0f, 1.0f);
+
+    Vehicle->SetDriverInput(Throttle, Steering, false);
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs PlanParkCommand(
+        TEXT("vehicle.Plan.Park"),
+        TEXT("Plans and drives the player's vehicle to a pose: vehicle.Plan.Park X Y Yaw"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+            AVehicleBase* Vehicle = PlayerController ? Cast<AVehicleBase>(PlayerController->GetPawn()) : nullptr;
+            if (!Vehicle || Args.Num() < 3)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("VehiclePathFollower: usage vehicle.Plan.Park X Y Yaw, with a vehicle possessed"));
+                return;
+            }
+
+            UVehiclePathFollowerComponent* Follower = Vehicle->FindComponentByClass<UVehiclePathFollowerComponent>();
+            if (!Follower)
+            {
+                Follower = NewObject<UVehiclePathFollowerComponent>(Vehicle);
+                Follower->RegisterComponent();
+            }
+
+            const FVector Goal(FCString::Atof(*Args[0]), FCString::Atof(*Args[1]), Vehicle->GetActorLocation().Z);
+            Follower->PlanTo(Goal, FCString::Atof(*Args[2]));
+        }));
+}
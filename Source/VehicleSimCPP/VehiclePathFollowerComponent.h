@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "VehicleHybridAStar.h"
+#include "VehiclePathFollowerComponent.generated.h"
+
+// Plans a parking or manoeuvring path for its AVehicleBase with the hybrid A* planner (off the
+// game thread) and then drives it with pure pursuit: each frame it steers towards a point
+// LookaheadDistance further along the path from the vehicle's actual pose, one direction of
+// travel at a time. Drifting more than ReplanDistance off the path (after a collision, say)
+// plans again from where the vehicle is.
+UCLASS(ClassGroup = (Vehicle), meta = (BlueprintSpawnableComponent))
+class VEHICLESIMCPP_API UVehiclePathFollowerComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UVehiclePathFollowerComponent();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    // Starts planning to the pose; any current plan or path is dropped
+    void PlanTo(const FVector& InGoalLocation, float InGoalYaw);
+
+    void Stop();
+
+    bool IsPlanning() const { return PlanTask.IsValid(); }
+    bool IsFollowing() const { return bFollowing; }
+    const FVehiclePlannedPath& GetPath() const { return Path; }
+
+    // Extra occupancy grid margin around the start and goal
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planning")
+    float GridMargin = 2000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Planning")
+    float GridCellSize = 25.0f;
+
+    // Distance along the path to the point the vehicle steers towards
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Following")
+    float LookaheadDistance = 250.0f;
+
+    // Cross-track error that triggers a new plan from the current pose
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Following")
+    float ReplanDistance = 150.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Following")
+    int32 MaxReplans = 3;
+
+    // The end of each stretch in one direction counts as reached within this distance
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Following")
+    float ArrivalTolerance = 30.0f;
+
+    // Throttle eases off over this distance before a direction change or the goal
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Following")
+    float SlowDownDistance = 300.0f;
+
+    FVehicleHybridAStarSettings Settings;
+
+private:
+    void StartPlan();
+    void FinishSection(AVehicleBase& Vehicle);
+
+    UE::Tasks::TTask<FVehiclePlannedPath> PlanTask;
+
+    FVector GoalLocation = FVector::ZeroVector;
+    float GoalYaw = 0.0f;
+    int32 NumReplans = 0;
+
+    FVehiclePlannedPath Path;
+    int32 PoseIndex = 0;        // start of the path segment the vehicle was last projected onto
+    int32 SectionEnd = 0;       // last pose before the direction of travel changes
+    bool bFollowing = false;
+};
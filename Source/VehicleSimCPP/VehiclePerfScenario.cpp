@@ -0,0 +1,125 @@
+#include "VehiclePerfScenario.h"
+#include "VehicleBase.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Parse.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DEFINE_CATEGORY(VehiclePerf, true);
+
+bool UVehiclePerfScenarioSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    FString Name;
+    const bool bRequested = FParse::Param(FCommandLine::Get(), TEXT("VehiclePerfScenario"))
+        || FParse::Value(FCommandLine::Get(), TEXT("VehiclePerfScenario="), Name);
+    return bRequested && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UVehiclePerfScenarioSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game;
+}
+
+void UVehiclePerfScenarioSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    FParse::Value(FCommandLine::Get(), TEXT("VehiclePerfScenario="), CaptureName);
+    if (GConfig)
+    {
+        GConfig->GetInt(TEXT("VehicleSim.PerfScenario"), TEXT("FleetSize"), FleetSize, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.PerfScenario"), TEXT("Duration"), Duration, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.PerfScenario"), TEXT("FleetSpacing"), FleetSpacing, GGameIni);
+    }
+}
+
+TStatId UVehiclePerfScenarioSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehiclePerfScenarioSubsystem, STATGROUP_Tickables);
+}
+
+void UVehiclePerfScenarioSubsystem::SpawnFleet(UWorld* World, int32 FleetSize, float FleetSpacing, TArray<TWeakObjectPtr<AVehicleBase>>& OutFleet)
+{
+    const int32 RowLength = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(FleetSize))));
+    for (int32 i = 0; i < FleetSize; i++)
+    {
+        const FTransform Transform(FVector((i / RowLength) * FleetSpacing, (i % RowLength - RowLength / 2) * FleetSpacing, 100.0f));
+        AVehicleBase* Vehicle = World->SpawnActorDeferred<AVehicleBase>(AVehicleBase::StaticClass(), Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+        if (!Vehicle)
+        {
+            continue;
+        }
+        Vehicle->bAutoPossessFirstPlayer = false;
+        Vehicle->FinishSpawning(Transform);
+        Vehicle->EnableBotDriver(EVehicleBotMode::Scripted, i);
+        OutFleet.Add(Vehicle);
+    }
+}
+
+void UVehiclePerfScenarioSubsystem::StartScenario()
+{
+    bStarted = true;
+
+    UWorld* World = GetWorld();
+    SpawnFleet(World, FleetSize, FleetSpacing, Fleet);
+
+#if CSV_PROFILER
+    FCsvProfiler::Get()->BeginCapture(-1, FString(), CaptureName + TEXT(".csv"));
+#endif
+
+    StartTime = World->GetTimeSeconds();
+    UE_LOG(LogTemp, Log, TEXT("VehiclePerfScenario: Driving %d vehicles for %.0f seconds, capturing %s.csv"), Fleet.Num(), Duration, *CaptureName);
+}
+
+void UVehiclePerfScenarioSubsystem::FinishScenario()
+{
+    bFinished = true;
+
+#if CSV_PROFILER
+    // The capture is written on a worker; quit once it is on disk
+    FCsvProfiler::Get()->OnCSVProfileFinished().AddLambda([](const FString& Filename)
+    {
+        UE_LOG(LogTemp, Log, TEXT("VehiclePerfScenario: Capture written to %s"), *Filename);
+        FPlatformMisc::RequestExit(false);
+    });
+    FCsvProfiler::Get()->EndCapture();
+#else
+    UE_LOG(LogTemp, Error, TEXT("VehiclePerfScenario: This build has no CSV profiler"));
+    FPlatformMisc::RequestExit(false);
+#endif
+}
+
+void UVehiclePerfScenarioSubsystem::Tick(float DeltaTime)
+{
+    if (bFinished || !GetWorld()->HasBegunPlay())
+    {
+        return;
+    }
+    if (!bStarted)
+    {
+        StartScenario();
+        return;
+    }
+
+    int32 NumVehicles = 0;
+    int32 NumMoving = 0;
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        NumVehicles++;
+        NumMoving += FMath::Abs(It->GetThrottleInput()) > AVehicleBase::InputDeadZone ? 1 : 0;
+    }
+
+    const FPlatformMemoryStats Memory = FPlatformMemory::GetStats();
+    CSV_CUSTOM_STAT(VehiclePerf, Vehicles, NumVehicles, ECsvCustomStatOp::Set);
+    CSV_CUSTOM_STAT(VehiclePerf, MovingVehicles, NumMoving, ECsvCustomStatOp::Set);
+    CSV_CUSTOM_STAT(VehiclePerf, PhysicalUsedMB, static_cast<float>(Memory.UsedPhysical / (1024.0 * 1024.0)), ECsvCustomStatOp::Set);
+    CSV_CUSTOM_STAT(VehiclePerf, PeakPhysicalUsedMB, static_cast<float>(Memory.PeakUsedPhysical / (1024.0 * 1024.0)), ECsvCustomStatOp::Set);
+
+    if (GetWorld()->GetTimeSeconds() - StartTime >= Duration)
+    {
+        FinishScenario();
+    }
+}
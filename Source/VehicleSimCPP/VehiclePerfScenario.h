@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehiclePerfScenario.generated.h"
+
+class AVehicleBase;
+
+// Canned performance run, enabled with -VehiclePerfScenario[=CaptureName]: once the map has
+// begun play it spawns a fixed fleet of scripted bot vehicles, records a CSV profile
+// (Saved/Profiling/CSV/<CaptureName>.csv) while they drive, then quits. Fleet size and
+// duration come from [VehicleSim.PerfScenario]. Scripts/RunPerfGate.sh runs it and checks the
+// capture against a baseline with VehicleTelemetryTool -PerfGate.
+UCLASS()
+class VEHICLESIMCPP_API UVehiclePerfScenarioSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Spawns the scenario's fleet: rows of scripted bots facing +X, seeded by index, so every
+    // run spawns and drives the same vehicles
+    static void SpawnFleet(UWorld* World, int32 FleetSize, float FleetSpacing, TArray<TWeakObjectPtr<AVehicleBase>>& OutFleet);
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    void StartScenario();
+    void FinishScenario();
+
+    FString CaptureName = TEXT("VehiclePerf");
+    int32 FleetSize = 100;
+    float Duration = 60.0f;
+    float FleetSpacing = 800.0f;
+
+    TArray<TWeakObjectPtr<AVehicleBase>> Fleet;
+    double StartTime = 0.0;
+    bool bStarted = false;
+    bool bFinished = false;
+};
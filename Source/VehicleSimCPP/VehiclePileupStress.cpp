@@ -0,0 +1,361 @@
+#include "VehiclePileupStress.h"
+#include "VehicleBase.h"
+#include "VehicleStats.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "ProceduralMeshComponent.h"
+
+namespace
+{
+    const TCHAR* const LayoutNames[] = { TEXT("StartLine"), TEXT("Pileup") };
+
+    int32 FindRoot(TArray<int32>& Parents, int32 Index)
+    {
+        while (Parents[Index] != Index)
+        {
+            Parents[Index] = Parents[Parents[Index]];
+            Index = Parents[Index];
+        }
+        return Index;
+    }
+
+    double GetUsedPhysicalMB()
+    {
+        return FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+    }
+}
+
+bool UVehiclePileupStressSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    return FParse::Param(FCommandLine::Get(), TEXT("VehiclePileup")) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UVehiclePileupStressSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game;
+}
+
+void UVehiclePileupStressSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    FString Counts = TEXT("10,25,50,100,200");
+    FString ClassPath;
+    if (GConfig)
+    {
+        GConfig->GetString(TEXT("VehicleSim.Pileup"), TEXT("VehicleCounts"), Counts, GGameIni);
+        GConfig->GetString(TEXT("VehicleSim.Pileup"), TEXT("VehicleClass"), ClassPath, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Pileup"), TEXT("TrialDuration"), TrialDuration, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Pileup"), TEXT("ImpactSpeed"), ImpactSpeed, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Pileup"), TEXT("Gap"), Gap, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Pileup"), TEXT("ContactMargin"), ContactMargin, GGameIni);
+        GConfig->GetVector(TEXT("VehicleSim.Pileup"), TEXT("BodyExtent"), BodyExtent, GGameIni);
+    }
+    FParse::Value(FCommandLine::Get(), TEXT("VehiclePileupCounts="), Counts);
+
+    TArray<FString> CountStrings;
+    Counts.ParseIntoArray(CountStrings, TEXT(","));
+    for (const FString& Count : CountStrings)
+    {
+        if (FCString::Atoi(*Count) > 0)
+        {
+            VehicleCounts.Add(FCString::Atoi(*Count));
+        }
+    }
+
+    VehicleClass = ClassPath.IsEmpty() ? nullptr : LoadClass<AVehicleBase>(nullptr, *ClassPath);
+    if (!VehicleClass)
+    {
+        VehicleClass = AVehicleBase::StaticClass();
+    }
+
+    Tag = FApp::GetBuildVersion();
+    FParse::Value(FCommandLine::Get(), TEXT("VehiclePileupTag="), Tag);
+}
+
+void UVehiclePileupStressSubsystem::Deinitialize()
+{
+    if (FPhysScene_Chaos* Scene = GetWorld()->GetPhysicsScene())
+    {
+        Scene->GetSolver()->RemovePreAdvanceCallback(PreAdvanceHandle);
+        Scene->GetSolver()->RemovePostAdvanceCallback(PostAdvanceHandle);
+    }
+
+    Super::Deinitialize();
+}
+
+TStatId UVehiclePileupStressSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehiclePileupStressSubsystem, STATGROUP_Tickables);
+}
+
+void UVehiclePileupStressSubsystem::OnSolverPreAdvance(Chaos::FReal DeltaSeconds)
+{
+    SolverAdvanceStartCycles = FPlatformTime::Cycles64();
+}
+
+void UVehiclePileupStressSubsystem::OnSolverPostAdvance(Chaos::FReal DeltaSeconds)
+{
+    FrameSolverCycles += FPlatformTime::Cycles64() - SolverAdvanceStartCycles;
+}
+
+void UVehiclePileupStressSubsystem::SpawnVehicle(const FVector& Location, const FRotator& Rotation, const FVector& Velocity)
+{
+    const FTransform Transform(Rotation, Location);
+    AVehicleBase* Vehicle = GetWorld()->SpawnActorDeferred<AVehicleBase>(VehicleClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+    if (!Vehicle)
+    {
+        return;
+    }
+    Vehicle->bAutoPossessFirstPlayer = false;
+    Vehicle->FinishSpawning(Transform);
+
+    // Only the solver moves the bodies; the kinematic move would fight it
+    Vehicle->SetActorTickEnabled(false);
+
+    // Vehicle Blueprints with a physics asset simulate their root. Plain AVehicleBase has none,
+    // so its body mesh gets a convex box of the same size instead.
+    UPrimitiveComponent* Body = nullptr;
+    USkeletalMeshComponent* Mesh = Vehicle->GetMesh();
+    if (Mesh && Mesh->GetPhysicsAsset())
+    {
+        Body = Mesh;
+    }
+    else if (UProceduralMeshComponent* BoxMesh = Vehicle->FindComponentByClass<UProceduralMeshComponent>())
+    {
+        const FVector Min(-BodyExtent.X, -BodyExtent.Y, 0.0f);
+        const FVector Max(BodyExtent.X, BodyExtent.Y, 2.0f * BodyExtent.Z);
+        BoxMesh->bUseComplexAsSimpleCollision = false;
+        BoxMesh->SetCollisionConvexMeshes({ {
+            FVector(Min.X, Min.Y, Min.Z), FVector(Max.X, Min.Y, Min.Z), FVector(Min.X, Max.Y, Min.Z), FVector(Max.X, Max.Y, Min.Z),
+            FVector(Min.X, Min.Y, Max.Z), FVector(Max.X, Min.Y, Max.Z), FVector(Min.X, Max.Y, Max.Z), FVector(Max.X, Max.Y, Max.Z) } });
+        BoxMesh->SetCollisionObjectType(ECC_PhysicsBody);
+        BoxMesh->SetCollisionResponseToAllChannels(ECR_Block);
+        Body = BoxMesh;
+    }
+    if (!Body)
+    {
+        Vehicle->Destroy();
+        return;
+    }
+
+    Body->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+    Body->SetSimulatePhysics(true);
+    Body->SetPhysicsLinearVelocity(Velocity);
+    Vehicles.Add(Vehicle);
+    Bodies.Add(Body);
+}
+
+void UVehiclePileupStressSubsystem::StartTrial()
+{
+    bTrialRunning = true;
+    SolverMs.Reset();
+    ContactPairs.Reset();
+    FrameSolverCycles = 0;
+    MaxIslands = 0;
+    LargestIsland = 0;
+    MemoryStartMB = GetUsedPhysicalMB();
+    MemoryPeakMB = MemoryStartMB;
+
+    const int32 NumVehicles = GetVehicleCount();
+    const FVector Footprint(2.0f * BodyExtent.X + Gap, 2.0f * BodyExtent.Y + Gap, 0.0f);
+    FRandomStream Random(NumVehicles);
+
+    if (GetLayout() == ELayout::StartLine)
+    {
+        // Rows bumper to bumper along -X; everything behind the stopped front row drives into it
+        const int32 Columns = FMath::Clamp(FMath::CeilToInt(FMath::Sqrt(NumVehicles * 0.5f)), 1, 12);
+        for (int32 i = 0; i < NumVehicles; i++)
+        {
+            const int32 Row = i / Columns;
+            const FVector Location(-Row * Footprint.X, (i % Columns - (Columns - 1) * 0.5f) * Footprint.Y, Gap);
+            SpawnVehicle(Location, FRotator::ZeroRotator, Row == 0 ? FVector::ZeroVector : FVector(ImpactSpeed, 0.0f, 0.0f));
+        }
+    }
+    else
+    {
+        // Rings of vehicles facing the centre, each ring as full as its circumference allows
+        float Radius = 2.0f * Footprint.X;
+        int32 Slot = 0;
+        int32 SlotsInRing = FMath::Max(4, FMath::FloorToInt(UE_TWO_PI * Radius / Footprint.Y));
+        for (int32 i = 0; i < NumVehicles; i++, Slot++)
+        {
+            if (Slot == SlotsInRing)
+            {
+                Radius += Footprint.X;
+                Slot = 0;
+                SlotsInRing = FMath::Max(4, FMath::FloorToInt(UE_TWO_PI * Radius / Footprint.Y));
+            }
+            const float Angle = 360.0f * Slot / SlotsInRing;
+            const FVector Outward = FRotator(0.0f, Angle, 0.0f).Vector();
+            const FRotator Rotation(0.0f, Angle + 180.0f + Random.FRandRange(-10.0f, 10.0f), 0.0f);
+            SpawnVehicle(Outward * Radius + FVector(0.0f, 0.0f, Gap), Rotation, -Outward * ImpactSpeed);
+        }
+    }
+
+    TrialStartTime = GetWorld()->GetTimeSeconds();
+    UE_LOG(LogTemp, Log, TEXT("VehiclePileup: %s with %d vehicles"), LayoutNames[static_cast<int32>(GetLayout())], Bodies.Num());
+}
+
+void UVehiclePileupStressSubsystem::SampleContacts()
+{
+    TArray<UPrimitiveComponent*> Live;
+    TMap<const UPrimitiveComponent*, int32> IndexOf;
+    for (const TWeakObjectPtr<UPrimitiveComponent>& Body : Bodies)
+    {
+        if (Body.IsValid())
+        {
+            IndexOf.Add(Body.Get(), Live.Add(Body.Get()));
+        }
+    }
+
+    // A pair is in contact when one body's bounds, grown by the margin, overlap the other body
+    TArray<int32> Parents;
+    for (int32 i = 0; i < Live.Num(); i++)
+    {
+        Parents.Add(i);
+    }
+    TSet<uint64> Pairs;
+    TArray<FOverlapResult> Overlaps;
+    for (int32 i = 0; i < Live.Num(); i++)
+    {
+        const FTransform& Transform = Live[i]->GetComponentTransform();
+        const FBoxSphereBounds LocalBounds = Live[i]->CalcBounds(FTransform::Identity);
+        const FCollisionShape Shape = FCollisionShape::MakeBox(LocalBounds.BoxExtent + FVector(ContactMargin));
+        const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(VehiclePileup), false, Live[i]->GetOwner());
+
+        Overlaps.Reset();
+        GetWorld()->OverlapMultiByObjectType(Overlaps, Transform.TransformPosition(LocalBounds.Origin), Transform.GetRotation(),
+            FCollisionObjectQueryParams(Live[i]->GetCollisionObjectType()), Shape, QueryParams);
+        for (const FOverlapResult& Overlap : Overlaps)
+        {
+            const int32* Other = IndexOf.Find(Overlap.GetComponent());
+            if (Other && *Other != i)
+            {
+                Pairs.Add(uint64(FMath::Min(i, *Other)) << 32 | uint64(FMath::Max(i, *Other)));
+                Parents[FindRoot(Parents, i)] = FindRoot(Parents, *Other);
+            }
+        }
+    }
+
+    // Islands are groups of at least two touching bodies
+    TMap<int32, int32> IslandSizes;
+    for (const uint64 Pair : Pairs)
+    {
+        IslandSizes.FindOrAdd(FindRoot(Parents, int32(Pair >> 32)));
+    }
+    for (int32 i = 0; i < Live.Num(); i++)
+    {
+        if (int32* Size = IslandSizes.Find(FindRoot(Parents, i)))
+        {
+            (*Size)++;
+        }
+    }
+
+    ContactPairs.Add(Pairs.Num());
+    MaxIslands = FMath::Max(MaxIslands, IslandSizes.Num());
+    for (const TPair<int32, int32>& Island : IslandSizes)
+    {
+        LargestIsland = FMath::Max(LargestIsland, Island.Value);
+    }
+}
+
+void UVehiclePileupStressSubsystem::FinishTrial()
+{
+    bTrialRunning = false;
+
+    const FVehicleTimingSummary Solver = FVehicleTimingSummary::FromSamples(SolverMs);
+    const FVehicleTimingSummary Contacts = FVehicleTimingSummary::FromSamples(ContactPairs);
+    const TCHAR* Layout = LayoutNames[static_cast<int32>(GetLayout())];
+
+    const FString Filename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("VehiclePileup.csv"));
+    FString Row;
+    if (!IFileManager::Get().FileExists(*Filename))
+    {
+        Row = TEXT("Tag,Configuration,Layout,Vehicles,Frames,SolverMeanMs,SolverP95Ms,SolverMaxMs,ContactPairsMean,ContactPairsMax,MaxIslands,LargestIsland,MemoryPeakMB,MemoryGrowthMB\n");
+    }
+    Row += FString::Printf(TEXT("%s,%s,%s,%d,%d,%.4f,%.4f,%.4f,%.1f,%.0f,%d,%d,%.1f,%.1f\n"),
+        *Tag, LexToString(FApp::GetBuildConfiguration()), Layout, Bodies.Num(), Solver.Count,
+        Solver.Mean, Solver.P95, Solver.Max, Contacts.Mean, Contacts.Max, MaxIslands, LargestIsland, MemoryPeakMB, MemoryPeakMB - MemoryStartMB);
+    if (!FFileHelper::SaveStringToFile(Row, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehiclePileup: Could not write %s"), *Filename);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("VehiclePileup: %s %d vehicles: solver %s ms, contact pairs mean %.1f max %.0f, largest island %d, memory +%.1f MB"),
+        Layout, Bodies.Num(), *Solver.ToString(), Contacts.Mean, Contacts.Max, LargestIsland, MemoryPeakMB - MemoryStartMB);
+
+    for (const TWeakObjectPtr<AVehicleBase>& Vehicle : Vehicles)
+    {
+        if (Vehicle.IsValid())
+        {
+            Vehicle->Destroy();
+        }
+    }
+    Vehicles.Reset();
+    Bodies.Reset();
+
+    if (++TrialIndex >= VehicleCounts.Num() * NumLayouts)
+    {
+        bFinished = true;
+        UE_LOG(LogTemp, Log, TEXT("VehiclePileup: Results in %s"), *Filename);
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+void UVehiclePileupStressSubsystem::Tick(float DeltaTime)
+{
+    if (bFinished || !GetWorld()->HasBegunPlay())
+    {
+        return;
+    }
+
+    if (!PreAdvanceHandle.IsValid())
+    {
+        FPhysScene_Chaos* Scene = GetWorld()->GetPhysicsScene();
+        if (!Scene || VehicleCounts.Num() == 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VehiclePileup: Needs a physics scene and at least one vehicle count"));
+            bFinished = true;
+            FPlatformMisc::RequestExit(false);
+            return;
+        }
+
+        // Bracket the solver's own advance rather than the scene tick, which also covers game
+        // thread work and, with async physics, only waits on the physics thread
+        PreAdvanceHandle = Scene->GetSolver()->AddPreAdvanceCallback(
+            FSolverPreAdvance::FDelegate::CreateUObject(this, &UVehiclePileupStressSubsystem::OnSolverPreAdvance));
+        PostAdvanceHandle = Scene->GetSolver()->AddPostAdvanceCallback(
+            FSolverPostAdvance::FDelegate::CreateUObject(this, &UVehiclePileupStressSubsystem::OnSolverPostAdvance));
+    }
+
+    // Trials start on their own frame, so the first sample is the first step with the new bodies
+    if (!bTrialRunning)
+    {
+        StartTrial();
+        FrameSolverCycles = 0;
+        return;
+    }
+
+    SolverMs.Add(FPlatformTime::ToMilliseconds64(FrameSolverCycles.exchange(0)));
+    SampleContacts();
+    MemoryPeakMB = FMath::Max(MemoryPeakMB, GetUsedPhysicalMB());
+
+    if (GetWorld()->GetTimeSeconds() - TrialStartTime >= TrialDuration)
+    {
+        FinishTrial();
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/Real.h"
+#include "Subsystems/WorldSubsystem.h"
+#include <atomic>
+#include "VehiclePileupStress.generated.h"
+
+class AVehicleBase;
+class UPrimitiveComponent;
+
+// Contact-heavy physics stress suite, enabled with -VehiclePileup. For every layout and vehicle
+// count in [VehicleSim.Pileup] it spawns a dense cluster of simulated vehicle bodies, lets it
+// collide for TrialDuration seconds and records:
+//
+//   solver time    time spent in the solver's advance (summed over substeps), per frame
+//   contact pairs  bodies within ContactMargin of each other
+//   islands        connected components of the graph of those pairs (a proxy for, not a
+//                  readout of, the islands the solver builds)
+//   memory         peak physical memory during the trial and its growth over the start
+//
+// Layouts are StartLine (rows packed bumper to bumper, driving into a stopped front row) and
+// Pileup (rings of vehicles converging on one point). One row per trial is appended to
+// Saved/Benchmarks/VehiclePileup.csv, tagged with -VehiclePileupTag=<Name> (default the build
+// version) so runs from different builds can be plotted together. -VehiclePileupCounts=10,50
+// overrides the vehicle counts. The game quits when every trial has run.
+UCLASS()
+class VEHICLESIMCPP_API UVehiclePileupStressSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    enum class ELayout : uint8
+    {
+        StartLine,
+        Pileup
+    };
+
+    static constexpr int32 NumLayouts = 2;
+
+    void StartTrial();
+    void FinishTrial();
+    void SpawnVehicle(const FVector& Location, const FRotator& Rotation, const FVector& Velocity);
+    void SampleContacts();
+
+    ELayout GetLayout() const { return static_cast<ELayout>(TrialIndex / VehicleCounts.Num()); }
+    int32 GetVehicleCount() const { return VehicleCounts[TrialIndex % VehicleCounts.Num()]; }
+
+    // Called by the solver around each advance, on the physics thread when it runs async
+    void OnSolverPreAdvance(Chaos::FReal DeltaSeconds);
+    void OnSolverPostAdvance(Chaos::FReal DeltaSeconds);
+
+    TArray<int32> VehicleCounts;
+    TSubclassOf<AVehicleBase> VehicleClass;
+    FString Tag;
+    float TrialDuration = 4.0f;
+    float ImpactSpeed = 1500.0f;
+    float Gap = 10.0f;
+    float ContactMargin = 2.0f;
+    FVector BodyExtent = FVector(120.0f, 50.0f, 52.5f);
+
+    int32 TrialIndex = 0;
+    double TrialStartTime = 0.0;
+    bool bTrialRunning = false;
+    bool bFinished = false;
+
+    TArray<TWeakObjectPtr<AVehicleBase>> Vehicles;
+    TArray<TWeakObjectPtr<UPrimitiveComponent>> Bodies;
+
+    // Per-frame samples of the running trial
+    TArray<double> SolverMs;
+    TArray<double> ContactPairs;
+    uint64 SolverAdvanceStartCycles = 0;            // only touched by the solver's thread
+    std::atomic<uint64> FrameSolverCycles{ 0 };
+    int32 MaxIslands = 0;
+    int32 LargestIsland = 0;
+    double MemoryStartMB = 0.0;
+    double MemoryPeakMB = 0.0;
+
+    FDelegateHandle PreAdvanceHandle;
+    FDelegateHandle PostAdvanceHandle;
+};
@@ -0,0 +1,256 @@
+#include "VehicleProximitySubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace
+{
+    // Spreads the low 20 bits of Value so there is a zero bit between each
+    uint64 SpreadBits20(uint64 Value)
+    {
+        Value &= 0xFFFFF;
+        Value = (Value | (Value << 16)) & 0x0000FFFF0000FFFFull;
+        Value = (Value | (Value << 8)) & 0x00FF00FF00FF00FFull;
+        Value = (Value | (Value << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        Value = (Value | (Value << 2)) & 0x3333333333333333ull;
+        Value = (Value | (Value << 1)) & 0x5555555555555555ull;
+        return Value;
+    }
+
+    // Smallest batch worth handing to a worker thread
+    constexpr int32 MinItemsPerParallelTask = 1024;
+}
+
+uint64 FVehicleProximityGrid::GetCellCode(int32 CellX, int32 CellY)
+{
+    const uint64 X = static_cast<uint64>(FMath::Clamp(CellX + CellCoordBias, 0, 2 * CellCoordBias - 1));
+    const uint64 Y = static_cast<uint64>(FMath::Clamp(CellY + CellCoordBias, 0, 2 * CellCoordBias - 1));
+    return SpreadBits20(X) | (SpreadBits20(Y) << 1);
+}
+
+void FVehicleProximityGrid::GetCellCoord(const FVector& Location, int32& OutX, int32& OutY) const
+{
+    OutX = FMath::FloorToInt32(Location.X / CellSize);
+    OutY = FMath::FloorToInt32(Location.Y / CellSize);
+}
+
+void FVehicleProximityGrid::GetCellRange(int32 CellX, int32 CellY, int32& OutBegin, int32& OutEnd) const
+{
+    const uint64 Code = GetCellCode(CellX, CellY);
+    OutBegin = Algo::LowerBound(Keys, Code << IndexBits);
+    OutEnd = Algo::LowerBound(Keys, (Code + 1) << IndexBits);
+}
+
+void FVehicleProximityGrid::Build(TArray<FVector3f>&& InLocations, TArray<const AActor*>&& InActors, TArray<int32>&& InIndices, float InCellSize)
+{
+    CellSize = InCellSize;
+    const int32 NumItems = FMath::Min(InLocations.Num(), 1 << IndexBits);
+
+    Keys.SetNumUninitialized(NumItems);
+    ParallelFor(TEXT("VehicleProximity.Codes"), NumItems, MinItemsPerParallelTask, [this, &InLocations](int32 i)
+    {
+        int32 CellX, CellY;
+        GetCellCoord(FVector(InLocations[i]), CellX, CellY);
+        Keys[i] = (GetCellCode(CellX, CellY) << IndexBits) | static_cast<uint64>(i);
+    });
+
+    Algo::Sort(Keys);
+
+    // Reorder everything into key order so each cell's vehicles are contiguous
+    Locations.SetNumUninitialized(NumItems);
+    Actors.SetNumUninitialized(NumItems);
+    Indices.SetNumUninitialized(NumItems);
+    ParallelFor(TEXT("VehicleProximity.Scatter"), NumItems, MinItemsPerParallelTask, [&](int32 i)
+    {
+        const int32 Source = static_cast<int32>(Keys[i] & ((1ull << IndexBits) - 1));
+        Locations[i] = InLocations[Source];
+        Actors[i] = InActors[Source];
+        Indices[i] = InIndices[Source];
+    });
+}
+
+void FVehicleProximityGrid::FindInRadius(const FVector& Center, float Radius, TArray<FVehicleProximityHit>& OutHits, const AActor* Ignore) const
+{
+    ForEachInRadius(Center, Radius, [&OutHits, Ignore](const FVehicleProximityHit& Hit)
+    {
+        if (Hit.Actor != Ignore || Hit.Index != INDEX_NONE)
+        {
+            OutHits.Add(Hit);
+        }
+    });
+}
+
+int32 FVehicleProximityGrid::FindNearest(const FVector& Center, float MaxRadius, TArrayView<FVehicleProximityHit> OutHits, const AActor* Ignore) const
+{
+    const int32 MaxHits = OutHits.Num();
+    if (MaxHits == 0 || Keys.Num() == 0)
+    {
+        return 0;
+    }
+
+    const FVector3f Query(Center);
+    const float MaxRadiusSquared = MaxRadius * MaxRadius;
+    int32 NumHits = 0;
+
+    auto Consider = [&](int32 i)
+    {
+        if (Actors[i] == Ignore && Indices[i] == INDEX_NONE)
+        {
+            return;
+        }
+        const float DistanceSquared = FVector3f::DistSquared(Query, Locations[i]);
+        if (DistanceSquared > MaxRadiusSquared || (NumHits == MaxHits && DistanceSquared >= OutHits[MaxHits - 1].DistanceSquared))
+        {
+            return;
+        }
+
+        // Insertion into the short sorted result list
+        int32 Slot = NumHits < MaxHits ? NumHits++ : MaxHits - 1;
+        while (Slot > 0 && OutHits[Slot - 1].DistanceSquared > DistanceSquared)
+        {
+            OutHits[Slot] = OutHits[Slot - 1];
+            Slot--;
+        }
+        OutHits[Slot] = FVehicleProximityHit{ Actors[i], Indices[i], Locations[i], DistanceSquared };
+    };
+
+    // Rings of cells outwards; anything beyond ring R is at least R * CellSize away
+    int32 CenterX, CenterY;
+    GetCellCoord(Center, CenterX, CenterY);
+    const int32 MaxRing = FMath::CeilToInt32(MaxRadius / CellSize);
+    for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+    {
+        if (Ring > 0 && NumHits == MaxHits && OutHits[MaxHits - 1].DistanceSquared <= FMath::Square((Ring - 1) * CellSize))
+        {
+            break;
+        }
+
+        for (int32 Y = CenterY - Ring; Y <= CenterY + Ring; Y++)
+        {
+            const bool bFullRow = FMath::Abs(Y - CenterY) == Ring;
+            const int32 Step = bFullRow ? 1 : FMath::Max(2 * Ring, 1);
+            for (int32 X = CenterX - Ring; X <= CenterX + Ring; X += Step)
+            {
+                int32 Begin, End;
+                GetCellRange(X, Y, Begin, End);
+                for (int32 i = Begin; i < End; i++)
+                {
+                    Consider(i);
+                }
+            }
+        }
+    }
+
+    return NumHits;
+}
+
+bool UVehicleProximitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleProximitySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (GConfig)
+    {
+        GConfig->GetFloat(TEXT("VehicleSim.Proximity"), TEXT("CellSize"), CellSize, GGameIni);
+    }
+    CellSize = FMath::Max(CellSize, 100.0f);
+}
+
+TStatId UVehicleProximitySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleProximitySubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleProximitySubsystem::RegisterVehicle(const AActor* Vehicle)
+{
+    if (Vehicle)
+    {
+        Vehicles.AddUnique(Vehicle);
+    }
+}
+
+void UVehicleProximitySubsystem::UnregisterVehicle(const AActor* Vehicle)
+{
+    Vehicles.RemoveSwap(Vehicle);
+}
+
+void UVehicleProximitySubsystem::AddSource(const AActor* Owner, FVehicleProximityGather&& Gather)
+{
+    RemoveSource(Owner);
+    Sources.Emplace(Owner, MoveTemp(Gather));
+}
+
+void UVehicleProximitySubsystem::RemoveSource(const AActor* Owner)
+{
+    Sources.RemoveAllSwap([Owner](const TPair<TWeakObjectPtr<const AActor>, FVehicleProximityGather>& Source) { return Source.Key == Owner; });
+}
+
+void UVehicleProximitySubsystem::Tick(float DeltaTime)
+{
+    Rebuild();
+}
+
+void UVehicleProximitySubsystem::Rebuild()
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    TArray<FVector3f> Locations;
+    TArray<const AActor*> Actors;
+    TArray<int32> Indices;
+    const int32 Reserve = Grid->Num() + 64;
+    Locations.Reserve(Reserve);
+    Actors.Reserve(Reserve);
+    Indices.Reserve(Reserve);
+
+    Vehicles.RemoveAllSwap([](const TWeakObjectPtr<const AActor>& Vehicle) { return !Vehicle.IsValid(); });
+    for (const TWeakObjectPtr<const AActor>& Vehicle : Vehicles)
+    {
+        Locations.Add(FVector3f(Vehicle->GetActorLocation()));
+        Actors.Add(Vehicle.Get());
+        Indices.Add(INDEX_NONE);
+    }
+
+    Sources.RemoveAllSwap([](const TPair<TWeakObjectPtr<const AActor>, FVehicleProximityGather>& Source) { return !Source.Key.IsValid(); });
+    for (const TPair<TWeakObjectPtr<const AActor>, FVehicleProximityGather>& Source : Sources)
+    {
+        const AActor* Owner = Source.Key.Get();
+        Source.Value([&](const FVector& Location, int32 Index)
+        {
+            Locations.Add(FVector3f(Location));
+            Actors.Add(Owner);
+            Indices.Add(Index);
+        });
+    }
+
+    // Readers may still hold the previous snapshot, so always build a fresh one
+    TSharedRef<FVehicleProximityGrid, ESPMode::ThreadSafe> NewGrid = MakeShared<FVehicleProximityGrid, ESPMode::ThreadSafe>();
+    NewGrid->Build(MoveTemp(Locations), MoveTemp(Actors), MoveTemp(Indices), CellSize);
+    Grid = NewGrid;
+
+    LastBuildMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs ProximityStatsCommand(
+        TEXT("vehicle.Proximity.Stats"),
+        TEXT("Logs the size and build time of the vehicle proximity grid"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (const UVehicleProximitySubsystem* Proximity = World ? World->GetSubsystem<UVehicleProximitySubsystem>() : nullptr)
+            {
+                const TSharedRef<const FVehicleProximityGrid, ESPMode::ThreadSafe> Grid = Proximity->GetGrid();
+                UE_LOG(LogTemp, Log, TEXT("VehicleProximity: %d vehicles, %.0f cell size, last build %.3f ms"),
+                    Grid->Num(), Grid->GetCellSize(), Proximity->GetLastBuildMilliseconds());
+            }
+        }));
+}
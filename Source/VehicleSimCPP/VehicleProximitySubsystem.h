@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleProximitySubsystem.generated.h"
+
+// One vehicle found by a proximity query
+struct FVehicleProximityHit
+{
+    const AActor* Actor = nullptr;  // the vehicle, or the source that added it (e.g. the traffic manager)
+    int32 Index = INDEX_NONE;       // source-defined index, INDEX_NONE for registered actors
+    FVector3f Location = FVector3f::ZeroVector;
+    float DistanceSquared = 0.0f;
+};
+
+// Immutable snapshot of all vehicle positions, sorted by the Morton code of their grid cell so
+// nearby vehicles sit next to each other in memory. Each cell is found with a binary search.
+//
+// Queries only read the snapshot and never allocate (apart from growing the caller's array),
+// so any number of threads can query one snapshot without locks.
+class VEHICLESIMCPP_API FVehicleProximityGrid
+{
+public:
+    // Calls Visitor(const FVehicleProximityHit&) for every vehicle within Radius of Center
+    template<typename VisitorType>
+    void ForEachInRadius(const FVector& Center, float Radius, VisitorType&& Visitor) const;
+
+    // Appends every vehicle within Radius, skipping Ignore
+    void FindInRadius(const FVector& Center, float Radius, TArray<FVehicleProximityHit>& OutHits, const AActor* Ignore = nullptr) const;
+
+    // Up to OutHits.Num() nearest vehicles within MaxRadius, closest first. Returns how many were found.
+    int32 FindNearest(const FVector& Center, float MaxRadius, TArrayView<FVehicleProximityHit> OutHits, const AActor* Ignore = nullptr) const;
+
+    int32 Num() const { return Keys.Num(); }
+    float GetCellSize() const { return CellSize; }
+
+private:
+    friend class UVehicleProximitySubsystem;
+
+    // Sort key: 40 bit cell Morton code above a 24 bit item index
+    static constexpr int32 IndexBits = 24;
+    static constexpr int32 CellCoordBias = 1 << 19;
+
+    static uint64 GetCellCode(int32 CellX, int32 CellY);
+    void GetCellCoord(const FVector& Location, int32& OutX, int32& OutY) const;
+    void GetCellRange(int32 CellX, int32 CellY, int32& OutBegin, int32& OutEnd) const;
+
+    void Build(TArray<FVector3f>&& InLocations, TArray<const AActor*>&& InActors, TArray<int32>&& InIndices, float InCellSize);
+
+    float CellSize = 2000.0f;
+    TArray<uint64> Keys;
+    TArray<FVector3f> Locations;
+    TArray<const AActor*> Actors;
+    TArray<int32> Indices;
+};
+
+template<typename VisitorType>
+void FVehicleProximityGrid::ForEachInRadius(const FVector& Center, float Radius, VisitorType&& Visitor) const
+{
+    int32 MinX, MinY, MaxX, MaxY;
+    GetCellCoord(Center - FVector(Radius), MinX, MinY);
+    GetCellCoord(Center + FVector(Radius), MaxX, MaxY);
+
+    const FVector3f Query(Center);
+    const float RadiusSquared = Radius * Radius;
+    for (int32 Y = MinY; Y <= MaxY; Y++)
+    {
+        for (int32 X = MinX; X <= MaxX; X++)
+        {
+            int32 Begin, End;
+            GetCellRange(X, Y, Begin, End);
+            for (int32 i = Begin; i < End; i++)
+            {
+                const float DistanceSquared = FVector3f::DistSquared(Query, Locations[i]);
+                if (DistanceSquared <= RadiusSquared)
+                {
+                    Visitor(FVehicleProximityHit{ Actors[i], Indices[i], Locations[i], DistanceSquared });
+                }
+            }
+        }
+    }
+}
+
+using FVehicleProximityAddItem = TFunctionRef<void(const FVector& Location, int32 Index)>;
+using FVehicleProximityGather = TFunction<void(FVehicleProximityAddItem AddItem)>;
+
+// Rebuilds the proximity grid of every vehicle once per frame, for AI avoidance, drafting,
+// sensors and relevancy. Get the snapshot on the game thread and hand the shared pointer to
+// workers; it stays valid and unchanged for as long as they hold it.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleProximitySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Actors whose location is sampled every rebuild (AVehicleBase registers itself)
+    void RegisterVehicle(const AActor* Vehicle);
+    void UnregisterVehicle(const AActor* Vehicle);
+
+    // Positions that are not actors, such as instanced traffic. Gather runs on the game thread
+    // during the rebuild; the Index it passes comes back in the hits.
+    void AddSource(const AActor* Owner, FVehicleProximityGather&& Gather);
+    void RemoveSource(const AActor* Owner);
+
+    TSharedRef<const FVehicleProximityGrid, ESPMode::ThreadSafe> GetGrid() const { return Grid; }
+
+    // Rebuild now instead of waiting for the next tick
+    void Rebuild();
+
+    double GetLastBuildMilliseconds() const { return LastBuildMilliseconds; }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    TArray<TWeakObjectPtr<const AActor>> Vehicles;
+    TArray<TPair<TWeakObjectPtr<const AActor>, FVehicleProximityGather>> Sources;
+
+    TSharedRef<const FVehicleProximityGrid, ESPMode::ThreadSafe> Grid = MakeShared<FVehicleProximityGrid, ESPMode::ThreadSafe>();
+    float CellSize = 2000.0f;
+    double LastBuildMilliseconds = 0.0;
+};
@@ -0,0 +1,253 @@
+#include "VehicleRangeSensorComponent.h"
+#include "VehicleBase.h"
+#include "VehicleProximitySubsystem.h"
+#include "VehicleSimCPP.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+UVehicleRangeSensorComponent::UVehicleRangeSensorComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UVehicleRangeSensorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Sensors);
+
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    CandidateAge += DeltaTime;
+    TimeSinceUpdate += DeltaTime;
+    if (TimeSinceUpdate < 1.0f / FMath::Max(UpdateRate, 0.1f))
+    {
+        return;
+    }
+    TimeSinceUpdate = 0.0f;
+
+    if (NeedsCandidates())
+    {
+        GatherCandidates();
+    }
+
+    Detections.Reset();
+    UpdateDetections();
+    NumUpdates++;
+}
+
+bool UVehicleRangeSensorComponent::NeedsCandidates() const
+{
+    // Anything not in the set was at least CandidateMargin beyond Range when it was gathered
+    const float Moved = FVector::Dist(GetComponentLocation(), CandidateOrigin);
+    return !bHasCandidates || Moved + MaxClosingSpeed * CandidateAge > CandidateMargin;
+}
+
+void UVehicleRangeSensorComponent::GatherCandidates()
+{
+    UWorld* World = GetWorld();
+    const FVector Origin = GetComponentLocation();
+    const float Radius = Range + CandidateMargin;
+    const AActor* Owner = GetOwner();
+
+    VehicleCandidates.Reset();
+    StaticCandidates.Reset();
+
+    // Vehicles: the k nearest from this frame's grid. Instanced background traffic is skipped;
+    // near the player it is promoted to real vehicles, which are registered actors.
+    if (const UVehicleProximitySubsystem* Proximity = World->GetSubsystem<UVehicleProximitySubsystem>())
+    {
+        TArray<FVehicleProximityHit, TInlineAllocator<64>> Hits;
+        Hits.SetNum(FMath::Clamp(MaxCandidates, 1, 64));
+        const int32 NumHits = Proximity->GetGrid()->FindNearest(Origin, Radius, Hits, Owner);
+        for (int32 i = 0; i < NumHits; i++)
+        {
+            if (Hits[i].Index == INDEX_NONE && Hits[i].Actor)
+            {
+                if (const UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Hits[i].Actor->GetRootComponent()))
+                {
+                    VehicleCandidates.Add(Root);
+                }
+            }
+        }
+    }
+
+    // Static geometry does not depend on traffic, so one overlap covers it
+    TArray<FOverlapResult> Overlaps;
+    FCollisionQueryParams Params(SCENE_QUERY_STAT(VehicleRangeSensor), false, Owner);
+    World->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity, FCollisionObjectQueryParams(ECC_WorldStatic), FCollisionShape::MakeSphere(Radius), Params);
+    for (const FOverlapResult& Overlap : Overlaps)
+    {
+        if (const UPrimitiveComponent* Component = Overlap.GetComponent())
+        {
+            StaticCandidates.Add(Component);
+        }
+    }
+
+    CandidateOrigin = Origin;
+    CandidateAge = 0.0f;
+    bHasCandidates = true;
+    NumBroadQueries++;
+}
+
+bool UVehicleRangeSensorComponent::GetClosestPoint(const UPrimitiveComponent* Component, const FVector& Location, FVector& OutPoint, float& OutDistance) const
+{
+    // Simple collision where there is some, bounds otherwise
+    OutDistance = Component->GetClosestPointOnCollision(Location, OutPoint);
+    if (OutDistance < 0.0f)
+    {
+        OutPoint = Component->Bounds.GetBox().GetClosestPointTo(Location);
+        OutDistance = FVector::Dist(Location, OutPoint);
+    }
+    return OutDistance <= Range;
+}
+
+bool UVehicleRangeSensorComponent::IsInCone(const FVector& Point, float& OutAzimuth) const
+{
+    const FVector Local = GetComponentTransform().InverseTransformPositionNoScale(Point);
+    if (Local.IsNearlyZero())
+    {
+        OutAzimuth = 0.0f;
+        return true;
+    }
+
+    OutAzimuth = FMath::RadiansToDegrees(FMath::Atan2(Local.Y, Local.X));
+    const float OffAxis = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Local.X / Local.Size(), -1.0, 1.0)));
+    return OffAxis <= HalfAngle;
+}
+
+UVehicleRadarComponent::UVehicleRadarComponent()
+{
+    Range = 15000.0f;
+    HalfAngle = 10.0f;
+    UpdateRate = 20.0f;
+}
+
+void UVehicleRadarComponent::UpdateDetections()
+{
+    const FVector Origin = GetComponentLocation();
+    const FVector OwnVelocity = GetOwner()->GetVelocity();
+
+    auto Consider = [&](const UPrimitiveComponent* Component)
+    {
+        FVector Point;
+        float Distance, Azimuth;
+        if (!Component || !GetClosestPoint(Component, Origin, Point, Distance) || !IsInCone(Point, Azimuth))
+        {
+            return;
+        }
+
+        const FVector LineOfSight = (Point - Origin).GetSafeNormal();
+        const float RadialSpeed = FVector::DotProduct(Component->GetComponentVelocity() - OwnVelocity, LineOfSight);
+        Detections.Add(FVehicleRangeDetection{ Component->GetOwner(), Point, Distance, Azimuth, RadialSpeed });
+    };
+
+    for (const TWeakObjectPtr<const UPrimitiveComponent>& Candidate : VehicleCandidates)
+    {
+        Consider(Candidate.Get());
+    }
+    for (const TWeakObjectPtr<const UPrimitiveComponent>& Candidate : StaticCandidates)
+    {
+        Consider(Candidate.Get());
+    }
+
+    Detections.Sort([](const FVehicleRangeDetection& A, const FVehicleRangeDetection& B) { return A.Distance < B.Distance; });
+}
+
+UVehicleUltrasonicComponent::UVehicleUltrasonicComponent()
+{
+    Range = 450.0f;
+    HalfAngle = 35.0f;
+    UpdateRate = 20.0f;
+    CandidateMargin = 300.0f;
+}
+
+void UVehicleUltrasonicComponent::UpdateDetections()
+{
+    const FVector Origin = GetComponentLocation();
+
+    const UPrimitiveComponent* Nearest = nullptr;
+    FVector NearestPoint = FVector::ZeroVector;
+    float NearestDistance = TNumericLimits<float>::Max();
+    float NearestAzimuth = 0.0f;
+
+    auto Consider = [&](const UPrimitiveComponent* Component)
+    {
+        FVector Point;
+        float Distance, Azimuth;
+        if (Component && GetClosestPoint(Component, Origin, Point, Distance) && Distance < NearestDistance && IsInCone(Point, Azimuth))
+        {
+            Nearest = Component;
+            NearestPoint = Point;
+            NearestDistance = Distance;
+            NearestAzimuth = Azimuth;
+        }
+    };
+
+    for (const TWeakObjectPtr<const UPrimitiveComponent>& Candidate : VehicleCandidates)
+    {
+        Consider(Candidate.Get());
+    }
+    for (const TWeakObjectPtr<const UPrimitiveComponent>& Candidate : StaticCandidates)
+    {
+        Consider(Candidate.Get());
+    }
+
+    if (!Nearest)
+    {
+        return;
+    }
+
+    // The echo comes from whatever the pulse reaches first along that bearing
+    FHitResult Hit;
+    FCollisionQueryParams Params(SCENE_QUERY_STAT(VehicleUltrasonic), false, GetOwner());
+    const FVector End = Origin + (NearestPoint - Origin).GetSafeNormal() * Range;
+    if (GetWorld()->SweepSingleByChannel(Hit, Origin, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SweepRadius), Params))
+    {
+        Detections.Add(FVehicleRangeDetection{ Hit.GetActor(), Hit.ImpactPoint, Hit.Distance, NearestAzimuth, 0.0f });
+    }
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs AttachRangeSensorsCommand(
+        TEXT("vehicle.Sensors.AttachRange"),
+        TEXT("Adds a front radar and front and rear ultrasonic sensors to the player's vehicle"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+            AVehicleBase* Vehicle = PlayerController ? Cast<AVehicleBase>(PlayerController->GetPawn()) : nullptr;
+            if (!Vehicle)
+            {
+                return;
+            }
+
+            auto Attach = [Vehicle](UVehicleRangeSensorComponent* Sensor, const FVector& Location, float Yaw)
+            {
+                Sensor->SetupAttachment(Vehicle->GetRootComponent());
+                Sensor->SetRelativeLocationAndRotation(Location, FRotator(0.0f, Yaw, 0.0f));
+                Sensor->RegisterComponent();
+            };
+            Attach(NewObject<UVehicleRadarComponent>(Vehicle), FVector(125.0f, 0.0f, 50.0f), 0.0f);
+            Attach(NewObject<UVehicleUltrasonicComponent>(Vehicle), FVector(125.0f, 0.0f, 40.0f), 0.0f);
+            Attach(NewObject<UVehicleUltrasonicComponent>(Vehicle), FVector(-125.0f, 0.0f, 40.0f), 180.0f);
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs RangeSensorStatsCommand(
+        TEXT("vehicle.Sensors.Stats"),
+        TEXT("Logs candidate and query counts for every radar and ultrasonic sensor"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            for (TObjectIterator<UVehicleRangeSensorComponent> It; It; ++It)
+            {
+                if (It->GetWorld() == World)
+                {
+                    UE_LOG(LogTemp, Log, TEXT("VehicleRangeSensor: %s.%s %d candidates, %d detections, %d broad queries over %d updates"),
+                        *It->GetOwner()->GetName(), *It->GetName(), It->GetNumCandidates(), It->GetDetections().Num(), It->GetNumBroadQueries(), It->GetNumUpdates());
+                }
+            }
+        }));
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "VehicleRangeSensorComponent.generated.h"
+
+class UPrimitiveComponent;
+
+// One object seen by a range sensor, in world space
+struct FVehicleRangeDetection
+{
+    TWeakObjectPtr<const AActor> Actor;
+    FVector Location = FVector::ZeroVector;     // nearest point on the object
+    float Distance = 0.0f;
+    float Azimuth = 0.0f;           // degrees from the sensor's forward axis, positive to the right
+    float RadialSpeed = 0.0f;       // closing speed along the line of sight, negative when approaching
+};
+
+// Cone-shaped range sensor working on a cached candidate set. A broad phase gathers the nearest
+// vehicles from the proximity grid and static geometry from one overlap query, out to Range plus
+// CandidateMargin. Until the sensor or the traffic could have moved further than the margin,
+// each update only tests those candidates, so the per-update cost is bounded by MaxCandidates
+// however dense the traffic gets.
+UCLASS(Abstract)
+class VEHICLESIMCPP_API UVehicleRangeSensorComponent : public USceneComponent
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleRangeSensorComponent();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float Range = 10000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float HalfAngle = 10.0f;        // degrees either side of forward
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float UpdateRate = 20.0f;       // Hz
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float CandidateMargin = 1000.0f;
+
+    // Fastest closing speed between two vehicles, used to age the candidate set
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float MaxClosingSpeed = 1000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    int32 MaxCandidates = 32;
+
+    const TArray<FVehicleRangeDetection>& GetDetections() const { return Detections; }
+
+    int32 GetNumBroadQueries() const { return NumBroadQueries; }
+    int32 GetNumUpdates() const { return NumUpdates; }
+    int32 GetNumCandidates() const { return VehicleCandidates.Num() + StaticCandidates.Num(); }
+
+protected:
+    // Fills Detections from the current candidates
+    virtual void UpdateDetections() = 0;
+
+    // Nearest point of a candidate to Location and its distance, false if it has no usable shape
+    bool GetClosestPoint(const UPrimitiveComponent* Component, const FVector& Location, FVector& OutPoint, float& OutDistance) const;
+
+    // Azimuth of Point if it is inside the cone
+    bool IsInCone(const FVector& Point, float& OutAzimuth) const;
+
+    void GatherCandidates();
+    bool NeedsCandidates() const;
+
+    TArray<TWeakObjectPtr<const UPrimitiveComponent>> VehicleCandidates;
+    TArray<TWeakObjectPtr<const UPrimitiveComponent>> StaticCandidates;
+    TArray<FVehicleRangeDetection> Detections;
+
+private:
+    FVector CandidateOrigin = FVector::ZeroVector;
+    float CandidateAge = 0.0f;
+    bool bHasCandidates = false;
+
+    float TimeSinceUpdate = 0.0f;
+    int32 NumBroadQueries = 0;
+    int32 NumUpdates = 0;
+};
+
+// Long-range narrow-cone radar: reports every candidate in the cone with its radial speed
+UCLASS(ClassGroup = (Vehicle), meta = (BlueprintSpawnableComponent))
+class VEHICLESIMCPP_API UVehicleRadarComponent : public UVehicleRangeSensorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleRadarComponent();
+
+protected:
+    virtual void UpdateDetections() override;
+};
+
+// Short-range wide-cone parking sensor: reports the nearest echo only. A sphere sweep along the
+// candidate's bearing confirms it is not hidden behind something closer; when no candidate is in
+// the cone no query runs at all.
+UCLASS(ClassGroup = (Vehicle), meta = (BlueprintSpawnableComponent))
+class VEHICLESIMCPP_API UVehicleUltrasonicComponent : public UVehicleRangeSensorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleUltrasonicComponent();
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensor")
+    float SweepRadius = 10.0f;
+
+protected:
+    virtual void UpdateDetections() override;
+};
@@ -0,0 +1,658 @@
+#include "VehicleReplay.h"
+#include "VehicleBase.h"
+#include "VehicleSimCPP.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+FVehicleReplayWriter::~FVehicleReplayWriter()
+{
+    Close();
+}
+
+bool FVehicleReplayWriter::Open(const FString& Filename)
+{
+    Close();
+
+    File = IFileManager::Get().CreateFileWriter(*Filename);
+    if (!File)
+    {
+        return false;
+    }
+
+    uint32 FileMagic = VehicleReplayFormat::Magic;
+    uint32 FileVersion = VehicleReplayFormat::Version;
+    *File << FileMagic << FileVersion;
+
+    VehicleIndices.Reset();
+    VehicleNames.Reset();
+    Keyframes.Reset();
+    LastFrame = MAX_uint64;
+    return true;
+}
+
+void FVehicleReplayWriter::Close()
+{
+    if (!File)
+    {
+        return;
+    }
+
+    // Index, so readers can seek without scanning
+    uint64 IndexOffset = File->Tell();
+    int32 NumNames = VehicleNames.Num();
+    *File << NumNames;
+    for (const FString& Name : VehicleNames)
+    {
+        FTCHARToUTF8 Utf8(*Name);
+        uint16 Length = static_cast<uint16>(Utf8.Length());
+        *File << Length;
+        File->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Length);
+    }
+    for (VehicleReplayFormat::FKeyframeEntry& Entry : Keyframes)
+    {
+        *File << Entry.Time << Entry.Offset;
+    }
+
+    uint32 NumKeyframes = Keyframes.Num();
+    uint32 FileFooterMagic = VehicleReplayFormat::FooterMagic;
+    *File << IndexOffset << NumKeyframes << FileFooterMagic;
+
+    File->Close();
+    delete File;
+    File = nullptr;
+}
+
+int64 FVehicleReplayWriter::GetBytesWritten() const
+{
+    return File ? File->Tell() : 0;
+}
+
+uint16 FVehicleReplayWriter::GetVehicleIndex(const AVehicleBase* Vehicle)
+{
+    if (const uint16* Found = VehicleIndices.Find(Vehicle))
+    {
+        return *Found;
+    }
+
+    const uint16 Index = static_cast<uint16>(VehicleNames.Add(Vehicle->GetName()));
+    VehicleIndices.Add(Vehicle, Index);
+
+    // Also inline, so a file without an index still knows its vehicles
+    FTCHARToUTF8 Utf8(*Vehicle->GetName());
+    uint8 Type = static_cast<uint8>(VehicleReplayFormat::ERecord::Vehicle);
+    uint16 RecordIndex = Index;
+    uint16 Length = static_cast<uint16>(Utf8.Length());
+    *File << Type << RecordIndex << Length;
+    File->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Length);
+    return Index;
+}
+
+void FVehicleReplayWriter::BeginFrame(double Time)
+{
+    if (LastFrame == GFrameCounter)
+    {
+        return;
+    }
+    LastFrame = GFrameCounter;
+
+    uint8 Type = static_cast<uint8>(VehicleReplayFormat::ERecord::Frame);
+    *File << Type << Time;
+}
+
+void FVehicleReplayWriter::WriteMove(const AVehicleBase* Vehicle, const FVehicleMoveInput& Move, double Time)
+{
+    const uint16 Index = GetVehicleIndex(Vehicle);
+    BeginFrame(Time);
+
+    uint8 Type = static_cast<uint8>(VehicleReplayFormat::ERecord::Move);
+    uint16 RecordIndex = Index;
+    uint16 DeltaTime = Move.DeltaTimeQuantized;
+    int8 Throttle = Move.Throttle;
+    int8 Steering = Move.Steering;
+    uint8 Brake = Move.bBrake ? 1 : 0;
+    *File << Type << RecordIndex << DeltaTime << Throttle << Steering << Brake;
+}
+
+void FVehicleReplayWriter::WriteKeyframe(TConstArrayView<const AVehicleBase*> Vehicles, double Time)
+{
+    TArray<uint16, TInlineAllocator<64>> Indices;
+    for (const AVehicleBase* Vehicle : Vehicles)
+    {
+        Indices.Add(GetVehicleIndex(Vehicle));
+    }
+
+    Keyframes.Add(VehicleReplayFormat::FKeyframeEntry{ Time, static_cast<uint64>(File->Tell()) });
+
+    uint8 Type = static_cast<uint8>(VehicleReplayFormat::ERecord::Keyframe);
+    uint16 Count = static_cast<uint16>(Vehicles.Num());
+    *File << Type << Time << Count;
+    for (int32 i = 0; i < Vehicles.Num(); i++)
+    {
+        const AVehicleBase* Vehicle = Vehicles[i];
+        FVector Location = Vehicle->GetActorLocation();
+        FQuat4f Rotation(Vehicle->GetActorQuat());
+        int8 Throttle = static_cast<int8>(FMath::RoundToInt(FMath::Clamp(Vehicle->GetThrottleInput(), -1.0f, 1.0f) * 127.0f));
+        int8 Steering = static_cast<int8>(FMath::RoundToInt(FMath::Clamp(Vehicle->GetSteeringInput(), -1.0f, 1.0f) * 127.0f));
+        uint8 Brake = Vehicle->GetBrakeInput() ? 1 : 0;
+        *File << Indices[i] << Location.X << Location.Y << Location.Z << Rotation.X << Rotation.Y << Rotation.Z << Rotation.W << Throttle << Steering << Brake;
+    }
+
+    // A crash loses at most one keyframe interval
+    File->Flush();
+}
+
+FVehicleReplayReader::~FVehicleReplayReader()
+{
+    Close();
+}
+
+void FVehicleReplayReader::Close()
+{
+    // The region has to go before the file handle
+    MappedRegion.Reset();
+    MappedFile.Reset();
+    Data = nullptr;
+    DataSize = 0;
+    RecordsEnd = 0;
+    Cursor = 0;
+    VehicleNames.Reset();
+    Keyframes.Reset();
+    Duration = 0.0;
+}
+
+template<typename T>
+bool FVehicleReplayReader::Read(T& Value)
+{
+    if (Cursor + int64(sizeof(T)) > RecordsEnd)
+    {
+        return false;
+    }
+    FMemory::Memcpy(&Value, Data + Cursor, sizeof(T));
+    Cursor += sizeof(T);
+    return true;
+}
+
+bool FVehicleReplayReader::Open(const FString& Filename)
+{
+    Close();
+
+    MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+    MappedRegion.Reset(MappedFile ? MappedFile->MapRegion() : nullptr);
+    if (!MappedRegion)
+    {
+        Close();
+        return false;
+    }
+
+    Data = MappedRegion->GetMappedPtr();
+    DataSize = MappedRegion->GetMappedSize();
+    RecordsEnd = DataSize;
+    Cursor = 0;
+
+    uint32 FileMagic = 0;
+    uint32 FileVersion = 0;
+    if (!Read(FileMagic) || !Read(FileVersion) || FileMagic != VehicleReplayFormat::Magic || FileVersion != VehicleReplayFormat::Version)
+    {
+        Close();
+        return false;
+    }
+
+    if (!ReadIndex())
+    {
+        RebuildIndex();
+    }
+    Duration = Keyframes.Num() > 0 ? Keyframes.Last().Time : 0.0;
+    return Keyframes.Num() > 0;
+}
+
+bool FVehicleReplayReader::ReadIndex()
+{
+    constexpr int64 FooterSize = sizeof(uint64) + sizeof(uint32) + sizeof(uint32);
+    if (DataSize < 8 + FooterSize)
+    {
+        return false;
+    }
+
+    uint64 IndexOffset;
+    uint32 NumKeyframes;
+    uint32 FileFooterMagic;
+    FMemory::Memcpy(&IndexOffset, Data + DataSize - FooterSize, sizeof(IndexOffset));
+    FMemory::Memcpy(&NumKeyframes, Data + DataSize - FooterSize + 8, sizeof(NumKeyframes));
+    FMemory::Memcpy(&FileFooterMagic, Data + DataSize - FooterSize + 12, sizeof(FileFooterMagic));
+    if (FileFooterMagic != VehicleReplayFormat::FooterMagic || IndexOffset < 8 || int64(IndexOffset) > DataSize - FooterSize)
+    {
+        return false;
+    }
+
+    // The index is only read here; afterwards records stop where it starts
+    Cursor = IndexOffset;
+    RecordsEnd = DataSize - FooterSize;
+
+    int32 NumNames = 0;
+    if (!Read(NumNames) || NumNames < 0)
+    {
+        return false;
+    }
+    for (int32 i = 0; i < NumNames; i++)
+    {
+        uint16 Length = 0;
+        if (!Read(Length) || Cursor + Length > RecordsEnd)
+        {
+            return false;
+        }
+        const FUTF8ToTCHAR Name(reinterpret_cast<const ANSICHAR*>(Data + Cursor), Length);
+        VehicleNames.Add(FString(Name.Length(), Name.Get()));
+        Cursor += Length;
+    }
+
+    // A corrupt footer must not size the allocation: the entries have to fit before it
+    constexpr int64 EntrySize = sizeof(double) + sizeof(uint64);
+    if (Cursor + int64(NumKeyframes) * EntrySize > RecordsEnd)
+    {
+        return false;
+    }
+
+    Keyframes.SetNum(NumKeyframes);
+    for (VehicleReplayFormat::FKeyframeEntry& Entry : Keyframes)
+    {
+        if (!Read(Entry.Time) || !Read(Entry.Offset))
+        {
+            return false;
+        }
+    }
+
+    RecordsEnd = IndexOffset;
+    return true;
+}
+
+void FVehicleReplayReader::RebuildIndex()
+{
+    VehicleNames.Reset();
+    Keyframes.Reset();
+    RecordsEnd = DataSize;
+    Cursor = 8;
+
+    UE_LOG(LogTemp, Warning, TEXT("VehicleReplay: No index (recording did not finish), scanning the file"));
+
+    TArray<FVehicleState> Unused;
+    while (Cursor < RecordsEnd)
+    {
+        const int64 RecordStart = Cursor;
+        if (Data[Cursor] == static_cast<uint8>(VehicleReplayFormat::ERecord::Keyframe) && Cursor + 1 + int64(sizeof(double)) <= RecordsEnd)
+        {
+            double Time;
+            FMemory::Memcpy(&Time, Data + Cursor + 1, sizeof(Time));
+            Keyframes.Add(VehicleReplayFormat::FKeyframeEntry{ Time, static_cast<uint64>(RecordStart) });
+        }
+        if (!ReadRecord(TNumericLimits<double>::Max(), [](uint16, const FVehicleMoveInput&) {}, &Unused))
+        {
+            // Truncated last record
+            RecordsEnd = RecordStart;
+            if (Keyframes.Num() > 0 && Keyframes.Last().Offset == uint64(RecordStart))
+            {
+                Keyframes.Pop();
+            }
+            break;
+        }
+    }
+}
+
+bool FVehicleReplayReader::ReadRecord(double StopTime, TFunctionRef<void(uint16, const FVehicleMoveInput&)> OnMove, TArray<FVehicleState>* OutKeyframe)
+{
+    const int64 RecordStart = Cursor;
+    uint8 Type = 0;
+    if (!Read(Type))
+    {
+        return false;
+    }
+
+    switch (static_cast<VehicleReplayFormat::ERecord>(Type))
+    {
+    case VehicleReplayFormat::ERecord::Vehicle:
+    {
+        uint16 Index, Length;
+        if (!Read(Index) || !Read(Length) || Cursor + Length > RecordsEnd)
+        {
+            break;
+        }
+        if (!VehicleNames.IsValidIndex(Index))
+        {
+            VehicleNames.SetNum(Index + 1);
+            const FUTF8ToTCHAR Name(reinterpret_cast<const ANSICHAR*>(Data + Cursor), Length);
+            VehicleNames[Index] = FString(Name.Length(), Name.Get());
+        }
+        Cursor += Length;
+        return true;
+    }
+    case VehicleReplayFormat::ERecord::Frame:
+    {
+        double Time;
+        if (!Read(Time))
+        {
+            break;
+        }
+        if (Time > StopTime)
+        {
+            Cursor = RecordStart;
+            return false;
+        }
+        return true;
+    }
+    case VehicleReplayFormat::ERecord::Move:
+    {
+        uint16 Index;
+        FVehicleMoveInput Move;
+        uint8 Brake;
+        if (!Read(Index) || !Read(Move.DeltaTimeQuantized) || !Read(Move.Throttle) || !Read(Move.Steering) || !Read(Brake))
+        {
+            break;
+        }
+        Move.bBrake = Brake != 0;
+        OnMove(Index, Move);
+        return true;
+    }
+    case VehicleReplayFormat::ERecord::Keyframe:
+    {
+        double Time;
+        uint16 Count;
+        if (!Read(Time) || !Read(Count))
+        {
+            break;
+        }
+        if (OutKeyframe)
+        {
+            OutKeyframe->Reset(Count);
+        }
+        for (uint16 i = 0; i < Count; i++)
+        {
+            FVehicleState State;
+            FQuat4f Rotation;
+            uint8 Brake;
+            if (!Read(State.Index) || !Read(State.Location.X) || !Read(State.Location.Y) || !Read(State.Location.Z)
+                || !Read(Rotation.X) || !Read(Rotation.Y) || !Read(Rotation.Z) || !Read(Rotation.W)
+                || !Read(State.Input.Throttle) || !Read(State.Input.Steering) || !Read(Brake))
+            {
+                Cursor = RecordStart;
+                return false;
+            }
+            State.Rotation = FQuat(Rotation);
+            State.Input.bBrake = Brake != 0;
+            if (OutKeyframe)
+            {
+                OutKeyframe->Add(State);
+            }
+        }
+        return true;
+    }
+    default:
+        break;
+    }
+
+    // Unknown or cut short
+    Cursor = RecordStart;
+    return false;
+}
+
+bool FVehicleReplayReader::Seek(double Time, TFunctionRef<void(TConstArrayView<FVehicleState>)> OnKeyframe, TFunctionRef<void(uint16, const FVehicleMoveInput&)> OnMove)
+{
+    if (Keyframes.Num() == 0)
+    {
+        return false;
+    }
+
+    const int32 KeyframeIndex = FMath::Max(Algo::UpperBoundBy(Keyframes, Time, &VehicleReplayFormat::FKeyframeEntry::Time) - 1, 0);
+    Cursor = Keyframes[KeyframeIndex].Offset;
+
+    TArray<FVehicleState> States;
+    if (!ReadRecord(TNumericLimits<double>::Max(), OnMove, &States))
+    {
+        return false;
+    }
+    OnKeyframe(States);
+
+    Advance(Time, OnMove);
+    return true;
+}
+
+void FVehicleReplayReader::Advance(double Time, TFunctionRef<void(uint16, const FVehicleMoveInput&)> OnMove)
+{
+    while (Cursor < RecordsEnd && ReadRecord(Time, OnMove, nullptr))
+    {
+    }
+}
+
+bool UVehicleReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UVehicleReplaySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleReplaySubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleReplaySubsystem::Deinitialize()
+{
+    Stop();
+    Super::Deinitialize();
+}
+
+double UVehicleReplaySubsystem::GetRecordingTime() const
+{
+    return GetWorld()->GetTimeSeconds() - RecordingStartTime;
+}
+
+bool UVehicleReplaySubsystem::StartRecording(const FString& Filename)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Telemetry);
+
+    Stop();
+    if (!Writer.Open(Filename))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleReplay: Could not create %s"), *Filename);
+        return false;
+    }
+
+    RecordingStartTime = GetWorld()->GetTimeSeconds();
+    WriteKeyframe();
+    UE_LOG(LogTemp, Log, TEXT("VehicleReplay: Recording to %s"), *Filename);
+    return true;
+}
+
+bool UVehicleReplaySubsystem::StartPlayback(const FString& Filename)
+{
+    Stop();
+    if (!Reader.Open(Filename))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleReplay: Could not open %s"), *Filename);
+        return false;
+    }
+
+    // Match recorded vehicles to the ones in the world by name, spawning any that are missing
+    TMap<FString, AVehicleBase*> VehiclesByName;
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        VehiclesByName.Add(It->GetName(), *It);
+    }
+
+    PlaybackVehicles.Reset();
+    for (const FString& Name : Reader.GetVehicleNames())
+    {
+        AVehicleBase* Vehicle = VehiclesByName.FindRef(Name);
+        if (!Vehicle)
+        {
+            Vehicle = GetWorld()->SpawnActorDeferred<AVehicleBase>(AVehicleBase::StaticClass(), FTransform::Identity, nullptr, nullptr,
+                ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+            Vehicle->bAutoPossessFirstPlayer = false;
+            Vehicle->FinishSpawning(FTransform::Identity);
+        }
+
+        // The replay drives the movement model from here on
+        Vehicle->SetActorTickEnabled(false);
+        PlaybackVehicles.Add(Vehicle);
+    }
+
+    bPlaying = true;
+    UE_LOG(LogTemp, Log, TEXT("VehicleReplay: Playing %s, %.1f seconds, %d vehicles"), *Filename, Reader.GetDuration(), PlaybackVehicles.Num());
+    Seek(0.0);
+    return true;
+}
+
+void UVehicleReplaySubsystem::Stop()
+{
+    if (Writer.IsOpen())
+    {
+        WriteKeyframe();
+        UE_LOG(LogTemp, Log, TEXT("VehicleReplay: Recorded %.1f seconds, %lld bytes"), GetRecordingTime(), Writer.GetBytesWritten());
+        Writer.Close();
+    }
+
+    if (bPlaying)
+    {
+        for (const TWeakObjectPtr<AVehicleBase>& Vehicle : PlaybackVehicles)
+        {
+            if (Vehicle.IsValid())
+            {
+                Vehicle->SetActorTickEnabled(true);
+            }
+        }
+        PlaybackVehicles.Reset();
+        Reader.Close();
+        bPlaying = false;
+    }
+}
+
+void UVehicleReplaySubsystem::Seek(double Time)
+{
+    if (!bPlaying)
+    {
+        return;
+    }
+
+    CurrentTime = FMath::Clamp(Time, 0.0, Reader.GetDuration());
+    TGuardValue<bool> Applying(bApplyingReplay, true);
+    Reader.Seek(CurrentTime,
+        [this](TConstArrayView<FVehicleReplayReader::FVehicleState> States) { ApplyKeyframe(States); },
+        [this](uint16 Index, const FVehicleMoveInput& Move) { ApplyMove(Index, Move); });
+}
+
+void UVehicleReplaySubsystem::Tick(float DeltaTime)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Telemetry);
+
+    if (Writer.IsOpen() && GetRecordingTime() - LastKeyframeTime >= KeyframeInterval)
+    {
+        WriteKeyframe();
+    }
+
+    if (bPlaying)
+    {
+        CurrentTime += DeltaTime;
+        TGuardValue<bool> Applying(bApplyingReplay, true);
+        Reader.Advance(CurrentTime, [this](uint16 Index, const FVehicleMoveInput& Move) { ApplyMove(Index, Move); });
+    }
+}
+
+void UVehicleReplaySubsystem::RecordMove(const AVehicleBase* Vehicle, const FVehicleMoveInput& Move)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Telemetry);
+
+    if (Writer.IsOpen() && !bApplyingReplay)
+    {
+        Writer.WriteMove(Vehicle, Move, GetRecordingTime());
+    }
+}
+
+void UVehicleReplaySubsystem::WriteKeyframe()
+{
+    TArray<const AVehicleBase*, TInlineAllocator<64>> Vehicles;
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        Vehicles.Add(*It);
+    }
+
+    LastKeyframeTime = GetRecordingTime();
+    Writer.WriteKeyframe(Vehicles, LastKeyframeTime);
+}
+
+void UVehicleReplaySubsystem::ApplyKeyframe(TConstArrayView<FVehicleReplayReader::FVehicleState> States)
+{
+    for (const FVehicleReplayReader::FVehicleState& State : States)
+    {
+        if (AVehicleBase* Vehicle = PlaybackVehicles.IsValidIndex(State.Index) ? PlaybackVehicles[State.Index].Get() : nullptr)
+        {
+            Vehicle->SetActorLocationAndRotation(State.Location, State.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+            Vehicle->SetDriverInput(State.Input.GetThrottle(), State.Input.GetSteering(), State.Input.bBrake);
+        }
+    }
+}
+
+void UVehicleReplaySubsystem::ApplyMove(uint16 Index, const FVehicleMoveInput& Move)
+{
+    if (AVehicleBase* Vehicle = PlaybackVehicles.IsValidIndex(Index) ? PlaybackVehicles[Index].Get() : nullptr)
+    {
+        Vehicle->SimulateMove(Move);
+        Vehicle->SetDriverInput(Move.GetThrottle(), Move.GetSteering(), Move.bBrake);
+    }
+}
+
+namespace
+{
+    FString GetReplayPath(const TArray<FString>& Args)
+    {
+        const FString Name = Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("Replay-%s"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+        return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Replays"), FPaths::SetExtension(Name, TEXT("vreplay")));
+    }
+
+    FAutoConsoleCommandWithWorldAndArgs ReplayRecordCommand(
+        TEXT("vehicle.Replay.Record"),
+        TEXT("Records every vehicle's inputs to Saved/Replays: vehicle.Replay.Record [Name]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (UVehicleReplaySubsystem* Replay = World ? World->GetSubsystem<UVehicleReplaySubsystem>() : nullptr)
+            {
+                Replay->StartRecording(GetReplayPath(Args));
+            }
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs ReplayPlayCommand(
+        TEXT("vehicle.Replay.Play"),
+        TEXT("Plays a recording from Saved/Replays: vehicle.Replay.Play Name"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            UVehicleReplaySubsystem* Replay = World ? World->GetSubsystem<UVehicleReplaySubsystem>() : nullptr;
+            if (Replay && Args.Num() > 0)
+            {
+                Replay->StartPlayback(GetReplayPath(Args));
+            }
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs ReplaySeekCommand(
+        TEXT("vehicle.Replay.Seek"),
+        TEXT("Jumps the playing recording to a time: vehicle.Replay.Seek Seconds"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            UVehicleReplaySubsystem* Replay = World ? World->GetSubsystem<UVehicleReplaySubsystem>() : nullptr;
+            if (Replay && Args.Num() > 0)
+            {
+                Replay->Seek(FCString::Atod(*Args[0]));
+            }
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs ReplayStopCommand(
+        TEXT("vehicle.Replay.Stop"),
+        TEXT("Stops recording or playback"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (UVehicleReplaySubsystem* Replay = World ? World->GetSubsystem<UVehicleReplaySubsystem>() : nullptr)
+            {
+                Replay->Stop();
+            }
+        }));
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleNetState.h"
+#include "VehicleReplayFormat.h"
+#include "VehicleReplay.generated.h"
+
+class AVehicleBase;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Appends records to a replay file
+class VEHICLESIMCPP_API FVehicleReplayWriter
+{
+public:
+    ~FVehicleReplayWriter();
+
+    bool Open(const FString& Filename);
+    void Close();
+    bool IsOpen() const { return File != nullptr; }
+
+    void WriteMove(const AVehicleBase* Vehicle, const FVehicleMoveInput& Move, double Time);
+    void WriteKeyframe(TConstArrayView<const AVehicleBase*> Vehicles, double Time);
+
+    int64 GetBytesWritten() const;
+
+private:
+    uint16 GetVehicleIndex(const AVehicleBase* Vehicle);
+    void BeginFrame(double Time);
+
+    FArchive* File = nullptr;
+    TMap<TWeakObjectPtr<const AVehicleBase>, uint16> VehicleIndices;
+    TArray<FString> VehicleNames;
+    TArray<VehicleReplayFormat::FKeyframeEntry> Keyframes;
+    uint64 LastFrame = MAX_uint64;
+};
+
+// Reads a replay file through a memory mapping, so opening and seeking cost the same for a
+// minute or an hour of recording; pages are only touched as records are read
+class VEHICLESIMCPP_API FVehicleReplayReader
+{
+public:
+    ~FVehicleReplayReader();
+
+    bool Open(const FString& Filename);
+    void Close();
+
+    double GetDuration() const { return Duration; }
+    const TArray<FString>& GetVehicleNames() const { return VehicleNames; }
+
+    struct FVehicleState
+    {
+        uint16 Index = 0;
+        FVector Location = FVector::ZeroVector;
+        FQuat Rotation = FQuat::Identity;
+        FVehicleMoveInput Input;
+    };
+
+    // Restore from the last keyframe at or before Time (binary search), then call
+    // OnMove for every move from there up to Time
+    bool Seek(double Time, TFunctionRef<void(TConstArrayView<FVehicleState>)> OnKeyframe, TFunctionRef<void(uint16, const FVehicleMoveInput&)> OnMove);
+
+    // Continue from the last position up to Time
+    void Advance(double Time, TFunctionRef<void(uint16, const FVehicleMoveInput&)> OnMove);
+
+private:
+    bool ReadIndex();
+    void RebuildIndex();
+
+    // Reads one record at Cursor. Stops (returning false) before a Frame later than StopTime.
+    bool ReadRecord(double StopTime, TFunctionRef<void(uint16, const FVehicleMoveInput&)> OnMove, TArray<FVehicleState>* OutKeyframe);
+
+    template<typename T>
+    bool Read(T& Value);
+
+    TUniquePtr<IMappedFileHandle> MappedFile;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    const uint8* Data = nullptr;
+    int64 DataSize = 0;
+    int64 RecordsEnd = 0;
+    int64 Cursor = 0;
+
+    TArray<FString> VehicleNames;
+    TArray<VehicleReplayFormat::FKeyframeEntry> Keyframes;
+    double Duration = 0.0;
+};
+
+// Records every authoritative vehicle move to Saved/Replays, or plays a recording back by
+// driving the vehicles' movement model directly (their own ticks are paused meanwhile).
+// vehicle.Replay.Record / Stop / Play <File> / Seek <Seconds>.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleReplaySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    bool StartRecording(const FString& Filename);
+    bool StartPlayback(const FString& Filename);
+    void Stop();
+    void Seek(double Time);
+
+    bool IsRecording() const { return Writer.IsOpen(); }
+    bool IsPlaying() const { return bPlaying; }
+    double GetTime() const { return CurrentTime; }
+
+    // Called by AVehicleBase::SimulateMove on the authority
+    void RecordMove(const AVehicleBase* Vehicle, const FVehicleMoveInput& Move);
+
+    // Seconds between full state keyframes
+    float KeyframeInterval = 1.0f;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    double GetRecordingTime() const;
+    void WriteKeyframe();
+    void ApplyKeyframe(TConstArrayView<FVehicleReplayReader::FVehicleState> States);
+    void ApplyMove(uint16 Index, const FVehicleMoveInput& Move);
+
+    FVehicleReplayWriter Writer;
+    double RecordingStartTime = 0.0;
+    double LastKeyframeTime = 0.0;
+
+    FVehicleReplayReader Reader;
+    TArray<TWeakObjectPtr<AVehicleBase>> PlaybackVehicles;
+    bool bPlaying = false;
+    bool bApplyingReplay = false;
+    double CurrentTime = 0.0;
+};
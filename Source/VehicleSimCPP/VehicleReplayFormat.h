@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Replay file layout (little-endian, append-only while recording):
+//
+//   Header    'VRPL', version
+//   Records   uint8 type followed by:
+//     Vehicle   uint16 index, uint16 name length, UTF-8 name    (first time a vehicle moves)
+//     Frame     double time since recording start                 (before a frame's moves)
+//     Move      uint16 index, uint16 delta time, int8 throttle, int8 steering, uint8 brake
+//     Keyframe  double time, uint16 count, count x vehicle state  (every KeyframeInterval)
+//               state: uint16 index, 3 x double location, 4 x float rotation (x, y, z, w),
+//                      int8 throttle, int8 steering, uint8 brake
+//   Index     written on close: int32 name count, (uint16 length, UTF-8 name) per vehicle,
+//             then (double time, uint64 offset) per keyframe
+//   Footer    uint64 index offset, uint32 keyframe count, 'VRPX'
+//
+// Moves are the exact quantized inputs AVehicleBase::SimulateMove ran, so replaying them from
+// a keyframe reproduces the recorded motion. A file without a footer (crashed recording) is
+// still playable; its keyframe index is rebuilt with one scan.
+//
+// Only depends on Core, so offline tools (VehicleTelemetryTool) can read replays too.
+namespace VehicleReplayFormat
+{
+    constexpr uint32 Magic = 0x4C505256;        // "VRPL"
+    constexpr uint32 FooterMagic = 0x58505256;  // "VRPX"
+    constexpr uint32 Version = 1;
+
+    enum class ERecord : uint8
+    {
+        Vehicle = 1,
+        Frame = 2,
+        Move = 3,
+        Keyframe = 4,
+    };
+
+    // Record sizes after the type byte
+    constexpr int64 HeaderSize = 8;
+    constexpr int64 FooterSize = 16;
+    constexpr int64 FrameSize = 8;
+    constexpr int64 MoveSize = 7;
+    constexpr int64 KeyframeHeaderSize = 10;
+    constexpr int64 KeyframeStateSize = 45;
+
+    struct FKeyframeEntry
+    {
+        double Time = 0.0;
+        uint64 Offset = 0;
+    };
+}
@@ -0,0 +1,269 @@
+#include "VehicleReplicationGraph.h"
+#include "VehicleBase.h"
+#include "Engine/World.h"
+
+UVehicleReplicationGraphNode_Grid::UVehicleReplicationGraphNode_Grid()
+{
+    // The grid is rebuilt once per network frame before any connection gathers from it
+    bRequiresPrepareForReplicationCall = true;
+}
+
+void UVehicleReplicationGraphNode_Grid::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+    Vehicles.Add(ActorInfo.Actor);
+}
+
+bool UVehicleReplicationGraphNode_Grid::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+    const bool bRemoved = Vehicles.RemoveSwap(ActorInfo.Actor) > 0;
+    if (!bRemoved && bWarnIfNotFound)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleReplicationGraph: %s was not in the vehicle grid"), *GetNameSafe(ActorInfo.Actor));
+    }
+
+    // Drop it from its cell right away so it isn't gathered again this frame. Cells not filled
+    // this frame are never gathered before they are refilled.
+    for (FCell& Cell : Cells)
+    {
+        if (Cell.LastFilledFrame == BuildFrame)
+        {
+            Cell.Actors.RemoveFast(ActorInfo.Actor);
+        }
+    }
+    return bRemoved;
+}
+
+void UVehicleReplicationGraphNode_Grid::NotifyResetAllNetworkActors()
+{
+    Vehicles.Reset();
+    CellIndices.Reset();
+    Cells.Reset();
+}
+
+FIntPoint UVehicleReplicationGraphNode_Grid::GetCellCoord(const FVector& Location) const
+{
+    return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+int32 UVehicleReplicationGraphNode_Grid::GetPeriodForDistance(int32 CellDistance) const
+{
+    if (CellDistance <= NearCells)
+    {
+        return 1;
+    }
+    if (CellDistance <= MidCells)
+    {
+        return MidPeriod;
+    }
+    if (CellDistance <= FarCells)
+    {
+        return FarPeriod;
+    }
+    return 0;
+}
+
+void UVehicleReplicationGraphNode_Grid::PrepareForReplication()
+{
+    ++BuildFrame;
+
+    // Bucket every vehicle. Cells keep their list memory between frames, so this doesn't allocate
+    // once the set of occupied cells has settled.
+    for (AActor* Vehicle : Vehicles)
+    {
+        if (!IsValid(Vehicle))
+        {
+            continue;
+        }
+
+        const FIntPoint Coord = GetCellCoord(Vehicle->GetActorLocation());
+        int32* CellIndex = CellIndices.Find(Coord);
+        if (!CellIndex)
+        {
+            CellIndex = &CellIndices.Add(Coord, Cells.AddDefaulted());
+            Cells[*CellIndex].Coord = Coord;
+        }
+
+        FCell& Cell = Cells[*CellIndex];
+        if (Cell.LastFilledFrame != BuildFrame)
+        {
+            Cell.Actors.Reset();
+            Cell.LastFilledFrame = BuildFrame;
+        }
+        Cell.Actors.Add(Vehicle);
+    }
+
+    if (BuildFrame % FMath::Max(CellEvictionFrames, 1) == 0)
+    {
+        EvictStaleCells();
+    }
+}
+
+void UVehicleReplicationGraphNode_Grid::EvictStaleCells()
+{
+    for (int32 i = Cells.Num() - 1; i >= 0; i--)
+    {
+        if (BuildFrame - Cells[i].LastFilledFrame < static_cast<uint32>(CellEvictionFrames))
+        {
+            continue;
+        }
+
+        // The last cell moves into the freed slot; point its coordinate at the new index
+        CellIndices.Remove(Cells[i].Coord);
+        Cells.RemoveAtSwap(i, 1, EAllowShrinking::No);
+        if (i < Cells.Num())
+        {
+            CellIndices[Cells[i].Coord] = i;
+        }
+    }
+}
+
+void UVehicleReplicationGraphNode_Grid::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+    // Stagger reduced-rate cells across connections so they don't all land on the same frame
+    const uint32 Frame = Params.ReplicationFrameNum + Params.ConnectionManager.ConnectionOrderNum;
+
+    TArray<int32, TInlineAllocator<128>> GatheredCells;
+
+    for (const FNetViewer& Viewer : Params.Viewers)
+    {
+        const FIntPoint Center = GetCellCoord(Viewer.ViewLocation);
+
+        for (int32 DY = -FarCells; DY <= FarCells; DY++)
+        {
+            for (int32 DX = -FarCells; DX <= FarCells; DX++)
+            {
+                const int32* CellIndex = CellIndices.Find(FIntPoint(Center.X + DX, Center.Y + DY));
+                if (!CellIndex)
+                {
+                    continue;
+                }
+
+                const FCell& Cell = Cells[*CellIndex];
+                if (Cell.LastFilledFrame != BuildFrame || Cell.Actors.Num() == 0)
+                {
+                    continue;
+                }
+
+                const int32 Period = GetPeriodForDistance(FMath::Max(FMath::Abs(DX), FMath::Abs(DY)));
+                if (Period == 0 || (Frame % Period) != 0)
+                {
+                    continue;
+                }
+
+                // Split screen viewers can overlap the same cells
+                if (GatheredCells.Contains(*CellIndex))
+                {
+                    continue;
+                }
+                GatheredCells.Add(*CellIndex);
+
+                Params.OutGatheredReplicationLists.AddReplicationActorList(Cell.Actors);
+            }
+        }
+    }
+}
+
+void UVehicleReplicationGraphNode_Grid::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+    DebugInfo.Log(NodeName);
+    DebugInfo.PushIndent();
+    DebugInfo.Log(FString::Printf(TEXT("Vehicles: %d, Cells: %d, CellSize: %.0f"), Vehicles.Num(), Cells.Num(), CellSize));
+    DebugInfo.PopIndent();
+}
+
+UVehicleReplicationGraph::UVehicleReplicationGraph()
+{
+}
+
+void UVehicleReplicationGraph::InitGlobalActorClassSettings()
+{
+    Super::InitGlobalActorClassSettings();
+
+    FClassReplicationInfo VehicleInfo;
+    VehicleInfo.ReplicationPeriodFrame = 1;
+
+    // Match the grid's outer ring so the built-in distance check agrees with our cells
+    const float FarDistance = VehicleCellSize * (VehicleFarCells + 1) * UE_SQRT_2;
+    VehicleInfo.SetCullDistanceSquared(FarDistance * FarDistance);
+
+    // Far cells are only gathered every few frames; keep their channels open in between
+    VehicleInfo.ActorChannelFrameTimeout = static_cast<uint8>(FMath::Clamp(VehicleFarPeriod * 2, 4, 255));
+
+    GlobalActorReplicationInfoMap.SetClassInfo(AVehicleBase::StaticClass(), VehicleInfo);
+}
+
+void UVehicleReplicationGraph::InitGlobalGraphNodes()
+{
+    VehicleGridNode = CreateNewNode<UVehicleReplicationGraphNode_Grid>();
+    VehicleGridNode->CellSize = VehicleCellSize;
+    VehicleGridNode->NearCells = VehicleNearCells;
+    VehicleGridNode->MidCells = VehicleMidCells;
+    VehicleGridNode->FarCells = VehicleFarCells;
+    VehicleGridNode->MidPeriod = FMath::Max(1, VehicleMidPeriod);
+    VehicleGridNode->FarPeriod = FMath::Max(1, VehicleFarPeriod);
+    VehicleGridNode->CellEvictionFrames = FMath::Max(1, VehicleCellEvictionFrames);
+    AddGlobalGraphNode(VehicleGridNode);
+
+    AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+    AddGlobalGraphNode(AlwaysRelevantNode);
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleReplicationGraph: Vehicle grid %.0f units, near/mid/far %d/%d/%d cells"),
+           VehicleCellSize, VehicleNearCells, VehicleMidCells, VehicleFarCells);
+}
+
+void UVehicleReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+    Super::InitConnectionGraphNodes(RepGraphConnection);
+
+    // Each connection's own PlayerController, view target and PlayerState
+    UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+    AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void UVehicleReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+    if (ActorInfo.Actor->IsA<AVehicleBase>())
+    {
+        VehicleGridNode->NotifyAddNetworkActor(ActorInfo);
+    }
+    else if (ActorInfo.Actor->bOnlyRelevantToOwner)
+    {
+        // PlayerControllers: picked up by the per-connection node
+    }
+    else
+    {
+        // Everything else here is global game state (GameState, PlayerStates, ...)
+        AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+    }
+}
+
+int32 UVehicleReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+
+    AccumulatedReplicationSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+    AccumulatedReplicationFrames++;
+    return NumReplicated;
+}
+
+double UVehicleReplicationGraph::ConsumeReplicationSeconds(int32& OutNumFrames)
+{
+    const double Seconds = AccumulatedReplicationSeconds;
+    OutNumFrames = AccumulatedReplicationFrames;
+    AccumulatedReplicationSeconds = 0.0;
+    AccumulatedReplicationFrames = 0;
+    return Seconds;
+}
+
+void UVehicleReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+    if (ActorInfo.Actor->IsA<AVehicleBase>())
+    {
+        VehicleGridNode->NotifyRemoveNetworkActor(ActorInfo);
+    }
+    else if (!ActorInfo.Actor->bOnlyRelevantToOwner)
+    {
+        AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+    }
+}
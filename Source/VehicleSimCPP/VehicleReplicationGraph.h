@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "VehicleReplicationGraph.generated.h"
+
+// Buckets every replicated vehicle into a 2D grid once per network frame and gives each
+// connection only the cells around its viewers. Cells further away are gathered less often.
+// Cost per frame is O(vehicles) to rebuild plus O(nearby cells) per connection.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleReplicationGraphNode_Grid : public UReplicationGraphNode
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleReplicationGraphNode_Grid();
+
+    virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+    virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override;
+    virtual void NotifyResetAllNetworkActors() override;
+    virtual void PrepareForReplication() override;
+    virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+    virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+    // Grid layout (set by the owning graph)
+    float CellSize = 20000.0f;
+    int32 NearCells = 1;        // Gathered every frame
+    int32 MidCells = 2;         // Gathered every MidPeriod frames
+    int32 FarCells = 4;         // Gathered every FarPeriod frames, nothing beyond
+    int32 MidPeriod = 2;
+    int32 FarPeriod = 4;
+
+    // Cells no vehicle has entered for this many frames are freed, so memory follows the
+    // occupied area rather than every cell ever visited
+    int32 CellEvictionFrames = 300;
+
+    int32 GetNumVehicles() const { return Vehicles.Num(); }
+
+private:
+    struct FCell
+    {
+        FActorRepListRefView Actors;
+        FIntPoint Coord = FIntPoint::ZeroValue;
+        uint32 LastFilledFrame = 0;
+    };
+
+    FIntPoint GetCellCoord(const FVector& Location) const;
+    void EvictStaleCells();
+
+    // Returns how often (in frames) a cell at this ring distance from a viewer is gathered, 0 = never
+    int32 GetPeriodForDistance(int32 CellDistance) const;
+
+    TArray<AActor*> Vehicles;
+    TMap<FIntPoint, int32> CellIndices;
+    TArray<FCell> Cells;
+    uint32 BuildFrame = 0;
+};
+
+UCLASS(Transient, Config = Engine)
+class VEHICLESIMCPP_API UVehicleReplicationGraph : public UReplicationGraph
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleReplicationGraph();
+
+    virtual void InitGlobalActorClassSettings() override;
+    virtual void InitGlobalGraphNodes() override;
+    virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+    virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+    virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+    virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+    // Game thread seconds spent replicating since the last call, for server load reports
+    double ConsumeReplicationSeconds(int32& OutNumFrames);
+
+    // Size of one relevancy grid cell in world units
+    UPROPERTY(Config)
+    float VehicleCellSize = 20000.0f;
+
+    // Ring distances (in cells) around a viewer for full, reduced and lowest update rate
+    UPROPERTY(Config)
+    int32 VehicleNearCells = 1;
+
+    UPROPERTY(Config)
+    int32 VehicleMidCells = 2;
+
+    UPROPERTY(Config)
+    int32 VehicleFarCells = 4;
+
+    UPROPERTY(Config)
+    int32 VehicleMidPeriod = 2;
+
+    UPROPERTY(Config)
+    int32 VehicleFarPeriod = 4;
+
+    // Frames a grid cell may stay empty before its memory is freed
+    UPROPERTY(Config)
+    int32 VehicleCellEvictionFrames = 300;
+
+protected:
+    UPROPERTY()
+    UVehicleReplicationGraphNode_Grid* VehicleGridNode;
+
+    UPROPERTY()
+    UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+private:
+    double AccumulatedReplicationSeconds = 0.0;
+    int32 AccumulatedReplicationFrames = 0;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+// Fixed-capacity FIFO that never allocates. Pushing into a full buffer drops the oldest element.
+// Index 0 is the oldest element, Num() - 1 the newest.
+template<typename ElementType, int32 Capacity>
+class TVehicleRingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    void Push(const ElementType& Element)
+    {
+        if (Count == Capacity)
+        {
+            Head = (Head + 1) & (Capacity - 1);
+            --Count;
+        }
+        Elements[(Head + Count) & (Capacity - 1)] = Element;
+        ++Count;
+    }
+
+    void PopFront(int32 NumToPop = 1)
+    {
+        NumToPop = FMath::Min(NumToPop, Count);
+        Head = (Head + NumToPop) & (Capacity - 1);
+        Count -= NumToPop;
+    }
+
+    void Reset()
+    {
+        Head = 0;
+        Count = 0;
+    }
+
+    ElementType& operator[](int32 Index)
+    {
+        check(Index >= 0 && Index < Count);
+        return Elements[(Head + Index) & (Capacity - 1)];
+    }
+
+    const ElementType& operator[](int32 Index) const
+    {
+        check(Index >= 0 && Index < Count);
+        return Elements[(Head + Index) & (Capacity - 1)];
+    }
+
+    ElementType& Last() { return (*this)[Count - 1]; }
+    const ElementType& Last() const { return (*this)[Count - 1]; }
+
+    int32 Num() const { return Count; }
+    bool IsEmpty() const { return Count == 0; }
+    bool IsFull() const { return Count == Capacity; }
+    static constexpr int32 Max() { return Capacity; }
+
+private:
+    TStaticArray<ElementType, Capacity> Elements;
+    int32 Head = 0;
+    int32 Count = 0;
+};
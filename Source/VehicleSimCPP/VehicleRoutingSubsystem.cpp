@@ -0,0 +1,546 @@
+#include "VehicleRoutingSubsystem.h"
+#include "VehicleLaneGraph.h"
+#include "VehicleLaneGraphSubsystem.h"
+#include "Algo/Reverse.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+    // Extra travel time charged for a lane change, in seconds
+    constexpr float LaneChangePenalty = 2.0f;
+
+    // Search budget for a local detour before falling back to a full search
+    constexpr int32 MaxRepairExpansions = 2000;
+
+    // A route crossing this many separate closures is planned again instead
+    constexpr int32 MaxRepairPasses = 8;
+
+    constexpr int32 RouteCacheSize = 4096;
+    constexpr float NearestLaneSearchRadius = 5000.0f;
+
+    bool IsClosed(const TBitArray<>* Closures, int32 Lane)
+    {
+        return Closures && Closures->IsValidIndex(Lane) && (*Closures)[Lane];
+    }
+
+    float GetTravelTime(const FVehicleLaneGraph& Graph, int32 Lane)
+    {
+        const FVehicleLaneGraph::FLane& LaneData = Graph.GetLane(Lane);
+        return LaneData.Length / FMath::Max(LaneData.SpeedLimit, 1.0f);
+    }
+
+    // Search state reused by every query on the same worker thread, so searches don't allocate
+    // once the arrays have grown to the lane count
+    struct FRouteSearchScratch
+    {
+        struct FOpenNode
+        {
+            float Estimate = 0.0f;
+            float Cost = 0.0f;
+            int32 Lane = INDEX_NONE;
+        };
+
+        TArray<float> Cost;
+        TArray<int32> Parent;
+        TArray<uint32> Stamp;
+        TArray<FOpenNode> Open;
+        uint32 CurrentStamp = 0;
+
+        void Begin(int32 NumLanes)
+        {
+            if (Stamp.Num() != NumLanes)
+            {
+                // Stamps left over from a search of the previous graph would otherwise match the
+                // restarted stamp counter, so every entry is cleared, not just the new ones
+                Cost.SetNumUninitialized(NumLanes);
+                Parent.SetNumUninitialized(NumLanes);
+                Stamp.Init(0, NumLanes);
+                CurrentStamp = 0;
+            }
+            if (++CurrentStamp == 0)
+            {
+                FMemory::Memzero(Stamp.GetData(), Stamp.Num() * sizeof(uint32));
+                CurrentStamp = 1;
+            }
+            Open.Reset();
+        }
+
+        bool Visit(int32 Lane, float NewCost, int32 FromLane)
+        {
+            if (Stamp[Lane] == CurrentStamp && Cost[Lane] <= NewCost)
+            {
+                return false;
+            }
+            Stamp[Lane] = CurrentStamp;
+            Cost[Lane] = NewCost;
+            Parent[Lane] = FromLane;
+            return true;
+        }
+    };
+
+    thread_local FRouteSearchScratch GRouteSearchScratch;
+
+    // Best-first search from StartLane until IsGoal accepts a lane. Heuristic must not overestimate.
+    template<typename GoalType, typename HeuristicType>
+    int32 SearchLanes(const FVehicleLaneGraph& Graph, const TBitArray<>* Closures, int32 StartLane, int32 MaxExpansions,
+        GoalType IsGoal, HeuristicType Heuristic, TArray<int32>& OutLanes, float& OutCost)
+    {
+        FRouteSearchScratch& Scratch = GRouteSearchScratch;
+        Scratch.Begin(Graph.GetNumLanes());
+
+        auto ByEstimate = [](const FRouteSearchScratch::FOpenNode& A, const FRouteSearchScratch::FOpenNode& B) { return A.Estimate < B.Estimate; };
+
+        Scratch.Visit(StartLane, 0.0f, INDEX_NONE);
+        Scratch.Open.HeapPush({ Heuristic(StartLane), 0.0f, StartLane }, ByEstimate);
+
+        auto TryEdge = [&](int32 From, int32 To, float EdgeCost, float FromCost)
+        {
+            if (To == INDEX_NONE || IsClosed(Closures, To))
+            {
+                return;
+            }
+            const float NewCost = FromCost + EdgeCost;
+            if (Scratch.Visit(To, NewCost, From))
+            {
+                Scratch.Open.HeapPush({ NewCost + Heuristic(To), NewCost, To }, ByEstimate);
+            }
+        };
+
+        int32 Expansions = 0;
+        while (Scratch.Open.Num() > 0 && Expansions < MaxExpansions)
+        {
+            FRouteSearchScratch::FOpenNode Node;
+            Scratch.Open.HeapPop(Node, ByEstimate, EAllowShrinking::No);
+            if (Node.Cost > Scratch.Cost[Node.Lane])
+            {
+                continue; // a cheaper way here was found after this entry was queued
+            }
+
+            if (IsGoal(Node.Lane))
+            {
+                OutLanes.Reset();
+                for (int32 Lane = Node.Lane; Lane != INDEX_NONE; Lane = Scratch.Parent[Lane])
+                {
+                    OutLanes.Add(Lane);
+                }
+                Algo::Reverse(OutLanes);
+                OutCost = Node.Cost;
+                return Node.Lane;
+            }
+
+            Expansions++;
+            for (int32 Successor : Graph.GetSuccessors(Node.Lane))
+            {
+                TryEdge(Node.Lane, Successor, GetTravelTime(Graph, Successor), Node.Cost);
+            }
+
+            const FVehicleLaneGraph::FLane& Lane = Graph.GetLane(Node.Lane);
+            TryEdge(Node.Lane, Lane.LeftNeighbour, LaneChangePenalty, Node.Cost);
+            TryEdge(Node.Lane, Lane.RightNeighbour, LaneChangePenalty, Node.Cost);
+        }
+
+        return INDEX_NONE;
+    }
+
+    float ComputeRouteCost(const FVehicleLaneGraph& Graph, const TArray<int32>& Lanes)
+    {
+        float Cost = 0.0f;
+        for (int32 i = 1; i < Lanes.Num(); i++)
+        {
+            Cost += Graph.GetSuccessors(Lanes[i - 1]).Contains(Lanes[i]) ? GetTravelTime(Graph, Lanes[i]) : LaneChangePenalty;
+        }
+        return Cost;
+    }
+}
+
+bool VehicleRoutePlanner::FindRoute(const FVehicleLaneGraph& Graph, const TBitArray<>* Closures, int32 StartLane, int32 GoalLane, FVehicleRoute& OutRoute)
+{
+    if (StartLane < 0 || StartLane >= Graph.GetNumLanes() || GoalLane < 0 || GoalLane >= Graph.GetNumLanes() || IsClosed(Closures, GoalLane))
+    {
+        return false;
+    }
+
+    // Straight line from the end of a lane to the start of the goal at the fastest speed limit
+    const FVector3f GoalLocation = Graph.GetLanePoints(GoalLane)[0];
+    const float InvMaxSpeed = 1.0f / FMath::Max(Graph.GetMaxSpeedLimit(), 1.0f);
+    auto Heuristic = [&](int32 Lane)
+    {
+        return Lane == GoalLane ? 0.0f : FVector3f::Dist(Graph.GetLanePoints(Lane).Last(), GoalLocation) * InvMaxSpeed;
+    };
+
+    return SearchLanes(Graph, Closures, StartLane, MAX_int32, [GoalLane](int32 Lane) { return Lane == GoalLane; }, Heuristic,
+        OutRoute.Lanes, OutRoute.Cost) != INDEX_NONE;
+}
+
+bool VehicleRoutePlanner::UsesClosedLane(const FVehicleRoute& Route, const TBitArray<>* Closures)
+{
+    if (!Closures)
+    {
+        return false;
+    }
+    for (int32 Lane : Route.Lanes)
+    {
+        if (IsClosed(Closures, Lane))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VehicleRoutePlanner::RepairRoute(const FVehicleLaneGraph& Graph, const TBitArray<>* Closures, const FVehicleRoute& Route, FVehicleRoute& OutRoute)
+{
+    OutRoute = Route;
+    const int32 GoalLane = Route.GetGoalLane();
+    if (GoalLane == INDEX_NONE || IsClosed(Closures, GoalLane))
+    {
+        return false;
+    }
+
+    TArray<int32> Detour;
+    for (int32 Pass = 0; Pass < MaxRepairPasses; Pass++)
+    {
+        // The vehicle may already be on a closed start lane, so only later lanes count
+        int32 FirstClosed = INDEX_NONE;
+        for (int32 i = 1; i < OutRoute.Lanes.Num(); i++)
+        {
+            if (IsClosed(Closures, OutRoute.Lanes[i]))
+            {
+                FirstClosed = i;
+                break;
+            }
+        }
+        if (FirstClosed == INDEX_NONE)
+        {
+            OutRoute.Cost = ComputeRouteCost(Graph, OutRoute.Lanes);
+            return true;
+        }
+
+        // Rejoin the old route at the first open lane after the closure, the earlier the better
+        const TArray<int32>& Lanes = OutRoute.Lanes;
+        auto RejoinIndex = [&Lanes, FirstClosed, Closures](int32 Lane)
+        {
+            for (int32 j = FirstClosed + 1; j < Lanes.Num(); j++)
+            {
+                if (Lanes[j] == Lane && !IsClosed(Closures, Lane))
+                {
+                    return j;
+                }
+            }
+            return static_cast<int32>(INDEX_NONE);
+        };
+
+        float DetourCost = 0.0f;
+        const int32 RejoinLane = SearchLanes(Graph, Closures, Lanes[FirstClosed - 1], MaxRepairExpansions,
+            [&RejoinIndex](int32 Lane) { return RejoinIndex(Lane) != INDEX_NONE; },
+            [](int32) { return 0.0f; },
+            Detour, DetourCost);
+
+        if (RejoinLane == INDEX_NONE)
+        {
+            return FindRoute(Graph, Closures, Route.GetStartLane(), GoalLane, OutRoute);
+        }
+
+        // Old lanes up to the closure, the detour, then the rest of the old route
+        const int32 Rejoin = RejoinIndex(RejoinLane);
+        TArray<int32> Repaired;
+        Repaired.Reserve(FirstClosed + Detour.Num() + Lanes.Num() - Rejoin);
+        Repaired.Append(Lanes.GetData(), FirstClosed - 1);
+        Repaired.Append(Detour);
+        Repaired.Append(Lanes.GetData() + Rejoin + 1, Lanes.Num() - Rejoin - 1);
+        OutRoute.Lanes = MoveTemp(Repaired);
+    }
+
+    return FindRoute(Graph, Closures, Route.GetStartLane(), GoalLane, OutRoute);
+}
+
+UVehicleRoutingSubsystem::UVehicleRoutingSubsystem()
+    : RouteCache(RouteCacheSize)
+{
+}
+
+bool UVehicleRoutingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleRoutingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Collection.InitializeDependency<UVehicleLaneGraphSubsystem>();
+    Super::Initialize(Collection);
+
+    // Leave most workers to physics, animation and the traffic model
+    MaxTasksInFlight = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() / 2);
+}
+
+void UVehicleRoutingSubsystem::Deinitialize()
+{
+    // Workers read the lane graph and push into our queue, so they must finish first
+    UE::Tasks::Wait(RunningTasks);
+    RunningTasks.Reset();
+
+    FResult Result;
+    while (CompletedResults.Dequeue(Result))
+    {
+    }
+
+    Waiting.Reset();
+    PendingRequests.Reset();
+    RouteCache.Empty(RouteCacheSize);
+
+    Super::Deinitialize();
+}
+
+TStatId UVehicleRoutingSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleRoutingSubsystem, STATGROUP_Tickables);
+}
+
+const FVehicleLaneGraph* UVehicleRoutingSubsystem::GetLaneGraph() const
+{
+    const UVehicleLaneGraphSubsystem* LaneGraphSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UVehicleLaneGraphSubsystem>() : nullptr;
+    return LaneGraphSubsystem && LaneGraphSubsystem->HasLanes() ? &LaneGraphSubsystem->GetLaneGraph() : nullptr;
+}
+
+void UVehicleRoutingSubsystem::RequestRoute(int32 StartLane, int32 GoalLane, FVehicleRouteCallback&& OnComplete)
+{
+    const FVehicleLaneGraph* Graph = GetLaneGraph();
+    if (!Graph || StartLane < 0 || StartLane >= Graph->GetNumLanes() || GoalLane < 0 || GoalLane >= Graph->GetNumLanes())
+    {
+        OnComplete(nullptr);
+        return;
+    }
+
+    const uint64 Key = MakeKey(StartLane, GoalLane);
+    if (const TSharedPtr<const FVehicleRoute>* Cached = RouteCache.FindAndTouch(Key))
+    {
+        NumCacheHits++;
+        OnComplete(*Cached);
+        return;
+    }
+
+    NumCacheMisses++;
+    TArray<FVehicleRouteCallback>* Callbacks = Waiting.Find(Key);
+    if (Callbacks)
+    {
+        // Someone already asked for this route, share the result
+        Callbacks->Add(MoveTemp(OnComplete));
+        return;
+    }
+
+    Waiting.Add(Key).Add(MoveTemp(OnComplete));
+    QueueRequest(Key, nullptr);
+}
+
+void UVehicleRoutingSubsystem::RequestRoute(const FVector& Start, const FVector& Goal, FVehicleRouteCallback&& OnComplete)
+{
+    const FVehicleLaneGraph* Graph = GetLaneGraph();
+    FVehicleLanePosition StartPosition;
+    FVehicleLanePosition GoalPosition;
+    if (!Graph
+        || !Graph->FindNearestLane(Start, NearestLaneSearchRadius, StartPosition)
+        || !Graph->FindNearestLane(Goal, NearestLaneSearchRadius, GoalPosition))
+    {
+        OnComplete(nullptr);
+        return;
+    }
+
+    RequestRoute(StartPosition.Lane, GoalPosition.Lane, MoveTemp(OnComplete));
+}
+
+void UVehicleRoutingSubsystem::QueueRequest(uint64 Key, TSharedPtr<const FVehicleRoute> RouteToRepair)
+{
+    FRequest& Request = PendingRequests.AddDefaulted_GetRef();
+    Request.Key = Key;
+    Request.RouteToRepair = MoveTemp(RouteToRepair);
+}
+
+bool UVehicleRoutingSubsystem::IsLaneClosed(int32 Lane) const
+{
+    return IsClosed(Closures.Get(), Lane);
+}
+
+void UVehicleRoutingSubsystem::SetLaneClosed(int32 Lane, bool bClosed)
+{
+    const FVehicleLaneGraph* Graph = GetLaneGraph();
+    if (!Graph || Lane < 0 || Lane >= Graph->GetNumLanes() || IsLaneClosed(Lane) == bClosed)
+    {
+        return;
+    }
+
+    // Copy on write: searches already running keep the snapshot they started with
+    TSharedPtr<TBitArray<>, ESPMode::ThreadSafe> NewClosures = Closures.IsValid()
+        ? MakeShared<TBitArray<>, ESPMode::ThreadSafe>(*Closures)
+        : MakeShared<TBitArray<>, ESPMode::ThreadSafe>(false, Graph->GetNumLanes());
+    if (NewClosures->Num() != Graph->GetNumLanes())
+    {
+        // The graph was rebuilt since the last closure
+        NewClosures->SetNum(Graph->GetNumLanes(), false);
+    }
+    (*NewClosures)[Lane] = bClosed;
+    Closures = NewClosures;
+    ClosureEpoch++;
+
+    if (!bClosed)
+    {
+        // A reopened lane can only make routes shorter; let them be planned again on demand
+        RouteCache.Empty(RouteCacheSize);
+        UE_LOG(LogTemp, Log, TEXT("VehicleRouting: Lane %d reopened, route cache cleared"), Lane);
+        return;
+    }
+
+    // Repair every cached route through the closed lane in the background
+    TArray<uint64> Keys;
+    RouteCache.GetKeys(Keys);
+    int32 NumAffected = 0;
+    for (uint64 Key : Keys)
+    {
+        const TSharedPtr<const FVehicleRoute>* Route = RouteCache.Find(Key);
+        if (Route && (*Route)->Lanes.Contains(Lane))
+        {
+            const TSharedPtr<const FVehicleRoute> OldRoute = *Route;
+            RouteCache.Remove(Key);
+            if (!Waiting.Contains(Key))
+            {
+                Waiting.Add(Key);
+                QueueRequest(Key, OldRoute);
+            }
+            NumAffected++;
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleRouting: Lane %d closed, repairing %d cached routes"), Lane, NumAffected);
+}
+
+void UVehicleRoutingSubsystem::Tick(float DeltaTime)
+{
+    RunningTasks.RemoveAllSwap([](const UE::Tasks::FTask& Task) { return Task.IsCompleted(); });
+
+    LaunchBatches();
+    PublishResults();
+}
+
+void UVehicleRoutingSubsystem::LaunchBatches()
+{
+    const FVehicleLaneGraph* Graph = GetLaneGraph();
+    if (!Graph)
+    {
+        return;
+    }
+
+    int32 NumTaken = 0;
+    while (NumTaken < PendingRequests.Num() && RunningTasks.Num() < MaxTasksInFlight)
+    {
+        const int32 BatchSize = FMath::Min(RequestsPerTask, PendingRequests.Num() - NumTaken);
+        TArray<FRequest> Batch(PendingRequests.GetData() + NumTaken, BatchSize);
+        NumTaken += BatchSize;
+
+        RunningTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION,
+            [this, Graph, Batch = MoveTemp(Batch), ClosureSnapshot = Closures, Epoch = ClosureEpoch]()
+            {
+                for (const FRequest& Request : Batch)
+                {
+                    FResult Result;
+                    Result.Key = Request.Key;
+                    Result.ClosureEpoch = Epoch;
+                    Result.bRepaired = Request.RouteToRepair.IsValid();
+
+                    TSharedPtr<FVehicleRoute> Route = MakeShared<FVehicleRoute>();
+                    const bool bFound = Request.RouteToRepair.IsValid()
+                        ? VehicleRoutePlanner::RepairRoute(*Graph, ClosureSnapshot.Get(), *Request.RouteToRepair, *Route)
+                        : VehicleRoutePlanner::FindRoute(*Graph, ClosureSnapshot.Get(), static_cast<int32>(Request.Key >> 32), static_cast<int32>(Request.Key & 0xFFFFFFFF), *Route);
+                    if (bFound)
+                    {
+                        Route->ClosureEpoch = Epoch;
+                        Result.Route = Route;
+                    }
+                    CompletedResults.Enqueue(MoveTemp(Result));
+                }
+            }));
+    }
+
+    PendingRequests.RemoveAt(0, NumTaken, EAllowShrinking::No);
+}
+
+void UVehicleRoutingSubsystem::PublishResults()
+{
+    const double StartTime = FPlatformTime::Seconds();
+    FResult Result;
+    while (FPlatformTime::Seconds() - StartTime < PublishBudgetSeconds && CompletedResults.Dequeue(Result))
+    {
+        // Planned before the latest closure and now blocked: repair it (callers keep waiting)
+        if (Result.ClosureEpoch != ClosureEpoch)
+        {
+            if (Result.Route.IsValid() && VehicleRoutePlanner::UsesClosedLane(*Result.Route, Closures.Get()))
+            {
+                QueueRequest(Result.Key, Result.Route);
+                continue;
+            }
+            if (!Result.Route.IsValid())
+            {
+                QueueRequest(Result.Key, nullptr);
+                continue;
+            }
+        }
+
+        if (Result.Route.IsValid())
+        {
+            RouteCache.Add(Result.Key, Result.Route);
+        }
+        if (Result.bRepaired)
+        {
+            NumRepaired++;
+        }
+        else
+        {
+            NumPlanned++;
+        }
+
+        TArray<FVehicleRouteCallback> Callbacks;
+        if (Waiting.RemoveAndCopyValue(Result.Key, Callbacks))
+        {
+            for (FVehicleRouteCallback& Callback : Callbacks)
+            {
+                Callback(Result.Route);
+            }
+        }
+    }
+}
+
+void UVehicleRoutingSubsystem::LogStats() const
+{
+    const int64 NumRequests = NumCacheHits + NumCacheMisses;
+    UE_LOG(LogTemp, Log, TEXT("VehicleRouting: %lld requests, %.1f%% cache hits, %lld planned, %lld repaired, %d cached, %d waiting, %d queued, %d tasks running, %d lanes closed"),
+        NumRequests, NumRequests > 0 ? 100.0 * NumCacheHits / NumRequests : 0.0, NumPlanned, NumRepaired,
+        RouteCache.Num(), Waiting.Num(), PendingRequests.Num(), RunningTasks.Num(),
+        Closures.IsValid() ? Closures->CountSetBits() : 0);
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs RouteStatsCommand(
+        TEXT("vehicle.Route.Stats"),
+        TEXT("Logs routing service cache and queue statistics"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (UVehicleRoutingSubsystem* Routing = World ? World->GetSubsystem<UVehicleRoutingSubsystem>() : nullptr)
+            {
+                Routing->LogStats();
+            }
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs CloseLaneCommand(
+        TEXT("vehicle.Route.CloseLane"),
+        TEXT("Closes (or with a second argument of 0, reopens) a lane for routing. Args: <Lane> [Closed=1]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            UVehicleRoutingSubsystem* Routing = World ? World->GetSubsystem<UVehicleRoutingSubsystem>() : nullptr;
+            if (Routing && Args.Num() > 0)
+            {
+                Routing->SetLaneClosed(FCString::Atoi(*Args[0]), Args.Num() < 2 || FCString::Atoi(*Args[1]) != 0);
+            }
+        }));
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "Containers/Queue.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "VehicleRoutingSubsystem.generated.h"
+
+class FVehicleLaneGraph;
+
+// A route through the lane graph. Consecutive lanes are either successors or side
+// neighbours (a lane change). Routes are immutable once published.
+struct VEHICLESIMCPP_API FVehicleRoute
+{
+    TArray<int32> Lanes;
+    float Cost = 0.0f;              // estimated travel time in seconds
+    uint32 ClosureEpoch = 0;        // road closures known when the route was made
+
+    int32 GetStartLane() const { return Lanes.Num() > 0 ? Lanes[0] : INDEX_NONE; }
+    int32 GetGoalLane() const { return Lanes.Num() > 0 ? Lanes.Last() : INDEX_NONE; }
+};
+
+using FVehicleRouteCallback = TFunction<void(TSharedPtr<const FVehicleRoute> Route)>;
+
+// Set of closed lanes. Workers get a snapshot per batch, so closing a road never races a search.
+using FVehicleLaneClosures = TSharedPtr<const TBitArray<>, ESPMode::ThreadSafe>;
+
+namespace VehicleRoutePlanner
+{
+    // A* over lanes, weighted by travel time. Returns false if the goal is unreachable.
+    VEHICLESIMCPP_API bool FindRoute(const FVehicleLaneGraph& Graph, const TBitArray<>* Closures, int32 StartLane, int32 GoalLane, FVehicleRoute& OutRoute);
+
+    // Fix a route that runs through closed lanes by searching a local detour from the lane
+    // before each closure back onto the remaining route. Falls back to FindRoute when no
+    // detour is found within the expansion budget.
+    VEHICLESIMCPP_API bool RepairRoute(const FVehicleLaneGraph& Graph, const TBitArray<>* Closures, const FVehicleRoute& Route, FVehicleRoute& OutRoute);
+
+    VEHICLESIMCPP_API bool UsesClosedLane(const FVehicleRoute& Route, const TBitArray<>* Closures);
+}
+
+// Plans routes on the world's lane graph on worker threads.
+//
+// Requests are queued and handed to workers in batches, identical in-flight requests are
+// merged, and finished routes are published on the game thread within a small time budget,
+// so thousands of vehicles asking at once do not stall a frame. Finished routes are kept in
+// an LRU cache keyed by start and goal lane. Closing a lane repairs the cached routes that
+// use it instead of planning them again from scratch.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleRoutingSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleRoutingSubsystem();
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Callback runs on the game thread, immediately on a cache hit, with null if there is no route
+    void RequestRoute(int32 StartLane, int32 GoalLane, FVehicleRouteCallback&& OnComplete);
+
+    // Route from the lane nearest to each location
+    void RequestRoute(const FVector& Start, const FVector& Goal, FVehicleRouteCallback&& OnComplete);
+
+    // Close or reopen a lane (an incident, road works). Cached routes through it are repaired.
+    void SetLaneClosed(int32 Lane, bool bClosed);
+    bool IsLaneClosed(int32 Lane) const;
+
+    // Changes whenever a lane is closed or reopened. Holders of a route with an older epoch
+    // should ask for it again (cached routes are repaired by then).
+    uint32 GetClosureEpoch() const { return ClosureEpoch; }
+
+    void LogStats() const;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    struct FRequest
+    {
+        uint64 Key = 0;
+        TSharedPtr<const FVehicleRoute> RouteToRepair;
+    };
+
+    struct FResult
+    {
+        uint64 Key = 0;
+        TSharedPtr<const FVehicleRoute> Route;   // null if unreachable
+        uint32 ClosureEpoch = 0;
+        bool bRepaired = false;
+    };
+
+    static uint64 MakeKey(int32 StartLane, int32 GoalLane) { return (static_cast<uint64>(static_cast<uint32>(StartLane)) << 32) | static_cast<uint32>(GoalLane); }
+
+    const FVehicleLaneGraph* GetLaneGraph() const;
+    void QueueRequest(uint64 Key, TSharedPtr<const FVehicleRoute> RouteToRepair);
+    void LaunchBatches();
+    void PublishResults();
+
+    // How many requests one worker task plans
+    static constexpr int32 RequestsPerTask = 32;
+
+    // Game thread time allowed per frame for publishing routes and running callbacks
+    static constexpr double PublishBudgetSeconds = 0.0005;
+
+    TLruCache<uint64, TSharedPtr<const FVehicleRoute>> RouteCache;
+    TMap<uint64, TArray<FVehicleRouteCallback>> Waiting;
+    TArray<FRequest> PendingRequests;
+    TQueue<FResult, EQueueMode::Mpsc> CompletedResults;
+    TArray<UE::Tasks::FTask> RunningTasks;
+
+    FVehicleLaneClosures Closures;
+    uint32 ClosureEpoch = 0;
+
+    int32 MaxTasksInFlight = 4;
+    int64 NumCacheHits = 0;
+    int64 NumCacheMisses = 0;
+    int64 NumPlanned = 0;
+    int64 NumRepaired = 0;
+};
@@ -0,0 +1,162 @@
+#include "VehicleServerStatsSubsystem.h"
+#include "VehicleNetState.h"
+#include "VehicleReplicationGraph.h"
+#include "VehicleStats.h"
+#include "VehicleSimCPP.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "CoreGlobals.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+bool UVehicleServerStatsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if WITH_SERVER_CODE
+    float Interval = 0.0f;
+    const bool bRequested = FParse::Param(FCommandLine::Get(), TEXT("VehicleServerStats"))
+        || FParse::Value(FCommandLine::Get(), TEXT("VehicleServerStats="), Interval);
+    return bRequested && Super::ShouldCreateSubsystem(Outer);
+#else
+    return false;
+#endif
+}
+
+bool UVehicleServerStatsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleServerStatsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    FParse::Value(FCommandLine::Get(), TEXT("VehicleServerStats="), ReportInterval);
+    ReportInterval = FMath::Max(1.0f, ReportInterval);
+
+    const FString Stamp = FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S"));
+    const FString Directory = FPaths::ProfilingDir();
+    SummaryFile = IFileManager::Get().CreateFileWriter(*FPaths::Combine(Directory, FString::Printf(TEXT("ServerStats-%s.csv"), *Stamp)));
+    ConnectionFile = IFileManager::Get().CreateFileWriter(*FPaths::Combine(Directory, FString::Printf(TEXT("ServerConnections-%s.csv"), *Stamp)));
+
+    WriteLine(SummaryFile, TEXT("Time,Connections,TickMsMedian,TickMsP95,TickMsP99,TickMsMax,ReplicationMsMean,ReplicationMsP99,OutBytesPerSecTotal,OutBytesPerSecPerConnection,InBytesPerSecTotal,VehicleStateBytesPerUpdate"));
+    WriteLine(ConnectionFile, TEXT("Time,Connection,OutBytesPerSec,InBytesPerSec,PingMs,OutPacketsLost,InPacketsLost"));
+
+    TickTimesMs.Reserve(4096);
+    ReplicationTimesMs.Reserve(4096);
+
+    UE_LOG(LogTemp, Warning, TEXT("VehicleServerStats: Reporting every %.0f seconds to %s"), ReportInterval, *Directory);
+}
+
+void UVehicleServerStatsSubsystem::Deinitialize()
+{
+    if (TickTimesMs.Num() > 0)
+    {
+        WriteReport();
+    }
+
+    delete SummaryFile;
+    delete ConnectionFile;
+    SummaryFile = nullptr;
+    ConnectionFile = nullptr;
+
+    Super::Deinitialize();
+}
+
+TStatId UVehicleServerStatsSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleServerStatsSubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleServerStatsSubsystem::Tick(float DeltaTime)
+{
+    LLM_SCOPE_BYTAG(VehicleSim_Telemetry);
+
+    UWorld* World = GetWorld();
+    if (!World || World->GetNetMode() == NM_Client)
+    {
+        return;
+    }
+
+    // Game thread work of the last frame, excluding the idle wait for the next server tick
+    TickTimesMs.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+    if (UNetDriver* NetDriver = World->GetNetDriver())
+    {
+        if (UVehicleReplicationGraph* Graph = Cast<UVehicleReplicationGraph>(NetDriver->GetReplicationDriver()))
+        {
+            int32 NumFrames = 0;
+            const double Seconds = Graph->ConsumeReplicationSeconds(NumFrames);
+            if (NumFrames > 0)
+            {
+                ReplicationTimesMs.Add(Seconds * 1000.0 / NumFrames);
+            }
+        }
+    }
+
+    ElapsedTime += DeltaTime;
+    TimeSinceReport += DeltaTime;
+    if (TimeSinceReport >= ReportInterval)
+    {
+        WriteReport();
+        TimeSinceReport = 0.0f;
+    }
+}
+
+void UVehicleServerStatsSubsystem::WriteReport()
+{
+    UWorld* World = GetWorld();
+    UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+    int64 TotalOut = 0;
+    int64 TotalIn = 0;
+    int32 NumConnections = 0;
+    if (NetDriver)
+    {
+        for (UNetConnection* Connection : NetDriver->ClientConnections)
+        {
+            if (!Connection)
+            {
+                continue;
+            }
+
+            NumConnections++;
+            TotalOut += Connection->OutBytesPerSecond;
+            TotalIn += Connection->InBytesPerSecond;
+
+            WriteLine(ConnectionFile, FString::Printf(TEXT("%.1f,%s,%d,%d,%.1f,%d,%d"),
+                ElapsedTime, *Connection->LowLevelGetRemoteAddress(true),
+                Connection->OutBytesPerSecond, Connection->InBytesPerSecond, Connection->AvgLag * 1000.0,
+                Connection->OutPacketsLost, Connection->InPacketsLost));
+        }
+    }
+
+    const FVehicleTimingSummary Tick = FVehicleTimingSummary::FromSamples(TickTimesMs);
+    const FVehicleTimingSummary Replication = FVehicleTimingSummary::FromSamples(ReplicationTimesMs);
+    const double OutPerConnection = NumConnections > 0 ? static_cast<double>(TotalOut) / NumConnections : 0.0;
+
+    WriteLine(SummaryFile, FString::Printf(TEXT("%.1f,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%lld,%.0f,%lld,%.2f"),
+        ElapsedTime, NumConnections, Tick.Median, Tick.P95, Tick.P99, Tick.Max,
+        Replication.Mean, Replication.P99, TotalOut, OutPerConnection, TotalIn,
+        FVehicleNetStats::GetAverageBytesPerUpdate()));
+
+    UE_LOG(LogTemp, Warning, TEXT("VehicleServerStats: %d connections | tick ms %s | replication ms %s | out %lld B/s (%.0f per connection) | vehicle state %.2f B/update"),
+           NumConnections, *Tick.ToString(), *Replication.ToString(), TotalOut, OutPerConnection, FVehicleNetStats::GetAverageBytesPerUpdate());
+
+    TickTimesMs.Reset();
+    ReplicationTimesMs.Reset();
+}
+
+void UVehicleServerStatsSubsystem::WriteLine(FArchive* File, const FString& Line)
+{
+    if (!File)
+    {
+        return;
+    }
+
+    const FTCHARToUTF8 Utf8(*(Line + TEXT("\n")));
+    File->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+    File->Flush();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleServerStatsSubsystem.generated.h"
+
+// Server load report for bot swarm runs, enabled with -VehicleServerStats[=IntervalSeconds].
+// Every interval it logs and appends to Saved/Profiling:
+//  - game thread tick time percentiles
+//  - replication (ServerReplicateActors) CPU time
+//  - per-connection in/out bandwidth and ping
+UCLASS()
+class VEHICLESIMCPP_API UVehicleServerStatsSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    void WriteReport();
+    void WriteLine(FArchive* File, const FString& Line);
+
+    float ReportInterval = 10.0f;
+    float TimeSinceReport = 0.0f;
+    double ElapsedTime = 0.0;
+
+    TArray<double> TickTimesMs;
+    TArray<double> ReplicationTimesMs;
+
+    FArchive* SummaryFile = nullptr;
+    FArchive* ConnectionFile = nullptr;
+};
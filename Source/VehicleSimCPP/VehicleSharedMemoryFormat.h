@@ -0,0 +1,129 @@
+#pragma once
+
+/*
+ * Layout of the VehicleSim shared-memory output channel. Plain C so external processes can
+ * include it as is; the simulator's publisher (UVehicleSharedMemorySubsystem) uses it too.
+ *
+ * The region (shm_open("/VehicleSim") on Linux/macOS, a named file mapping on Windows) holds a
+ * VehicleSimShmHeader followed by slot_count slots of slot_size bytes. Frame N goes into slot
+ * N % slot_count. The simulator never waits for readers: a reader that falls more than
+ * slot_count frames behind sees the sequence numbers jump and should resynchronise from
+ * write_sequence.
+ *
+ * Each slot is protected by a sequence lock. The writer stores begin_sequence, writes the
+ * payload, then stores end_sequence. A copy is consistent when end_sequence (read first) and
+ * begin_sequence (read after copying) both equal the expected frame number; see
+ * vehiclesim_shm_read_frame below.
+ *
+ * All values are little-endian. Positions are in centimetres (Unreal units), rotations are
+ * quaternions (x, y, z, w), velocities in cm/s.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define VEHICLESIM_SHM_MAGIC 0x4D485356u   /* "VSHM" */
+#define VEHICLESIM_SHM_VERSION 1u
+
+enum VehicleSimFrameType
+{
+    VEHICLESIM_FRAME_STATE = 1,     /* payload: vehicle_count VehicleSimVehicleState */
+    VEHICLESIM_FRAME_LIDAR = 2,     /* payload: point_count VehicleSimLidarPoint, from source_id */
+};
+
+enum VehicleSimFrameFlags
+{
+    VEHICLESIM_FRAME_TRUNCATED = 1, /* the payload did not fit in a slot and was cut short */
+};
+
+typedef struct VehicleSimShmHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;             /* bytes per slot, including VehicleSimSlotHeader */
+    uint64_t write_sequence;        /* newest complete frame, 0 before the first one */
+    uint8_t reserved[40];           /* pads the header to a cache line */
+} VehicleSimShmHeader;
+
+typedef struct VehicleSimSlotHeader
+{
+    uint64_t begin_sequence;
+    uint64_t end_sequence;
+    uint8_t reserved[48];
+} VehicleSimSlotHeader;
+
+/* First bytes of every slot payload */
+typedef struct VehicleSimFrameHeader
+{
+    uint64_t sequence;
+    double sim_time;                /* seconds since the world started */
+    uint32_t frame_type;            /* VehicleSimFrameType */
+    uint32_t flags;                 /* VehicleSimFrameFlags */
+    uint32_t payload_bytes;         /* bytes after this header */
+    uint32_t item_count;            /* vehicles or points */
+    uint32_t source_id;             /* vehicle that produced a sensor frame */
+    uint32_t reserved;
+} VehicleSimFrameHeader;
+
+typedef struct VehicleSimVehicleState
+{
+    uint32_t vehicle_id;
+    uint32_t brake;                 /* 1 while braking */
+    double location[3];
+    float rotation[4];
+    float velocity[3];
+    float throttle;                 /* -1..1 */
+    float steering;                 /* -1..1 */
+    uint32_t reserved;
+} VehicleSimVehicleState;
+
+typedef struct VehicleSimLidarPoint
+{
+    float location[3];              /* sensor frame */
+    float range;                    /* 0 for no return */
+} VehicleSimLidarPoint;
+
+#define VEHICLESIM_SLOT_PAYLOAD(header, slot) \
+    ((uint8_t*)(header) + sizeof(VehicleSimShmHeader) + (uint64_t)(slot) * (header)->slot_size + sizeof(VehicleSimSlotHeader))
+
+#if defined(__GNUC__) || defined(__clang__)
+
+/* Newest complete frame number */
+static inline uint64_t vehiclesim_shm_latest(const VehicleSimShmHeader* header)
+{
+    return __atomic_load_n(&header->write_sequence, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Copies frame `sequence` into out (at most out_size bytes, starting with its
+ * VehicleSimFrameHeader). Returns the number of bytes copied, or 0 if the frame has been
+ * overwritten or is not complete yet. Never blocks.
+ */
+static inline uint32_t vehiclesim_shm_read_frame(const VehicleSimShmHeader* header, uint64_t sequence, void* out, uint32_t out_size)
+{
+    const uint32_t slot = (uint32_t)(sequence % header->slot_count);
+    const VehicleSimSlotHeader* slot_header = (const VehicleSimSlotHeader*)(VEHICLESIM_SLOT_PAYLOAD(header, slot) - sizeof(VehicleSimSlotHeader));
+    const VehicleSimFrameHeader* frame = (const VehicleSimFrameHeader*)VEHICLESIM_SLOT_PAYLOAD(header, slot);
+
+    if (__atomic_load_n(&slot_header->end_sequence, __ATOMIC_ACQUIRE) != sequence)
+    {
+        return 0;
+    }
+
+    uint32_t size = (uint32_t)sizeof(VehicleSimFrameHeader) + frame->payload_bytes;
+    if (size > header->slot_size - (uint32_t)sizeof(VehicleSimSlotHeader))
+    {
+        return 0;   /* torn header */
+    }
+    if (size > out_size)
+    {
+        size = out_size;
+    }
+    memcpy(out, frame, size);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot_header->begin_sequence, __ATOMIC_RELAXED) == sequence ? size : 0;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#include "VehicleSharedMemorySubsystem.h"
+#include "VehicleBase.h"
+#include "VehicleLidarComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Parse.h"
+
+namespace
+{
+    // The C structs are shared with other processes, so their layout is part of the format
+    static_assert(sizeof(VehicleSimShmHeader) == 64, "Shared memory header must stay one cache line");
+    static_assert(sizeof(VehicleSimSlotHeader) == 64, "Slot header must stay one cache line");
+    static_assert(sizeof(VehicleSimFrameHeader) == 40, "Frame header layout changed");
+    static_assert(sizeof(VehicleSimVehicleState) == 72, "Vehicle state layout changed");
+    static_assert(sizeof(VehicleSimLidarPoint) == sizeof(FVehicleLidarPoint), "Lidar points are copied as is");
+
+    void StoreSequence(uint64_t& Target, uint64 Value)
+    {
+        FPlatformAtomics::AtomicStore(reinterpret_cast<volatile int64*>(&Target), static_cast<int64>(Value));
+    }
+}
+
+bool UVehicleSharedMemorySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    FString Name;
+    const bool bRequested = FParse::Param(FCommandLine::Get(), TEXT("VehicleShm")) || FParse::Value(FCommandLine::Get(), TEXT("VehicleShm="), Name);
+    return bRequested && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UVehicleSharedMemorySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleSharedMemorySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    FString Name = TEXT("VehicleSim");
+    FParse::Value(FCommandLine::Get(), TEXT("VehicleShm="), Name);
+
+    if (GConfig)
+    {
+        int32 Value = 0;
+        if (GConfig->GetInt(TEXT("VehicleSim.SharedMemory"), TEXT("SlotCount"), Value, GGameIni))
+        {
+            SlotCount = FMath::Clamp(Value, 2, 4096);
+        }
+        if (GConfig->GetInt(TEXT("VehicleSim.SharedMemory"), TEXT("SlotSize"), Value, GGameIni))
+        {
+            SlotSize = Align(FMath::Clamp(Value, 4096, 256 * 1024 * 1024), 64);
+        }
+    }
+
+    const SIZE_T RegionSize = sizeof(VehicleSimShmHeader) + SIZE_T(SlotCount) * SlotSize;
+    const uint32 Access = static_cast<uint32>(FPlatformMemory::ESharedMemoryAccess::Read) | static_cast<uint32>(FPlatformMemory::ESharedMemoryAccess::Write);
+    Region = FPlatformMemory::MapNamedSharedMemoryRegion(Name, true, Access, RegionSize);
+    if (!Region)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleSharedMemory: Could not create shared memory region %s (%llu bytes)"), *Name, uint64(RegionSize));
+        return;
+    }
+
+    // Readers check the magic last, so everything else is in place when it appears
+    FMemory::Memzero(Region->GetAddress(), RegionSize);
+    Header = static_cast<VehicleSimShmHeader*>(Region->GetAddress());
+    Header->version = VEHICLESIM_SHM_VERSION;
+    Header->slot_count = SlotCount;
+    Header->slot_size = SlotSize;
+    FPlatformMisc::MemoryBarrier();
+    Header->magic = VEHICLESIM_SHM_MAGIC;
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleSharedMemory: Publishing to %s, %u slots of %u bytes"), *Name, SlotCount, SlotSize);
+}
+
+void UVehicleSharedMemorySubsystem::Deinitialize()
+{
+    if (Region)
+    {
+        Header->magic = 0;
+        FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+        Region = nullptr;
+        Header = nullptr;
+    }
+
+    Super::Deinitialize();
+}
+
+TStatId UVehicleSharedMemorySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleSharedMemorySubsystem, STATGROUP_Tickables);
+}
+
+uint8* UVehicleSharedMemorySubsystem::BeginFrame(uint32 FrameType, uint32& OutCapacity)
+{
+    const uint64 FrameSequence = Sequence + 1;
+    uint8* Slot = reinterpret_cast<uint8*>(Header + 1) + (FrameSequence % SlotCount) * SlotSize;
+    CurrentSlot = reinterpret_cast<VehicleSimSlotHeader*>(Slot);
+    CurrentFrame = reinterpret_cast<VehicleSimFrameHeader*>(CurrentSlot + 1);
+
+    // Open the sequence lock before touching the payload
+    StoreSequence(CurrentSlot->begin_sequence, FrameSequence);
+    FPlatformMisc::MemoryBarrier();
+
+    CurrentFrame->sequence = FrameSequence;
+    CurrentFrame->sim_time = GetWorld()->GetTimeSeconds();
+    CurrentFrame->frame_type = FrameType;
+
+    OutCapacity = SlotSize - sizeof(VehicleSimSlotHeader) - sizeof(VehicleSimFrameHeader);
+    return reinterpret_cast<uint8*>(CurrentFrame + 1);
+}
+
+void UVehicleSharedMemorySubsystem::EndFrame(uint32 PayloadBytes, uint32 ItemCount, uint32 SourceId, uint32 Flags)
+{
+    CurrentFrame->flags = Flags;
+    CurrentFrame->payload_bytes = PayloadBytes;
+    CurrentFrame->item_count = ItemCount;
+    CurrentFrame->source_id = SourceId;
+    CurrentFrame->reserved = 0;
+
+    Sequence = CurrentFrame->sequence;
+    StoreSequence(CurrentSlot->end_sequence, Sequence);
+    StoreSequence(Header->write_sequence, Sequence);
+
+    BytesWritten += sizeof(VehicleSimFrameHeader) + PayloadBytes;
+    NumTruncated += (Flags & VEHICLESIM_FRAME_TRUNCATED) ? 1 : 0;
+    CurrentSlot = nullptr;
+    CurrentFrame = nullptr;
+}
+
+void UVehicleSharedMemorySubsystem::Tick(float DeltaTime)
+{
+    if (!Header)
+    {
+        return;
+    }
+
+    uint32 Capacity = 0;
+    VehicleSimVehicleState* States = reinterpret_cast<VehicleSimVehicleState*>(BeginFrame(VEHICLESIM_FRAME_STATE, Capacity));
+    const uint32 MaxStates = Capacity / sizeof(VehicleSimVehicleState);
+
+    // Written straight into the slot, no staging copy
+    uint32 NumStates = 0;
+    uint32 Flags = 0;
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        if (NumStates == MaxStates)
+        {
+            Flags |= VEHICLESIM_FRAME_TRUNCATED;
+            break;
+        }
+
+        const AVehicleBase* Vehicle = *It;
+        const FVector Location = Vehicle->GetActorLocation();
+        const FQuat Rotation = Vehicle->GetActorQuat();
+        const FVector Velocity = Vehicle->GetVelocity();
+
+        VehicleSimVehicleState& State = States[NumStates++];
+        State.vehicle_id = Vehicle->GetUniqueID();
+        State.brake = Vehicle->GetBrakeInput() ? 1 : 0;
+        State.location[0] = Location.X;
+        State.location[1] = Location.Y;
+        State.location[2] = Location.Z;
+        State.rotation[0] = Rotation.X;
+        State.rotation[1] = Rotation.Y;
+        State.rotation[2] = Rotation.Z;
+        State.rotation[3] = Rotation.W;
+        State.velocity[0] = Velocity.X;
+        State.velocity[1] = Velocity.Y;
+        State.velocity[2] = Velocity.Z;
+        State.throttle = Vehicle->GetThrottleInput();
+        State.steering = Vehicle->GetSteeringInput();
+        State.reserved = 0;
+    }
+
+    EndFrame(NumStates * sizeof(VehicleSimVehicleState), NumStates, 0, Flags);
+}
+
+void UVehicleSharedMemorySubsystem::PublishLidarSweep(const AActor* Vehicle, TConstArrayView<FVehicleLidarPoint> Points)
+{
+    if (!Header)
+    {
+        return;
+    }
+
+    uint32 Capacity = 0;
+    uint8* Payload = BeginFrame(VEHICLESIM_FRAME_LIDAR, Capacity);
+    const uint32 NumPoints = FMath::Min<uint32>(Points.Num(), Capacity / sizeof(VehicleSimLidarPoint));
+    FMemory::Memcpy(Payload, Points.GetData(), NumPoints * sizeof(VehicleSimLidarPoint));
+
+    const uint32 Flags = NumPoints < uint32(Points.Num()) ? VEHICLESIM_FRAME_TRUNCATED : 0;
+    EndFrame(NumPoints * sizeof(VehicleSimLidarPoint), NumPoints, Vehicle ? Vehicle->GetUniqueID() : 0, Flags);
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs SharedMemoryStatsCommand(
+        TEXT("vehicle.SharedMemory.Stats"),
+        TEXT("Logs frames and bytes published to shared memory"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (const UVehicleSharedMemorySubsystem* SharedMemory = World ? World->GetSubsystem<UVehicleSharedMemorySubsystem>() : nullptr)
+            {
+                UE_LOG(LogTemp, Log, TEXT("VehicleSharedMemory: %llu frames, %.1f MB written, %llu truncated"),
+                    SharedMemory->GetNumFrames(), SharedMemory->GetBytesWritten() / (1024.0 * 1024.0), SharedMemory->GetNumTruncatedFrames());
+            }
+        }));
+}
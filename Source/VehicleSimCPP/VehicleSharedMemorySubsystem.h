@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleSharedMemoryFormat.h"
+#include "VehicleSharedMemorySubsystem.generated.h"
+
+struct FVehicleLidarPoint;
+
+// Publishes vehicle state every frame (and sensor data as it is produced) into a named
+// shared-memory ring for a local autonomy stack, enabled with -VehicleShm[=Name].
+// Frames are written in place with a per-slot sequence lock, so readers never block the
+// simulation and cost it nothing. VehicleSharedMemoryFormat.h is the consumer-side header.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleSharedMemorySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    void PublishLidarSweep(const AActor* Vehicle, TConstArrayView<FVehicleLidarPoint> Points);
+
+    uint64 GetNumFrames() const { return Sequence; }
+    uint64 GetBytesWritten() const { return BytesWritten; }
+    uint64 GetNumTruncatedFrames() const { return NumTruncated; }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    // Starts the next frame and returns its payload area, which holds up to OutCapacity bytes
+    uint8* BeginFrame(uint32 FrameType, uint32& OutCapacity);
+    void EndFrame(uint32 PayloadBytes, uint32 ItemCount, uint32 SourceId, uint32 Flags);
+
+    FPlatformMemory::FSharedMemoryRegion* Region = nullptr;
+    VehicleSimShmHeader* Header = nullptr;
+
+    uint32 SlotCount = 64;
+    uint32 SlotSize = 4 * 1024 * 1024;
+
+    VehicleSimSlotHeader* CurrentSlot = nullptr;
+    VehicleSimFrameHeader* CurrentFrame = nullptr;
+
+    uint64 Sequence = 0;
+    uint64 BytesWritten = 0;
+    uint64 NumTruncated = 0;
+};
@@ -3,4 +3,11 @@
 #include "VehicleSimCPP.h"
 #include "Modules/ModuleManager.h"
 
+LLM_DEFINE_TAG(VehicleSim);
+
+// Children of VehicleSim, so their allocations also roll up into it
+LLM_DEFINE_TAG(VehicleSim_Mesh, TEXT("VehicleSim/Mesh"), TEXT("VehicleSim"));
+LLM_DEFINE_TAG(VehicleSim_Telemetry, TEXT("VehicleSim/Telemetry"), TEXT("VehicleSim"));
+LLM_DEFINE_TAG(VehicleSim_Sensors, TEXT("VehicleSim/Sensors"), TEXT("VehicleSim"));
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, VehicleSimCPP, "VehicleSimCPP" );
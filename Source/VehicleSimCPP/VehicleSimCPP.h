@@ -4,3 +4,10 @@
 
 #include "CoreMinimal.h"
 
+#include "HAL/LowLevelMemTracker.h"
+
+// Low Level Memory tracker tags (run with -llm): vehicle meshes, telemetry recording and sensors
+LLM_DECLARE_TAG_API(VehicleSim, VEHICLESIMCPP_API);
+LLM_DECLARE_TAG_API(VehicleSim_Mesh, VEHICLESIMCPP_API);
+LLM_DECLARE_TAG_API(VehicleSim_Telemetry, VEHICLESIMCPP_API);
+LLM_DECLARE_TAG_API(VehicleSim_Sensors, VEHICLESIMCPP_API);
@@ -15,6 +15,8 @@
 #include "Engine/SkyLight.h"
 #include "Components/SkyLightComponent.h"
 #include "Components/LightComponent.h"
+#include "Engine/NetDriver.h"
+#include "Misc/CommandLine.h"
 
 AVehicleSimGameMode::AVehicleSimGameMode()
 {
@@ -39,8 +41,14 @@ void AVehicleSimGameMode::BeginPlay()
     
     UE_LOG(LogTemp, Warning, TEXT("VehicleSimGameMode: Super::BeginPlay() completed"));
 
+#if !UE_SERVER
     // Setup input axis mappings first (when InputSettings is fully initialized)
     SetupInputAxisMappings();
+#endif
+
+#if WITH_SERVER_CODE
+    ApplyServerTickRate();
+#endif
 
     // Create race track environment
     // CreateRaceTrack();  // Commented out to prevent crashes
@@ -149,6 +157,32 @@ void AVehicleSimGameMode::CheckPlayerPossession()
     }
 }
 
+#if WITH_SERVER_CODE
+void AVehicleSimGameMode::ApplyServerTickRate()
+{
+    if (GetNetMode() != NM_DedicatedServer)
+    {
+        return;
+    }
+
+    UNetDriver* NetDriver = GetWorld() ? GetWorld()->GetNetDriver() : nullptr;
+    if (!NetDriver)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleSimGameMode: No NetDriver to apply the server tick rate to!"));
+        return;
+    }
+
+    int32 TickRate = NetDriver->GetNetServerMaxTickRate();
+    if (FParse::Value(FCommandLine::Get(), TEXT("TickRate="), TickRate))
+    {
+        TickRate = FMath::Clamp(TickRate, 1, 240);
+        NetDriver->SetNetServerMaxTickRate(TickRate);
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("VehicleSimGameMode: Dedicated server ticking at %d Hz"), TickRate);
+}
+#endif
+
 void AVehicleSimGameMode::SetupInputAxisMappings()
 {
     UE_LOG(LogTemp, Warning, TEXT("VehicleSimGameMode: Setting up Input Axis Mappings"));
@@ -22,5 +22,8 @@ protected:
     // Function to setup input axis mappings programmatically
     void SetupInputAxisMappings();
 
+    // Dedicated server: apply -TickRate=N on top of NetServerMaxTickRate from DefaultEngine.ini
+    void ApplyServerTickRate();
+
 
 };
@@ -0,0 +1,140 @@
+#include "VehicleSnapshot.h"
+#include "VehicleBase.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace
+{
+    // Captured and restored with plain copies
+    static_assert(std::is_trivially_copyable_v<FVehicleSimState>, "FVehicleSimState must stay plain data");
+}
+
+bool UVehicleSnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVehicleSnapshotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    int32 SlotCount = 8;
+    if (GConfig)
+    {
+        int32 Value = 0;
+        if (GConfig->GetInt(TEXT("VehicleSim.Snapshot"), TEXT("SlotCount"), Value, GGameIni))
+        {
+            SlotCount = FMath::Clamp(Value, 1, 256);
+        }
+        if (GConfig->GetInt(TEXT("VehicleSim.Snapshot"), TEXT("MaxVehicles"), Value, GGameIni))
+        {
+            MaxVehicles = FMath::Clamp(Value, 1, 65536);
+        }
+    }
+
+    Slots.SetNum(SlotCount);
+    for (FSlot& Slot : Slots)
+    {
+        Slot.Vehicles.Reserve(MaxVehicles);
+    }
+    States.SetNum(SlotCount * MaxVehicles);
+}
+
+int32 UVehicleSnapshotSubsystem::Capture(int32 Slot)
+{
+    if (!Slots.IsValidIndex(Slot))
+    {
+        return INDEX_NONE;
+    }
+
+    FSlot& Target = Slots[Slot];
+    FVehicleSimState* SlotStates = GetSlotStates(Slot);
+    Target.Vehicles.Reset();
+
+    for (TActorIterator<AVehicleBase> It(GetWorld()); It; ++It)
+    {
+        if (Target.Vehicles.Num() == MaxVehicles)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("VehicleSnapshot: More than %d vehicles, the rest are not captured"), MaxVehicles);
+            break;
+        }
+
+        It->CaptureSimState(SlotStates[Target.Vehicles.Num()]);
+        Target.Vehicles.Add(*It);
+    }
+
+    Target.NumVehicles = Target.Vehicles.Num();
+    Target.Time = GetWorld()->GetTimeSeconds();
+    Target.bValid = true;
+    return Target.NumVehicles;
+}
+
+bool UVehicleSnapshotSubsystem::Restore(int32 Slot) const
+{
+    if (!IsValidSnapshot(Slot))
+    {
+        return false;
+    }
+
+    const FSlot& Source = Slots[Slot];
+    const FVehicleSimState* SlotStates = GetSlotStates(Slot);
+    for (int32 i = 0; i < Source.NumVehicles; i++)
+    {
+        if (AVehicleBase* Vehicle = Source.Vehicles[i].Get())
+        {
+            Vehicle->RestoreSimState(SlotStates[i]);
+        }
+    }
+    return true;
+}
+
+namespace
+{
+    FAutoConsoleCommandWithWorldAndArgs SnapshotSaveCommand(
+        TEXT("vehicle.Snapshot.Save"),
+        TEXT("Captures the simulation state: vehicle.Snapshot.Save [Slot]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            UVehicleSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UVehicleSnapshotSubsystem>() : nullptr;
+            if (!Snapshots)
+            {
+                return;
+            }
+
+            const int32 Slot = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+            const uint64 StartCycles = FPlatformTime::Cycles64();
+            const int32 NumVehicles = Snapshots->Capture(Slot);
+            const double Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+            if (NumVehicles == INDEX_NONE)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("VehicleSnapshot: Slot %d out of range (0-%d)"), Slot, Snapshots->GetSlotCount() - 1);
+                return;
+            }
+            UE_LOG(LogTemp, Log, TEXT("VehicleSnapshot: Captured %d vehicles into slot %d in %.3f ms"), NumVehicles, Slot, Milliseconds);
+        }));
+
+    FAutoConsoleCommandWithWorldAndArgs SnapshotRestoreCommand(
+        TEXT("vehicle.Snapshot.Restore"),
+        TEXT("Restores a captured simulation state: vehicle.Snapshot.Restore [Slot]"),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            const UVehicleSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UVehicleSnapshotSubsystem>() : nullptr;
+            if (!Snapshots)
+            {
+                return;
+            }
+
+            const int32 Slot = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+            const uint64 StartCycles = FPlatformTime::Cycles64();
+            if (!Snapshots->Restore(Slot))
+            {
+                UE_LOG(LogTemp, Warning, TEXT("VehicleSnapshot: No snapshot in slot %d"), Slot);
+                return;
+            }
+            UE_LOG(LogTemp, Log, TEXT("VehicleSnapshot: Restored slot %d (captured at %.2f s) in %.3f ms"),
+                Slot, Snapshots->GetSnapshotTime(Slot), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+        }));
+}
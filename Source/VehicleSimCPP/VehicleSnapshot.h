@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleBotInput.h"
+#include "VehicleSnapshot.generated.h"
+
+class AVehicleBase;
+
+// Everything that drives one vehicle's simulation, as plain data. Snapshots copy these into
+// preallocated storage, so capturing and restoring never allocate or go through reflection.
+struct FVehicleSimState
+{
+    static constexpr int32 MaxWheels = 4;
+
+    FVector Location = FVector::ZeroVector;
+    FQuat Rotation = FQuat::Identity;
+    FVector LinearVelocity = FVector::ZeroVector;
+    FVector AngularVelocity = FVector::ZeroVector;  // degrees per second
+    FVector LastTickLocation = FVector::ZeroVector;
+
+    float Throttle = 0.0f;
+    float Steering = 0.0f;
+    bool bBrake = false;
+
+    // Bot input generator including its random stream
+    FVehicleBotInputGenerator BotDriver;
+
+    uint16 NextMoveSequence = 1;
+    uint16 LastProcessedMove = 0;
+
+    struct FWheel
+    {
+        float RotationAngle = 0.0f;
+        float AngularVelocity = 0.0f;
+        float SuspensionOffset = 0.0f;
+    };
+    FWheel Wheels[MaxWheels];
+    int32 NumWheels = 0;
+    float WheelSpinDegrees = 0.0f;
+};
+
+// Holds a fixed number of full-simulation snapshots in memory for checkpoints and resets.
+// Storage for SlotCount x MaxVehicles states is allocated once; capture and restore are flat
+// copies. Configured in [VehicleSim.Snapshot]. vehicle.Snapshot.Save / Restore [Slot].
+UCLASS()
+class VEHICLESIMCPP_API UVehicleSnapshotSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+    // Returns the number of vehicles captured, or INDEX_NONE for an invalid slot
+    int32 Capture(int32 Slot);
+
+    // Puts every captured vehicle that still exists back into its captured state.
+    // Vehicles spawned after the capture are left alone.
+    bool Restore(int32 Slot) const;
+
+    bool IsValidSnapshot(int32 Slot) const { return Slots.IsValidIndex(Slot) && Slots[Slot].bValid; }
+    double GetSnapshotTime(int32 Slot) const { return Slots.IsValidIndex(Slot) ? Slots[Slot].Time : 0.0; }
+    int32 GetSlotCount() const { return Slots.Num(); }
+    int32 GetMaxVehicles() const { return MaxVehicles; }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    struct FSlot
+    {
+        double Time = 0.0;
+        int32 NumVehicles = 0;
+        bool bValid = false;
+        TArray<TWeakObjectPtr<AVehicleBase>> Vehicles;
+    };
+
+    FVehicleSimState* GetSlotStates(int32 Slot) { return States.GetData() + Slot * MaxVehicles; }
+    const FVehicleSimState* GetSlotStates(int32 Slot) const { return States.GetData() + Slot * MaxVehicles; }
+
+    int32 MaxVehicles = 256;
+    TArray<FSlot> Slots;
+
+    // All slots' states back to back, MaxVehicles per slot
+    TArray<FVehicleSimState> States;
+};
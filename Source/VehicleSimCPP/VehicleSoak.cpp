@@ -0,0 +1,230 @@
+#include "VehicleSoak.h"
+#include "VehicleBase.h"
+#include "VehiclePerfScenario.h"
+#include "VehicleSimCPP.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    void WriteLine(FArchive* File, const FString& Line)
+    {
+        if (!File)
+        {
+            return;
+        }
+
+        const FTCHARToUTF8 Utf8(*(Line + TEXT("\n")));
+        File->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+        File->Flush();
+    }
+}
+
+bool UVehicleSoakSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    float RequestedHours = 0.0f;
+    const bool bRequested = FParse::Param(FCommandLine::Get(), TEXT("VehicleSoak"))
+        || FParse::Value(FCommandLine::Get(), TEXT("VehicleSoak="), RequestedHours);
+    return bRequested && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UVehicleSoakSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game;
+}
+
+void UVehicleSoakSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (GConfig)
+    {
+        GConfig->GetFloat(TEXT("VehicleSim.Soak"), TEXT("Hours"), Hours, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.Soak"), TEXT("FleetSize"), FleetSize, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Soak"), TEXT("FleetSpacing"), FleetSpacing, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Soak"), TEXT("RaceDuration"), RaceDuration, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Soak"), TEXT("TeardownTime"), TeardownTime, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.Soak"), TEXT("SnapshotEveryRaces"), SnapshotEveryRaces, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.Soak"), TEXT("GrowthSnapshots"), GrowthSnapshots, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.Soak"), TEXT("MinGrowthMB"), MinGrowthMB, GGameIni);
+    }
+    FParse::Value(FCommandLine::Get(), TEXT("VehicleSoak="), Hours);
+    SnapshotEveryRaces = FMath::Max(1, SnapshotEveryRaces);
+    GrowthSnapshots = FMath::Max(2, GrowthSnapshots);
+
+    const FString Stamp = FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S"));
+    const FString Filename = FPaths::Combine(FPaths::ProfilingDir(), FString::Printf(TEXT("VehicleSoak-%s.csv"), *Stamp));
+    File = IFileManager::Get().CreateFileWriter(*Filename);
+    WriteLine(File, TEXT("Snapshot,Race,Hours,Tag,MB"));
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+    const bool bLLMEnabled = FLowLevelMemTracker::IsEnabled();
+#else
+    const bool bLLMEnabled = false;
+#endif
+    if (!bLLMEnabled)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleSoak: Low Level Memory tracker is off (run with -llm); only platform memory is recorded"));
+    }
+    UE_LOG(LogTemp, Log, TEXT("VehicleSoak: Racing %d vehicles for %.1f hours, snapshots in %s"), FleetSize, Hours, *Filename);
+}
+
+void UVehicleSoakSubsystem::Deinitialize()
+{
+    delete File;
+    File = nullptr;
+
+    Super::Deinitialize();
+}
+
+TStatId UVehicleSoakSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleSoakSubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleSoakSubsystem::StartRace()
+{
+    bRacing = true;
+    PhaseStartTime = FPlatformTime::Seconds();
+    UVehiclePerfScenarioSubsystem::SpawnFleet(GetWorld(), FleetSize, FleetSpacing, Fleet);
+}
+
+void UVehicleSoakSubsystem::TearDownRace()
+{
+    bRacing = false;
+    PhaseStartTime = FPlatformTime::Seconds();
+    NumRaces++;
+
+    for (const TWeakObjectPtr<AVehicleBase>& Vehicle : Fleet)
+    {
+        if (Vehicle.IsValid())
+        {
+            Vehicle->Destroy();
+        }
+    }
+    Fleet.Reset();
+
+    // Anything still allocated after a full purge outlived its race
+    GEngine->ForceGarbageCollection(true);
+}
+
+void UVehicleSoakSubsystem::TakeSnapshot()
+{
+    TMap<FName, double> AmountsMB;
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+    if (FLowLevelMemTracker::IsEnabled())
+    {
+        TMap<FName, uint64> Amounts;
+        FLowLevelMemTracker::Get().GetTrackedTagsNamesWithAmount(Amounts, ELLMTracker::Default, ELLMTagSet::None);
+        for (const TPair<FName, uint64>& Amount : Amounts)
+        {
+            AmountsMB.Add(Amount.Key, Amount.Value / (1024.0 * 1024.0));
+        }
+    }
+#endif
+    AmountsMB.Add(TEXT("PlatformUsedPhysical"), FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+
+    const double ElapsedHours = (FPlatformTime::Seconds() - SoakStartTime) / 3600.0;
+    for (const TPair<FName, double>& Amount : AmountsMB)
+    {
+        WriteLine(File, FString::Printf(TEXT("%d,%d,%.3f,%s,%.3f"), NumSnapshots, NumRaces, ElapsedHours, *Amount.Key.ToString(), Amount.Value));
+
+        FTagTrend* Trend = Trends.Find(Amount.Key);
+        if (!Trend)
+        {
+            Trends.Add(Amount.Key, FTagTrend{ Amount.Value, Amount.Value, Amount.Value, 0, false });
+            continue;
+        }
+
+        // Any snapshot that does not grow restarts the streak
+        if (Amount.Value > Trend->LastMB)
+        {
+            Trend->Streak++;
+        }
+        else
+        {
+            Trend->Streak = 0;
+            Trend->StreakStartMB = Amount.Value;
+        }
+        Trend->LastMB = Amount.Value;
+
+        const double GrowthMB = Amount.Value - Trend->StreakStartMB;
+        if (!Trend->bFlagged && Trend->Streak >= GrowthSnapshots - 1 && GrowthMB >= MinGrowthMB)
+        {
+            Trend->bFlagged = true;
+            UE_LOG(LogTemp, Warning, TEXT("VehicleSoak: %s grew for %d snapshots in a row (+%.2f MB, now %.2f MB) - possible leak"),
+                *Amount.Key.ToString(), Trend->Streak + 1, GrowthMB, Amount.Value);
+        }
+    }
+
+    NumSnapshots++;
+    UE_LOG(LogTemp, Log, TEXT("VehicleSoak: Snapshot %d after race %d (%.2f hours), %.1f MB used"),
+        NumSnapshots, NumRaces, ElapsedHours, AmountsMB.FindChecked(TEXT("PlatformUsedPhysical")));
+}
+
+void UVehicleSoakSubsystem::Finish()
+{
+    bFinished = true;
+
+    int32 NumFlagged = 0;
+    for (const TPair<FName, FTagTrend>& Trend : Trends)
+    {
+        if (Trend.Value.bFlagged)
+        {
+            NumFlagged++;
+            UE_LOG(LogTemp, Warning, TEXT("VehicleSoak: Leak suspect %s: %.2f MB -> %.2f MB"), *Trend.Key.ToString(), Trend.Value.FirstMB, Trend.Value.LastMB);
+        }
+    }
+    UE_LOG(LogTemp, Log, TEXT("VehicleSoak: %d races, %d snapshots, %d tags flagged"), NumRaces, NumSnapshots, NumFlagged);
+
+    FPlatformMisc::RequestExitWithStatus(false, NumFlagged > 0 ? 1 : 0);
+}
+
+void UVehicleSoakSubsystem::Tick(float DeltaTime)
+{
+    if (bFinished || !GetWorld()->HasBegunPlay())
+    {
+        return;
+    }
+    if (!bStarted)
+    {
+        bStarted = true;
+        SoakStartTime = FPlatformTime::Seconds();
+        StartRace();
+        return;
+    }
+
+    // Wall-clock phases, so a soak of N hours takes N hours whatever the frame rate
+    const double PhaseTime = FPlatformTime::Seconds() - PhaseStartTime;
+    if (bRacing)
+    {
+        if (PhaseTime >= RaceDuration)
+        {
+            TearDownRace();
+        }
+        return;
+    }
+
+    if (PhaseTime < TeardownTime)
+    {
+        return;
+    }
+    if (NumRaces % SnapshotEveryRaces == 0)
+    {
+        TakeSnapshot();
+    }
+    if (FPlatformTime::Seconds() - SoakStartTime >= Hours * 3600.0)
+    {
+        Finish();
+        return;
+    }
+    StartRace();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleSoak.generated.h"
+
+class AVehicleBase;
+
+// Memory soak test, enabled with -VehicleSoak[=Hours]. Loops races back to back: spawns the
+// fleet of scripted bots, lets it drive for RaceDuration, destroys it and collects garbage.
+// After every SnapshotEveryRaces races it records used memory per Low Level Memory tracker tag
+// (needs -llm; platform used physical memory is always recorded) to
+// Saved/Profiling/VehicleSoak-<Time>.csv. A tag that grows across GrowthSnapshots snapshots in
+// a row, by at least MinGrowthMB, is flagged as a leak. Settings are in [VehicleSim.Soak]; the
+// game exits with code 1 if any tag was flagged.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleSoakSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    // Growth streak of one tag over consecutive snapshots
+    struct FTagTrend
+    {
+        double FirstMB = 0.0;
+        double LastMB = 0.0;
+        double StreakStartMB = 0.0;
+        int32 Streak = 0;
+        bool bFlagged = false;
+    };
+
+    void StartRace();
+    void TearDownRace();
+    void TakeSnapshot();
+    void Finish();
+
+    float Hours = 4.0f;
+    int32 FleetSize = 50;
+    float FleetSpacing = 800.0f;
+    float RaceDuration = 120.0f;
+    float TeardownTime = 5.0f;
+    int32 SnapshotEveryRaces = 1;
+    int32 GrowthSnapshots = 6;
+    float MinGrowthMB = 1.0f;
+
+    FArchive* File = nullptr;
+    TArray<TWeakObjectPtr<AVehicleBase>> Fleet;
+    TMap<FName, FTagTrend> Trends;
+
+    double SoakStartTime = 0.0;
+    double PhaseStartTime = 0.0;
+    int32 NumRaces = 0;
+    int32 NumSnapshots = 0;
+    bool bStarted = false;
+    bool bRacing = false;
+    bool bFinished = false;
+};
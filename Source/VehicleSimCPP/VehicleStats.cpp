@@ -0,0 +1,44 @@
+#include "VehicleStats.h"
+
+FVehicleTimingSummary FVehicleTimingSummary::FromSamples(TArray<double>& Samples)
+{
+    FVehicleTimingSummary Summary;
+    Summary.Count = Samples.Num();
+    if (Samples.Num() == 0)
+    {
+        return Summary;
+    }
+
+    Samples.Sort();
+
+    double Sum = 0.0;
+    for (double Sample : Samples)
+    {
+        Sum += Sample;
+    }
+
+    Summary.Mean = Sum / Samples.Num();
+    Summary.Min = Samples[0];
+    Summary.Median = PercentileOfSorted(Samples, 50.0);
+    Summary.P90 = PercentileOfSorted(Samples, 90.0);
+    Summary.P95 = PercentileOfSorted(Samples, 95.0);
+    Summary.P99 = PercentileOfSorted(Samples, 99.0);
+    Summary.Max = Samples.Last();
+    return Summary;
+}
+
+double FVehicleTimingSummary::PercentileOfSorted(const TArray<double>& SortedSamples, double Percent)
+{
+    if (SortedSamples.Num() == 0)
+    {
+        return 0.0;
+    }
+
+    const int32 Rank = FMath::CeilToInt(Percent / 100.0 * SortedSamples.Num());
+    return SortedSamples[FMath::Clamp(Rank - 1, 0, SortedSamples.Num() - 1)];
+}
+
+FString FVehicleTimingSummary::ToString() const
+{
+    return FString::Printf(TEXT("n=%d mean=%.3f median=%.3f p95=%.3f p99=%.3f max=%.3f"), Count, Mean, Median, P95, P99, Max);
+}
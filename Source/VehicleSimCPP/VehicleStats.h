@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Order statistics for timing samples gathered by the profiling and load test tools
+struct VEHICLESIMCPP_API FVehicleTimingSummary
+{
+    int32 Count = 0;
+    double Mean = 0.0;
+    double Min = 0.0;
+    double Median = 0.0;
+    double P90 = 0.0;
+    double P95 = 0.0;
+    double P99 = 0.0;
+    double Max = 0.0;
+
+    // Sorts Samples in place
+    static FVehicleTimingSummary FromSamples(TArray<double>& Samples);
+
+    // Nearest-rank percentile of already sorted samples, Percent in [0, 100]
+    static double PercentileOfSorted(const TArray<double>& SortedSamples, double Percent);
+
+    FString ToString() const;
+};
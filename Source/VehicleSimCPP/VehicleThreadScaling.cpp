@@ -0,0 +1,237 @@
+#include "VehicleThreadScaling.h"
+#include "VehicleBase.h"
+#include "VehiclePerfScenario.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    const TCHAR* const WorkloadNames[] = { TEXT("Physics"), TEXT("Traffic"), TEXT("Sensors") };
+
+    // Vertical spread of the sensor fan, as on a typical 32 channel lidar
+    constexpr int32 SensorChannels = 32;
+    constexpr float SensorUpperFOV = 15.0f;
+    constexpr float SensorLowerFOV = -25.0f;
+}
+
+bool UVehicleThreadScalingSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    return FParse::Param(FCommandLine::Get(), TEXT("VehicleThreadScaling")) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UVehicleThreadScalingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game;
+}
+
+void UVehicleThreadScalingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (GConfig)
+    {
+        GConfig->GetInt(TEXT("VehicleSim.PerfScenario"), TEXT("FleetSize"), FleetSize, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.PerfScenario"), TEXT("FleetSpacing"), FleetSpacing, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.ThreadScaling"), TEXT("WarmupSteps"), WarmupSteps, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.ThreadScaling"), TEXT("Steps"), Steps, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.ThreadScaling"), TEXT("TrafficVehicles"), TrafficVehicles, GGameIni);
+        GConfig->GetInt(TEXT("VehicleSim.ThreadScaling"), TEXT("SensorRaysPerVehicle"), SensorRaysPerVehicle, GGameIni);
+        GConfig->GetFloat(TEXT("VehicleSim.ThreadScaling"), TEXT("SensorRange"), SensorRange, GGameIni);
+    }
+    Steps = FMath::Max(1, Steps);
+
+    TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UVehicleThreadScalingSubsystem::OnWorldTickStart);
+    PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UVehicleThreadScalingSubsystem::OnWorldPostActorTick);
+}
+
+void UVehicleThreadScalingSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+    FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+    Super::Deinitialize();
+}
+
+TStatId UVehicleThreadScalingSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UVehicleThreadScalingSubsystem, STATGROUP_Tickables);
+}
+
+void UVehicleThreadScalingSubsystem::Start()
+{
+    bStarted = true;
+    UVehiclePerfScenarioSubsystem::SpawnFleet(GetWorld(), FleetSize, FleetSpacing, Fleet);
+
+    // Same plausible mixed traffic as vehicle.Traffic.BenchmarkModel
+    FRandomStream Random(1234);
+    CarFollowing.SetNum(TrafficVehicles);
+    LaneChanges.SetNum(TrafficVehicles);
+    for (int32 i = 0; i < TrafficVehicles; i++)
+    {
+        CarFollowing.Gap[i] = Random.FRandRange(100.0f, 5000.0f);
+        CarFollowing.Speed[i] = Random.FRandRange(0.0f, 600.0f);
+        CarFollowing.LeaderSpeed[i] = Random.FRandRange(0.0f, 600.0f);
+        CarFollowing.DesiredSpeed[i] = Random.FRandRange(300.0f, 600.0f);
+        LaneChanges.Current[i] = Random.FRandRange(-500.0f, 300.0f);
+        LaneChanges.Target[i] = Random.FRandRange(-500.0f, 300.0f);
+        LaneChanges.NewFollowerBefore[i] = Random.FRandRange(-500.0f, 300.0f);
+        LaneChanges.NewFollowerAfter[i] = Random.FRandRange(-600.0f, 300.0f);
+        LaneChanges.OldFollowerBefore[i] = Random.FRandRange(-500.0f, 300.0f);
+        LaneChanges.OldFollowerAfter[i] = Random.FRandRange(-500.0f, 300.0f);
+    }
+
+    // Columns around the vehicle, channels spread over the vertical field of view
+    const int32 Columns = FMath::Max(1, SensorRaysPerVehicle / SensorChannels);
+    RayDirections.Reset(Columns * SensorChannels);
+    for (int32 Column = 0; Column < Columns; Column++)
+    {
+        for (int32 Channel = 0; Channel < SensorChannels; Channel++)
+        {
+            const float Pitch = FMath::Lerp(SensorLowerFOV, SensorUpperFOV, Channel / float(SensorChannels - 1));
+            RayDirections.Add(FRotator(Pitch, Column * 360.0f / Columns, 0.0f).Vector());
+        }
+    }
+    SensorHits.SetNumZeroed(Fleet.Num());
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleThreadScaling: %d vehicles, %d traffic cars, %d rays per vehicle, %d task graph workers"),
+        Fleet.Num(), TrafficVehicles, RayDirections.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads());
+}
+
+void UVehicleThreadScalingSubsystem::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World == GetWorld())
+    {
+        TickStartTime = FPlatformTime::Seconds();
+    }
+}
+
+void UVehicleThreadScalingSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+    // Every tick group, physics included, has run by now, and so have the tickable objects,
+    // this subsystem's traffic and sensor steps among them; take those back out
+    if (World == GetWorld() && bMeasureFrame)
+    {
+        WorkloadSeconds[Physics] += FPlatformTime::Seconds() - TickStartTime - FrameWorkloadSeconds;
+    }
+    bMeasureFrame = false;
+    FrameWorkloadSeconds = 0.0;
+}
+
+void UVehicleThreadScalingSubsystem::RunTraffic()
+{
+    const FVehicleIDMParams IDMParams;
+    const FVehicleMOBILParams MOBILParams;
+    VehicleTrafficModel::ComputeIDMParallel(IDMParams, CarFollowing);
+    VehicleTrafficModel::ComputeMOBILParallel(MOBILParams, LaneChanges);
+}
+
+void UVehicleThreadScalingSubsystem::RunSensors()
+{
+    // Transforms are read on the game thread; the traces only read the physics scene
+    TArray<FTransform, TInlineAllocator<256>> Transforms;
+    TArray<const AActor*, TInlineAllocator<256>> Vehicles;
+    for (const TWeakObjectPtr<AVehicleBase>& Vehicle : Fleet)
+    {
+        if (Vehicle.IsValid())
+        {
+            Transforms.Add(Vehicle->GetActorTransform());
+            Vehicles.Add(Vehicle.Get());
+        }
+    }
+
+    const UWorld* World = GetWorld();
+    ParallelFor(Transforms.Num(), [this, World, &Transforms, &Vehicles](int32 i)
+    {
+        const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(VehicleThreadScaling), false, Vehicles[i]);
+        const FVector Origin = Transforms[i].TransformPosition(FVector(0.0f, 0.0f, 150.0f));
+        int32 Hits = 0;
+        FHitResult Hit;
+        for (const FVector& Direction : RayDirections)
+        {
+            const FVector End = Origin + Transforms[i].TransformVectorNoScale(Direction) * SensorRange;
+            Hits += World->LineTraceSingleByChannel(Hit, Origin, End, ECC_Visibility, QueryParams) ? 1 : 0;
+        }
+        SensorHits[i] = Hits;
+    });
+}
+
+void UVehicleThreadScalingSubsystem::Tick(float DeltaTime)
+{
+    if (bFinished || !GetWorld()->HasBegunPlay())
+    {
+        return;
+    }
+    if (!bStarted)
+    {
+        Start();
+        return;
+    }
+
+    const bool bMeasure = StepIndex >= WarmupSteps;
+    if (StepIndex == WarmupSteps)
+    {
+        MeasureStartTime = FPlatformTime::Seconds();
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    RunTraffic();
+    const double TrafficTime = FPlatformTime::Seconds();
+    RunSensors();
+    const double SensorTime = FPlatformTime::Seconds();
+    FrameWorkloadSeconds = SensorTime - StartTime;
+    bMeasureFrame = bMeasure;
+    if (bMeasure)
+    {
+        WorkloadSeconds[Traffic] += TrafficTime - StartTime;
+        WorkloadSeconds[Sensors] += SensorTime - TrafficTime;
+    }
+
+    if (++StepIndex >= WarmupSteps + Steps)
+    {
+        bFinished = true;
+        WriteResults();
+        FPlatformMisc::RequestExit(false);
+    }
+}
+
+void UVehicleThreadScalingSubsystem::WriteResults()
+{
+    // The requested core limit, or all cores when the run was not limited
+    int32 Threads = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+    FParse::Value(FCommandLine::Get(), TEXT("corelimit="), Threads);
+    const int32 Workers = FTaskGraphInterface::Get().GetNumWorkerThreads();
+    const double WallSeconds = FPlatformTime::Seconds() - MeasureStartTime;
+
+    const FString Filename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("VehicleThreadScaling.csv"));
+    FString Rows;
+    if (!IFileManager::Get().FileExists(*Filename))
+    {
+        Rows = TEXT("Threads,Workers,Workload,Steps,Seconds,StepsPerSecond\n");
+    }
+
+    auto AddRow = [&](const TCHAR* Workload, double Seconds)
+    {
+        const double StepsPerSecond = Steps / FMath::Max(Seconds, UE_DOUBLE_SMALL_NUMBER);
+        Rows += FString::Printf(TEXT("%d,%d,%s,%d,%.6f,%.3f\n"), Threads, Workers, Workload, Steps, Seconds, StepsPerSecond);
+        UE_LOG(LogTemp, Log, TEXT("VehicleThreadScaling: %-8s %10.1f steps/s (%d threads, %d workers)"), Workload, StepsPerSecond, Threads, Workers);
+    };
+    for (int32 Workload = 0; Workload < NumWorkloads; Workload++)
+    {
+        AddRow(WorkloadNames[Workload], WorkloadSeconds[Workload]);
+    }
+    AddRow(TEXT("Frame"), WallSeconds);
+
+    if (!FFileHelper::SaveStringToFile(Rows, *Filename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleThreadScaling: Could not write %s"), *Filename);
+    }
+}
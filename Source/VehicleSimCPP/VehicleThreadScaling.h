@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VehicleTrafficModel.h"
+#include "VehicleThreadScaling.generated.h"
+
+class AVehicleBase;
+
+// Thread-scaling benchmark, enabled with -VehicleThreadScaling. Spawns the perf scenario's fleet
+// ([VehicleSim.PerfScenario]) and times a fixed number of steps of each workload:
+//
+//   Physics   the world's actor and physics tick with the fleet driving
+//   Traffic   the parallel IDM and MOBIL kernels over a synthetic batch of background cars
+//   Sensors   a lidar-like fan of line traces from every fleet vehicle, spread with ParallelFor
+//
+// Results go to Saved/Benchmarks/VehicleThreadScaling.csv, one row per workload plus one for
+// the whole frame, before the game quits. Scripts/RunThreadScaling.sh repeats the run with
+// -corelimit=1..N and turns the rows into speedup and efficiency per workload.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleThreadScalingSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    enum EWorkload : int32
+    {
+        Physics,
+        Traffic,
+        Sensors,
+        NumWorkloads
+    };
+
+    void Start();
+    void RunTraffic();
+    void RunSensors();
+    void WriteResults();
+
+    void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+    void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+    int32 FleetSize = 100;
+    float FleetSpacing = 800.0f;
+    int32 WarmupSteps = 60;
+    int32 Steps = 600;
+    int32 TrafficVehicles = 100000;
+    int32 SensorRaysPerVehicle = 1024;
+    float SensorRange = 10000.0f;
+
+    TArray<TWeakObjectPtr<AVehicleBase>> Fleet;
+    FVehicleIDMBatch CarFollowing;
+    FVehicleMOBILBatch LaneChanges;
+    TArray<FVector> RayDirections;
+    TArray<int32> SensorHits;
+
+    double WorkloadSeconds[NumWorkloads] = {};
+    double TickStartTime = 0.0;
+    double FrameWorkloadSeconds = 0.0;      // traffic and sensors, which run inside the world tick
+    bool bMeasureFrame = false;
+    double MeasureStartTime = 0.0;
+    int32 StepIndex = 0;
+    bool bStarted = false;
+    bool bFinished = false;
+
+    FDelegateHandle TickStartHandle;
+    FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,413 @@
+#include "VehicleTrafficManager.h"
+#include "VehicleBase.h"
+#include "VehicleProximitySubsystem.h"
+#include "VehicleTrafficProcessors.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutionContext.h"
+#include "MassExecutor.h"
+#include "MassProcessingTypes.h"
+#include "UObject/ConstructorHelpers.h"
+
+namespace
+{
+    // Scale for the 100 unit engine cube to roughly match a car
+    const FVector TrafficInstanceScale(4.5f, 2.0f, 1.5f);
+
+    // How far ahead along the lane a promoted car aims when steering
+    constexpr float PromotedLookAhead = 1000.0f;
+
+    // Distance along a ring lane for a world location (projects onto the lane)
+    float GetLaneDistanceAt(const FVehicleTrafficLane& Lane, const FVector& Location)
+    {
+        const float Angle = FMath::Atan2(Location.Y - Lane.Center.Y, Location.X - Lane.Center.X);
+        return FMath::Fmod(Lane.Direction * Angle * Lane.Radius + Lane.GetLength(), Lane.GetLength());
+    }
+
+    FVector GetLaneLocationAt(const FVehicleTrafficLane& Lane, float Distance)
+    {
+        const float Angle = Lane.Direction * Distance / Lane.Radius;
+        return FVector(Lane.Center) + FVector(FMath::Cos(Angle) * Lane.Radius, FMath::Sin(Angle) * Lane.Radius, 0.0f);
+    }
+}
+
+AVehicleTrafficManager::AVehicleTrafficManager()
+{
+    PrimaryActorTick.bCanEverTick = true;
+
+    TrafficInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("TrafficInstances"));
+    RootComponent = TrafficInstances;
+    TrafficInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    TrafficInstances->SetCastShadow(false);
+    TrafficInstances->SetMobility(EComponentMobility::Movable);
+
+    static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMesh(TEXT("/Engine/BasicShapes/Cube.Cube"));
+    if (CubeMesh.Succeeded())
+    {
+        TrafficInstances->SetStaticMesh(CubeMesh.Object);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleTrafficManager: Failed to load traffic mesh"));
+    }
+
+    // Cars that are still instanced and could be promoted
+    PromotionQuery.AddRequirement<FVehicleTrafficTransformFragment>(EMassFragmentAccess::ReadOnly);
+    PromotionQuery.AddTagRequirement<FVehicleTrafficPromotedTag>(EMassFragmentPresence::None);
+}
+
+FMassEntityManager* AVehicleTrafficManager::GetEntityManager() const
+{
+    UMassEntitySubsystem* EntitySubsystem = GetWorld() ? GetWorld()->GetSubsystem<UMassEntitySubsystem>() : nullptr;
+    return EntitySubsystem ? &EntitySubsystem->GetMutableEntityManager() : nullptr;
+}
+
+void AVehicleTrafficManager::BeginPlay()
+{
+    Super::BeginPlay();
+
+    FMassEntityManager* EntityManager = GetEntityManager();
+    if (!EntityManager)
+    {
+        UE_LOG(LogTemp, Error, TEXT("VehicleTrafficManager: No Mass entity subsystem - traffic disabled"));
+        SetActorTickEnabled(false);
+        return;
+    }
+
+    BuildLanes();
+
+    MovementProcessor = NewObject<UVehicleTrafficMovementProcessor>(this);
+    MovementProcessor->Initialize(*this);
+    MovementProcessor->InstanceScale = TrafficInstanceScale;
+
+    SpawnTrafficEntities(*EntityManager);
+
+    // Instanced cars show up in proximity queries with their instance index; promoted ones
+    // are hidden here and register themselves as actors instead
+    if (UVehicleProximitySubsystem* Proximity = GetWorld()->GetSubsystem<UVehicleProximitySubsystem>())
+    {
+        Proximity->AddSource(this, [this](FVehicleProximityAddItem AddItem)
+        {
+            for (int32 i = 0; i < InstanceTransforms.Num(); i++)
+            {
+                if (!InstanceTransforms[i].GetScale3D().IsNearlyZero())
+                {
+                    AddItem(InstanceTransforms[i].GetLocation(), i);
+                }
+            }
+        });
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("VehicleTrafficManager: Spawned %d traffic vehicles on %d lanes"), Entities.Num(), Lanes.Num());
+}
+
+void AVehicleTrafficManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UVehicleProximitySubsystem* Proximity = GetWorld() ? GetWorld()->GetSubsystem<UVehicleProximitySubsystem>() : nullptr)
+    {
+        Proximity->RemoveSource(this);
+    }
+
+    for (const TPair<FMassEntityHandle, TWeakObjectPtr<AVehicleBase>>& Promoted : PromotedVehicles)
+    {
+        if (AVehicleBase* Vehicle = Promoted.Value.Get())
+        {
+            Vehicle->Destroy();
+        }
+    }
+    PromotedVehicles.Reset();
+
+    if (FMassEntityManager* EntityManager = GetEntityManager())
+    {
+        EntityManager->BatchDestroyEntities(Entities);
+    }
+    Entities.Reset();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AVehicleTrafficManager::BuildLanes()
+{
+    Lanes.Reset(NumLanes);
+    const FVector3f Center(GetActorLocation());
+    for (int32 LaneIndex = 0; LaneIndex < NumLanes; LaneIndex++)
+    {
+        FVehicleTrafficLane& Lane = Lanes.AddDefaulted_GetRef();
+        Lane.Center = Center;
+        Lane.Radius = InnerLaneRadius + LaneIndex * LaneSpacing;
+        Lane.Direction = (LaneIndex % 2 == 0) ? 1.0f : -1.0f;
+    }
+}
+
+void AVehicleTrafficManager::SpawnTrafficEntities(FMassEntityManager& EntityManager)
+{
+    if (NumVehicles <= 0 || Lanes.Num() == 0)
+    {
+        return;
+    }
+
+    const FMassArchetypeHandle Archetype = EntityManager.CreateArchetype({
+        FVehicleTrafficTransformFragment::StaticStruct(),
+        FVehicleTrafficMotionFragment::StaticStruct(),
+        FVehicleTrafficInstanceFragment::StaticStruct()
+    });
+
+    Entities.Reset(NumVehicles);
+    EntityManager.BatchCreateEntities(Archetype, NumVehicles, Entities);
+
+    FRandomStream Random(GetUniqueID());
+    const int32 VehiclesPerLane = FMath::DivideAndRoundUp(NumVehicles, Lanes.Num());
+    InstanceTransforms.SetNum(Entities.Num());
+    CarFollowing.SetNum(Entities.Num());
+    LaneDistances.SetNumZeroed(Entities.Num());
+    LaneOrders.Reset();
+    LaneOrders.SetNum(Lanes.Num());
+
+    for (int32 i = 0; i < Entities.Num(); i++)
+    {
+        const int32 LaneIndex = i % Lanes.Num();
+        const FVehicleTrafficLane& Lane = Lanes[LaneIndex];
+
+        FVehicleTrafficMotionFragment& Motion = EntityManager.GetFragmentDataChecked<FVehicleTrafficMotionFragment>(Entities[i]);
+        Motion.LaneIndex = LaneIndex;
+        Motion.LaneDistance = (i / Lanes.Num()) * Lane.GetLength() / VehiclesPerLane;
+        Motion.Speed = Random.FRandRange(MinSpeed, MaxSpeed);
+
+        // Cars are added front to back, so each lane's order starts out sorted
+        CarFollowing.DesiredSpeed[i] = Motion.Speed;
+        CarFollowing.Speed[i] = Motion.Speed;
+        LaneDistances[i] = Motion.LaneDistance;
+        LaneOrders[LaneIndex].Add(i);
+
+        const FVector Location = GetLaneLocationAt(Lane, Motion.LaneDistance);
+        FVehicleTrafficTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FVehicleTrafficTransformFragment>(Entities[i]);
+        Transform.Location = FVector3f(Location);
+
+        EntityManager.GetFragmentDataChecked<FVehicleTrafficInstanceFragment>(Entities[i]).InstanceIndex = i;
+        InstanceTransforms[i] = FTransform(FQuat::Identity, Location, TrafficInstanceScale);
+    }
+
+    TrafficInstances->ClearInstances();
+    TrafficInstances->AddInstances(InstanceTransforms, false, true);
+
+    UpdateCarFollowing();
+}
+
+void AVehicleTrafficManager::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    FMassEntityManager* EntityManager = GetEntityManager();
+    if (!EntityManager || !MovementProcessor || Entities.Num() == 0)
+    {
+        return;
+    }
+
+    // Move all background cars in one parallel pass over the entity chunks
+    MovementProcessor->Lanes = Lanes;
+    MovementProcessor->InstanceTransforms = InstanceTransforms;
+    MovementProcessor->Accelerations = CarFollowing.Acceleration;
+    MovementProcessor->Speeds = CarFollowing.Speed;
+    MovementProcessor->LaneDistances = LaneDistances;
+
+    FMassProcessingContext ProcessingContext(*EntityManager, DeltaTime);
+    UE::Mass::Executor::Run(*MovementProcessor, ProcessingContext);
+
+    TimeUntilPromotionCheck -= DeltaTime;
+    if (TimeUntilPromotionCheck <= 0.0f)
+    {
+        TimeUntilPromotionCheck = PromotionCheckInterval;
+        UpdatePromotion(*EntityManager);
+    }
+
+    DrivePromotedVehicles(*EntityManager, DeltaTime);
+
+    // Accelerations for the next frame
+    UpdateCarFollowing();
+
+    TrafficInstances->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true);
+}
+
+void AVehicleTrafficManager::UpdatePromotion(FMassEntityManager& EntityManager)
+{
+    // Every player's pawn (several on a listen or dedicated server)
+    TArray<FVector, TInlineAllocator<8>> ViewerLocations;
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PC = It->Get();
+        if (PC && PC->GetPawn())
+        {
+            ViewerLocations.Add(PC->GetPawn()->GetActorLocation());
+        }
+    }
+
+    auto DistanceSquaredToViewers = [&ViewerLocations](const FVector& Location)
+    {
+        float Closest = TNumericLimits<float>::Max();
+        for (const FVector& Viewer : ViewerLocations)
+        {
+            Closest = FMath::Min(Closest, static_cast<float>(FVector::DistSquared2D(Viewer, Location)));
+        }
+        return Closest;
+    };
+
+    // Demote cars that fell behind or were destroyed
+    TArray<TPair<FMassEntityHandle, AVehicleBase*>, TInlineAllocator<16>> ToDemote;
+    for (const TPair<FMassEntityHandle, TWeakObjectPtr<AVehicleBase>>& Promoted : PromotedVehicles)
+    {
+        AVehicleBase* Vehicle = Promoted.Value.Get();
+        if (!Vehicle || DistanceSquaredToViewers(Vehicle->GetActorLocation()) > FMath::Square(DemoteRadius))
+        {
+            ToDemote.Emplace(Promoted.Key, Vehicle);
+        }
+    }
+    for (const TPair<FMassEntityHandle, AVehicleBase*>& Demoted : ToDemote)
+    {
+        DemoteEntity(EntityManager, Demoted.Key, Demoted.Value);
+    }
+
+    const int32 FreeSlots = MaxPromotedVehicles - PromotedVehicles.Num();
+    if (FreeSlots <= 0 || ViewerLocations.Num() == 0)
+    {
+        return;
+    }
+
+    // Find the closest instanced cars inside the promote radius
+    TArray<TPair<float, FMassEntityHandle>> Candidates;
+    const float PromoteRadiusSquared = FMath::Square(PromoteRadius);
+    FMassExecutionContext ExecutionContext(EntityManager, 0.0f);
+    PromotionQuery.ForEachEntityChunk(EntityManager, ExecutionContext, [&](FMassExecutionContext& ChunkContext)
+    {
+        const TConstArrayView<FVehicleTrafficTransformFragment> Transforms = ChunkContext.GetFragmentView<FVehicleTrafficTransformFragment>();
+        for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); EntityIndex++)
+        {
+            const float DistanceSquared = DistanceSquaredToViewers(FVector(Transforms[EntityIndex].Location));
+            if (DistanceSquared < PromoteRadiusSquared)
+            {
+                Candidates.Emplace(DistanceSquared, ChunkContext.GetEntity(EntityIndex));
+            }
+        }
+    });
+
+    Candidates.Sort([](const TPair<float, FMassEntityHandle>& A, const TPair<float, FMassEntityHandle>& B) { return A.Key < B.Key; });
+    for (int32 i = 0; i < FMath::Min(FreeSlots, Candidates.Num()); i++)
+    {
+        PromoteEntity(EntityManager, Candidates[i].Value);
+    }
+}
+
+void AVehicleTrafficManager::PromoteEntity(FMassEntityManager& EntityManager, FMassEntityHandle Entity)
+{
+    const FVehicleTrafficTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FVehicleTrafficTransformFragment>(Entity);
+    const FTransform SpawnTransform(FRotator(0.0f, Transform.Yaw, 0.0f), FVector(Transform.Location));
+
+    AVehicleBase* Vehicle = GetWorld()->SpawnActorDeferred<AVehicleBase>(AVehicleBase::StaticClass(), SpawnTransform, this, nullptr,
+        ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+    if (!Vehicle)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("VehicleTrafficManager: Failed to spawn promoted vehicle"));
+        return;
+    }
+    Vehicle->bAutoPossessFirstPlayer = false;
+    Vehicle->FinishSpawning(SpawnTransform);
+
+    // Hide the instance; the movement pass skips promoted cars so it stays hidden
+    const int32 InstanceIndex = EntityManager.GetFragmentDataChecked<FVehicleTrafficInstanceFragment>(Entity).InstanceIndex;
+    InstanceTransforms[InstanceIndex].SetScale3D(FVector::ZeroVector);
+
+    EntityManager.AddTagToEntity(Entity, FVehicleTrafficPromotedTag::StaticStruct());
+    PromotedVehicles.Add(Entity, Vehicle);
+}
+
+void AVehicleTrafficManager::DemoteEntity(FMassEntityManager& EntityManager, FMassEntityHandle Entity, AVehicleBase* Vehicle)
+{
+    PromotedVehicles.Remove(Entity);
+    if (!EntityManager.IsEntityValid(Entity))
+    {
+        return;
+    }
+
+    // Put the car back on its lane where the actor left off
+    const int32 InstanceIndex = EntityManager.GetFragmentDataChecked<FVehicleTrafficInstanceFragment>(Entity).InstanceIndex;
+    FVehicleTrafficMotionFragment& Motion = EntityManager.GetFragmentDataChecked<FVehicleTrafficMotionFragment>(Entity);
+    Motion.LaneDistance = LaneDistances[InstanceIndex];
+    Motion.Speed = CarFollowing.Speed[InstanceIndex];
+    if (Vehicle)
+    {
+        Vehicle->Destroy();
+    }
+
+    EntityManager.RemoveTagFromEntity(Entity, FVehicleTrafficPromotedTag::StaticStruct());
+}
+
+void AVehicleTrafficManager::DrivePromotedVehicles(FMassEntityManager& EntityManager, float DeltaTime)
+{
+    for (const TPair<FMassEntityHandle, TWeakObjectPtr<AVehicleBase>>& Promoted : PromotedVehicles)
+    {
+        AVehicleBase* Vehicle = Promoted.Value.Get();
+        if (!Vehicle || !EntityManager.IsEntityValid(Promoted.Key))
+        {
+            continue;
+        }
+
+        // Follow the car-following model's speed and steer towards a point a little further along the lane.
+        // The actor's lane position feeds back into the model so instanced cars queue behind it.
+        const FVehicleTrafficMotionFragment& Motion = EntityManager.GetFragmentDataChecked<FVehicleTrafficMotionFragment>(Promoted.Key);
+        const int32 InstanceIndex = EntityManager.GetFragmentDataChecked<FVehicleTrafficInstanceFragment>(Promoted.Key).InstanceIndex;
+        const FVehicleTrafficLane& Lane = Lanes[Motion.LaneIndex];
+        const FVector Location = Vehicle->GetActorLocation();
+
+        float& Speed = CarFollowing.Speed[InstanceIndex];
+        Speed = FMath::Clamp(Speed + CarFollowing.Acceleration[InstanceIndex] * DeltaTime, 0.0f, AVehicleBase::MaxForwardSpeed);
+        LaneDistances[InstanceIndex] = GetLaneDistanceAt(Lane, Location);
+
+        const FVector AimPoint = GetLaneLocationAt(Lane, LaneDistances[InstanceIndex] + PromotedLookAhead);
+
+        const FVector LocalAim = Vehicle->GetActorTransform().InverseTransformPositionNoScale(AimPoint);
+        const float HeadingError = FMath::RadiansToDegrees(FMath::Atan2(LocalAim.Y, LocalAim.X));
+
+        const float Throttle = Speed / AVehicleBase::MaxForwardSpeed;
+        const float Steering = FMath::Clamp(HeadingError / 30.0f, -1.0f, 1.0f);
+        Vehicle->SetDriverInput(Throttle, Steering, false);
+    }
+}
+
+void AVehicleTrafficManager::UpdateCarFollowing()
+{
+    // Each car follows the next one along its ring lane. Cars rarely pass each other, so an
+    // insertion sort keeps the lane orders sorted in about linear time.
+    ParallelFor(LaneOrders.Num(), [this](int32 LaneIndex)
+    {
+        TArray<int32>& Order = LaneOrders[LaneIndex];
+        for (int32 i = 1; i < Order.Num(); i++)
+        {
+            const int32 Car = Order[i];
+            int32 j = i - 1;
+            for (; j >= 0 && LaneDistances[Order[j]] > LaneDistances[Car]; j--)
+            {
+                Order[j + 1] = Order[j];
+            }
+            Order[j + 1] = Car;
+        }
+
+        const float LaneLength = Lanes[LaneIndex].GetLength();
+        for (int32 i = 0; i < Order.Num(); i++)
+        {
+            const int32 Car = Order[i];
+            const int32 Leader = Order[(i + 1) % Order.Num()];
+            float Distance = LaneDistances[Leader] - LaneDistances[Car];
+            if (Distance <= 0.0f)
+            {
+                Distance += LaneLength; // leader is past the lane's start point (or the car is alone)
+            }
+            CarFollowing.Gap[Car] = Distance - CarFollowingParams.VehicleLength;
+            CarFollowing.LeaderSpeed[Car] = CarFollowing.Speed[Leader];
+        }
+    });
+
+    VehicleTrafficModel::ComputeIDMParallel(CarFollowingParams, CarFollowing);
+}
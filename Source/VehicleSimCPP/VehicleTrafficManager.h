@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "MassEntityTypes.h"
+#include "MassEntityQuery.h"
+#include "VehicleTrafficModel.h"
+#include "VehicleTrafficTypes.h"
+#include "VehicleTrafficManager.generated.h"
+
+class AVehicleBase;
+class UInstancedStaticMeshComponent;
+class UVehicleTrafficMovementProcessor;
+struct FMassEntityManager;
+
+// Spawns and runs thousands of lightweight background cars as Mass entities.
+// Cars are drawn through a single instanced mesh and only become full AVehicleBase actors
+// while they are close to the player.
+UCLASS()
+class VEHICLESIMCPP_API AVehicleTrafficManager : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AVehicleTrafficManager();
+
+    virtual void Tick(float DeltaTime) override;
+
+    int32 GetNumTrafficVehicles() const { return Entities.Num(); }
+    int32 GetNumPromotedVehicles() const { return PromotedVehicles.Num(); }
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Traffic")
+    UInstancedStaticMeshComponent* TrafficInstances;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic")
+    int32 NumVehicles = 10000;
+
+    // Background cars drive on concentric ring lanes around the manager
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic")
+    int32 NumLanes = 60;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic")
+    float InnerLaneRadius = 30000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic")
+    float LaneSpacing = 400.0f;
+
+    // Range of desired speeds, kept within AVehicleBase::MaxForwardSpeed so promoted cars can keep up
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic")
+    float MinSpeed = 300.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic")
+    float MaxSpeed = 500.0f;
+
+    // Cars closer than this to the player become full vehicles...
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic|Promotion")
+    float PromoteRadius = 5000.0f;
+
+    // ...and turn back into instances beyond this distance
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic|Promotion")
+    float DemoteRadius = 7000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic|Promotion")
+    int32 MaxPromotedVehicles = 16;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Traffic|Promotion")
+    float PromotionCheckInterval = 0.25f;
+
+private:
+    void BuildLanes();
+    void SpawnTrafficEntities(FMassEntityManager& EntityManager);
+    void UpdatePromotion(FMassEntityManager& EntityManager);
+    void PromoteEntity(FMassEntityManager& EntityManager, FMassEntityHandle Entity);
+    void DemoteEntity(FMassEntityManager& EntityManager, FMassEntityHandle Entity, AVehicleBase* Vehicle);
+    void DrivePromotedVehicles(FMassEntityManager& EntityManager, float DeltaTime);
+    void UpdateCarFollowing();
+    FMassEntityManager* GetEntityManager() const;
+
+    UPROPERTY()
+    UVehicleTrafficMovementProcessor* MovementProcessor;
+
+    TArray<FVehicleTrafficLane> Lanes;
+    TArray<FMassEntityHandle> Entities;
+    TArray<FTransform> InstanceTransforms;
+
+    // Car-following model inputs/outputs and lane distances, indexed by instance
+    FVehicleIDMParams CarFollowingParams;
+    FVehicleIDMBatch CarFollowing;
+    TArray<float> LaneDistances;
+
+    // Instance indices on each lane, sorted by lane distance
+    TArray<TArray<int32>> LaneOrders;
+    TMap<FMassEntityHandle, TWeakObjectPtr<AVehicleBase>> PromotedVehicles;
+
+    FMassEntityQuery PromotionQuery;
+    float TimeUntilPromotionCheck = 0.0f;
+};
@@ -0,0 +1,281 @@
+#include "VehicleTrafficModel.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Math/VectorRegister.h"
+
+void FVehicleIDMBatch::SetNum(int32 NumVehicles)
+{
+    Gap.SetNumZeroed(NumVehicles);
+    Speed.SetNumZeroed(NumVehicles);
+    LeaderSpeed.SetNumZeroed(NumVehicles);
+    DesiredSpeed.SetNumZeroed(NumVehicles);
+    Acceleration.SetNumZeroed(NumVehicles);
+}
+
+void FVehicleMOBILBatch::SetNum(int32 NumCandidates)
+{
+    Current.SetNumZeroed(NumCandidates);
+    Target.SetNumZeroed(NumCandidates);
+    NewFollowerBefore.SetNumZeroed(NumCandidates);
+    NewFollowerAfter.SetNumZeroed(NumCandidates);
+    OldFollowerBefore.SetNumZeroed(NumCandidates);
+    OldFollowerAfter.SetNumZeroed(NumCandidates);
+    Incentive.SetNumZeroed(NumCandidates);
+}
+
+namespace
+{
+    // Gaps and desired speeds are clamped to these to keep the divisions finite
+    constexpr float MinModelGap = 1.0f;
+    constexpr float MinDesiredSpeed = 1.0f;
+
+    float ComputeIDMOne(const FVehicleIDMParams& Params, float InvTwoSqrtAB, float Gap, float Speed, float LeaderSpeed, float DesiredSpeed)
+    {
+        // a * (1 - (v / v0)^4 - (s* / s)^2), s* = s0 + max(0, v T + v dv / (2 sqrt(a b)))
+        const float Approach = Speed - LeaderSpeed;
+        const float DynamicGap = FMath::Max(0.0f, Speed * Params.DesiredTimeGap + Speed * Approach * InvTwoSqrtAB);
+        const float DesiredGap = Params.MinGap + DynamicGap;
+
+        const float SpeedRatio = Speed / FMath::Max(DesiredSpeed, MinDesiredSpeed);
+        const float SpeedRatio2 = SpeedRatio * SpeedRatio;
+        const float GapRatio = DesiredGap / FMath::Max(Gap, MinModelGap);
+
+        const float Acceleration = Params.MaxAcceleration * (1.0f - SpeedRatio2 * SpeedRatio2 - GapRatio * GapRatio);
+        return FMath::Max(Acceleration, -Params.MaxDeceleration);
+    }
+
+    float GetInvTwoSqrtAB(const FVehicleIDMParams& Params)
+    {
+        return 1.0f / (2.0f * FMath::Sqrt(FMath::Max(Params.MaxAcceleration * Params.ComfortDeceleration, UE_SMALL_NUMBER)));
+    }
+
+    template<typename KernelType>
+    void RunParallel(int32 Num, int32 ChunkSize, KernelType Kernel)
+    {
+        ChunkSize = FMath::Max(ChunkSize, 4);
+        const int32 NumChunks = FMath::DivideAndRoundUp(Num, ChunkSize);
+        ParallelFor(NumChunks, [&](int32 ChunkIndex)
+        {
+            const int32 Start = ChunkIndex * ChunkSize;
+            Kernel(Start, FMath::Min(ChunkSize, Num - Start));
+        });
+    }
+}
+
+void VehicleTrafficModel::ComputeIDMScalar(const FVehicleIDMParams& Params, FVehicleIDMBatch& Batch, int32 Start, int32 Count)
+{
+    const float InvTwoSqrtAB = GetInvTwoSqrtAB(Params);
+    for (int32 i = Start; i < Start + Count; i++)
+    {
+        Batch.Acceleration[i] = ComputeIDMOne(Params, InvTwoSqrtAB, Batch.Gap[i], Batch.Speed[i], Batch.LeaderSpeed[i], Batch.DesiredSpeed[i]);
+    }
+}
+
+void VehicleTrafficModel::ComputeIDM(const FVehicleIDMParams& Params, FVehicleIDMBatch& Batch, int32 Start, int32 Count)
+{
+    check(Start >= 0 && Start + Count <= Batch.Num());
+
+    const float InvTwoSqrtABScalar = GetInvTwoSqrtAB(Params);
+    const VectorRegister4Float One = VectorOne();
+    const VectorRegister4Float Zero = VectorZeroFloat();
+    const VectorRegister4Float MaxAcceleration = VectorSetFloat1(Params.MaxAcceleration);
+    const VectorRegister4Float MinAcceleration = VectorSetFloat1(-Params.MaxDeceleration);
+    const VectorRegister4Float TimeGap = VectorSetFloat1(Params.DesiredTimeGap);
+    const VectorRegister4Float MinGap = VectorSetFloat1(Params.MinGap);
+    const VectorRegister4Float InvTwoSqrtAB = VectorSetFloat1(InvTwoSqrtABScalar);
+    const VectorRegister4Float GapClamp = VectorSetFloat1(MinModelGap);
+    const VectorRegister4Float DesiredSpeedClamp = VectorSetFloat1(MinDesiredSpeed);
+
+    const float* RESTRICT GapData = Batch.Gap.GetData();
+    const float* RESTRICT SpeedData = Batch.Speed.GetData();
+    const float* RESTRICT LeaderSpeedData = Batch.LeaderSpeed.GetData();
+    const float* RESTRICT DesiredSpeedData = Batch.DesiredSpeed.GetData();
+    float* RESTRICT AccelerationData = Batch.Acceleration.GetData();
+
+    const int32 End = Start + Count;
+    int32 i = Start;
+    for (; i + 4 <= End; i += 4)
+    {
+        const VectorRegister4Float Gap = VectorMax(VectorLoad(GapData + i), GapClamp);
+        const VectorRegister4Float Speed = VectorLoad(SpeedData + i);
+        const VectorRegister4Float LeaderSpeed = VectorLoad(LeaderSpeedData + i);
+        const VectorRegister4Float DesiredSpeed = VectorMax(VectorLoad(DesiredSpeedData + i), DesiredSpeedClamp);
+
+        // s* = s0 + max(0, v * (T + dv / (2 sqrt(a b))))
+        const VectorRegister4Float Approach = VectorSubtract(Speed, LeaderSpeed);
+        const VectorRegister4Float DynamicGap = VectorMax(Zero, VectorMultiply(Speed, VectorMultiplyAdd(Approach, InvTwoSqrtAB, TimeGap)));
+        const VectorRegister4Float DesiredGap = VectorAdd(MinGap, DynamicGap);
+
+        const VectorRegister4Float SpeedRatio = VectorDivide(Speed, DesiredSpeed);
+        const VectorRegister4Float SpeedRatio2 = VectorMultiply(SpeedRatio, SpeedRatio);
+        const VectorRegister4Float GapRatio = VectorDivide(DesiredGap, Gap);
+
+        // 1 - ratio^4 - gapratio^2
+        VectorRegister4Float Factor = VectorNegateMultiplyAdd(SpeedRatio2, SpeedRatio2, One);
+        Factor = VectorNegateMultiplyAdd(GapRatio, GapRatio, Factor);
+
+        const VectorRegister4Float Acceleration = VectorMax(VectorMultiply(MaxAcceleration, Factor), MinAcceleration);
+        VectorStore(Acceleration, AccelerationData + i);
+    }
+
+    for (; i < End; i++)
+    {
+        AccelerationData[i] = ComputeIDMOne(Params, InvTwoSqrtABScalar, GapData[i], SpeedData[i], LeaderSpeedData[i], DesiredSpeedData[i]);
+    }
+}
+
+void VehicleTrafficModel::ComputeMOBILScalar(const FVehicleMOBILParams& Params, FVehicleMOBILBatch& Batch, int32 Start, int32 Count)
+{
+    for (int32 i = Start; i < Start + Count; i++)
+    {
+        if (Batch.NewFollowerAfter[i] < -Params.SafeDeceleration)
+        {
+            Batch.Incentive[i] = TNumericLimits<float>::Lowest();
+            continue;
+        }
+
+        const float OwnGain = Batch.Target[i] - Batch.Current[i];
+        const float OthersGain = (Batch.NewFollowerAfter[i] - Batch.NewFollowerBefore[i]) + (Batch.OldFollowerAfter[i] - Batch.OldFollowerBefore[i]);
+        Batch.Incentive[i] = OwnGain + Params.Politeness * OthersGain;
+    }
+}
+
+void VehicleTrafficModel::ComputeMOBIL(const FVehicleMOBILParams& Params, FVehicleMOBILBatch& Batch, int32 Start, int32 Count)
+{
+    check(Start >= 0 && Start + Count <= Batch.Num());
+
+    const VectorRegister4Float Politeness = VectorSetFloat1(Params.Politeness);
+    const VectorRegister4Float SafeLimit = VectorSetFloat1(-Params.SafeDeceleration);
+    const VectorRegister4Float Unsafe = VectorSetFloat1(TNumericLimits<float>::Lowest());
+
+    const float* RESTRICT CurrentData = Batch.Current.GetData();
+    const float* RESTRICT TargetData = Batch.Target.GetData();
+    const float* RESTRICT NewBeforeData = Batch.NewFollowerBefore.GetData();
+    const float* RESTRICT NewAfterData = Batch.NewFollowerAfter.GetData();
+    const float* RESTRICT OldBeforeData = Batch.OldFollowerBefore.GetData();
+    const float* RESTRICT OldAfterData = Batch.OldFollowerAfter.GetData();
+    float* RESTRICT IncentiveData = Batch.Incentive.GetData();
+
+    const int32 End = Start + Count;
+    int32 i = Start;
+    for (; i + 4 <= End; i += 4)
+    {
+        const VectorRegister4Float NewAfter = VectorLoad(NewAfterData + i);
+        const VectorRegister4Float OwnGain = VectorSubtract(VectorLoad(TargetData + i), VectorLoad(CurrentData + i));
+        const VectorRegister4Float OthersGain = VectorAdd(
+            VectorSubtract(NewAfter, VectorLoad(NewBeforeData + i)),
+            VectorSubtract(VectorLoad(OldAfterData + i), VectorLoad(OldBeforeData + i)));
+
+        const VectorRegister4Float Incentive = VectorMultiplyAdd(Politeness, OthersGain, OwnGain);
+        const VectorRegister4Float UnsafeMask = VectorCompareLT(NewAfter, SafeLimit);
+        VectorStore(VectorSelect(UnsafeMask, Unsafe, Incentive), IncentiveData + i);
+    }
+
+    if (i < End)
+    {
+        ComputeMOBILScalar(Params, Batch, i, End - i);
+    }
+}
+
+void VehicleTrafficModel::ComputeIDMParallel(const FVehicleIDMParams& Params, FVehicleIDMBatch& Batch, int32 ChunkSize)
+{
+    RunParallel(Batch.Num(), ChunkSize, [&Params, &Batch](int32 Start, int32 Count)
+    {
+        ComputeIDM(Params, Batch, Start, Count);
+    });
+}
+
+void VehicleTrafficModel::ComputeMOBILParallel(const FVehicleMOBILParams& Params, FVehicleMOBILBatch& Batch, int32 ChunkSize)
+{
+    RunParallel(Batch.Num(), ChunkSize, [&Params, &Batch](int32 Start, int32 Count)
+    {
+        ComputeMOBIL(Params, Batch, Start, Count);
+    });
+}
+
+namespace
+{
+    // Runs Kernel Iterations times and returns vehicle updates per second
+    template<typename KernelType>
+    double MeasureUpdatesPerSecond(int32 NumVehicles, int32 Iterations, KernelType Kernel)
+    {
+        Kernel(); // warm up caches and worker threads
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+        {
+            Kernel();
+        }
+        const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_DOUBLE_SMALL_NUMBER);
+        return static_cast<double>(NumVehicles) * Iterations / Elapsed;
+    }
+
+    float MaxDifference(const TArray<float>& A, const TArray<float>& B)
+    {
+        float Difference = 0.0f;
+        for (int32 i = 0; i < A.Num(); i++)
+        {
+            Difference = FMath::Max(Difference, FMath::Abs(A[i] - B[i]));
+        }
+        return Difference;
+    }
+
+    void RunTrafficModelBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumVehicles = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+        const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 200;
+
+        // Plausible mixed traffic: free road, following and closing in
+        FRandomStream Random(1234);
+        FVehicleIDMBatch Batch;
+        Batch.SetNum(NumVehicles);
+        for (int32 i = 0; i < NumVehicles; i++)
+        {
+            Batch.Gap[i] = Random.FRandRange(100.0f, 5000.0f);
+            Batch.Speed[i] = Random.FRandRange(0.0f, 600.0f);
+            Batch.LeaderSpeed[i] = Random.FRandRange(0.0f, 600.0f);
+            Batch.DesiredSpeed[i] = Random.FRandRange(300.0f, 600.0f);
+        }
+
+        FVehicleMOBILBatch LaneChanges;
+        LaneChanges.SetNum(NumVehicles);
+        for (int32 i = 0; i < NumVehicles; i++)
+        {
+            LaneChanges.Current[i] = Random.FRandRange(-500.0f, 300.0f);
+            LaneChanges.Target[i] = Random.FRandRange(-500.0f, 300.0f);
+            LaneChanges.NewFollowerBefore[i] = Random.FRandRange(-500.0f, 300.0f);
+            LaneChanges.NewFollowerAfter[i] = Random.FRandRange(-600.0f, 300.0f);
+            LaneChanges.OldFollowerBefore[i] = Random.FRandRange(-500.0f, 300.0f);
+            LaneChanges.OldFollowerAfter[i] = Random.FRandRange(-500.0f, 300.0f);
+        }
+
+        const FVehicleIDMParams IDMParams;
+        const FVehicleMOBILParams MOBILParams;
+
+        const double IDMScalar = MeasureUpdatesPerSecond(NumVehicles, Iterations, [&]() { VehicleTrafficModel::ComputeIDMScalar(IDMParams, Batch, 0, NumVehicles); });
+        const TArray<float> ScalarAcceleration = Batch.Acceleration;
+        const double IDMSimd = MeasureUpdatesPerSecond(NumVehicles, Iterations, [&]() { VehicleTrafficModel::ComputeIDM(IDMParams, Batch, 0, NumVehicles); });
+        const float IDMError = MaxDifference(ScalarAcceleration, Batch.Acceleration);
+        const double IDMParallel = MeasureUpdatesPerSecond(NumVehicles, Iterations, [&]() { VehicleTrafficModel::ComputeIDMParallel(IDMParams, Batch); });
+
+        const double MOBILScalar = MeasureUpdatesPerSecond(NumVehicles, Iterations, [&]() { VehicleTrafficModel::ComputeMOBILScalar(MOBILParams, LaneChanges, 0, NumVehicles); });
+        const TArray<float> ScalarIncentive = LaneChanges.Incentive;
+        const double MOBILSimd = MeasureUpdatesPerSecond(NumVehicles, Iterations, [&]() { VehicleTrafficModel::ComputeMOBIL(MOBILParams, LaneChanges, 0, NumVehicles); });
+        const float MOBILError = MaxDifference(ScalarIncentive, LaneChanges.Incentive);
+        const double MOBILParallel = MeasureUpdatesPerSecond(NumVehicles, Iterations, [&]() { VehicleTrafficModel::ComputeMOBILParallel(MOBILParams, LaneChanges); });
+
+        UE_LOG(LogTemp, Log, TEXT("TrafficModel benchmark: %d vehicles x %d iterations"), NumVehicles, Iterations);
+        UE_LOG(LogTemp, Log, TEXT("  IDM   scalar   %8.1f M updates/s"), IDMScalar / 1.0e6);
+        UE_LOG(LogTemp, Log, TEXT("  IDM   simd     %8.1f M updates/s (%.2fx, max diff %g)"), IDMSimd / 1.0e6, IDMSimd / IDMScalar, IDMError);
+        UE_LOG(LogTemp, Log, TEXT("  IDM   parallel %8.1f M updates/s (%.2fx)"), IDMParallel / 1.0e6, IDMParallel / IDMScalar);
+        UE_LOG(LogTemp, Log, TEXT("  MOBIL scalar   %8.1f M updates/s"), MOBILScalar / 1.0e6);
+        UE_LOG(LogTemp, Log, TEXT("  MOBIL simd     %8.1f M updates/s (%.2fx, max diff %g)"), MOBILSimd / 1.0e6, MOBILSimd / MOBILScalar, MOBILError);
+        UE_LOG(LogTemp, Log, TEXT("  MOBIL parallel %8.1f M updates/s (%.2fx)"), MOBILParallel / 1.0e6, MOBILParallel / MOBILScalar);
+    }
+
+    FAutoConsoleCommand BenchmarkTrafficModelCommand(
+        TEXT("vehicle.Traffic.BenchmarkModel"),
+        TEXT("Times the scalar, SIMD and parallel IDM/MOBIL kernels. Args: [NumVehicles=100000] [Iterations=200]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunTrafficModelBenchmark));
+}
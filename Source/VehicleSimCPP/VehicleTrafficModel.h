@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Longitudinal traffic model (Intelligent Driver Model) and lane-change evaluation (MOBIL),
+// run as batches over structure-of-arrays data. Units are cm and seconds.
+
+struct VEHICLESIMCPP_API FVehicleIDMParams
+{
+    float MaxAcceleration = 300.0f;      // a
+    float ComfortDeceleration = 400.0f;  // b
+    float MaxDeceleration = 900.0f;      // hard limit on the result
+    float DesiredTimeGap = 1.0f;         // T, seconds
+    float MinGap = 200.0f;               // s0, bumper to bumper at standstill
+    float VehicleLength = 450.0f;
+
+    // The free-road exponent is fixed at 4 (the usual IDM choice) so it reduces to two multiplies
+};
+
+struct VEHICLESIMCPP_API FVehicleMOBILParams
+{
+    float Politeness = 0.3f;             // p, weight of the other drivers' gain
+    float SafeDeceleration = 400.0f;     // b_safe, the new follower may not brake harder than this
+    float Threshold = 20.0f;             // a_th, minimum gain worth a lane change
+};
+
+// Inputs and output of the car-following model, one entry per vehicle
+struct VEHICLESIMCPP_API FVehicleIDMBatch
+{
+    TArray<float> Gap;              // bumper to bumper distance to the leader
+    TArray<float> Speed;
+    TArray<float> LeaderSpeed;
+    TArray<float> DesiredSpeed;
+    TArray<float> Acceleration;     // output
+
+    void SetNum(int32 NumVehicles);
+    int32 Num() const { return Speed.Num(); }
+};
+
+// Accelerations of the vehicles involved in a candidate lane change, one entry per candidate
+struct VEHICLESIMCPP_API FVehicleMOBILBatch
+{
+    TArray<float> Current;              // own acceleration in the current lane
+    TArray<float> Target;               // own acceleration after changing lane
+    TArray<float> NewFollowerBefore;    // follower in the target lane, now and after the change
+    TArray<float> NewFollowerAfter;
+    TArray<float> OldFollowerBefore;    // follower in the current lane, now and after the change
+    TArray<float> OldFollowerAfter;
+    TArray<float> Incentive;            // output, lowest float if the change is unsafe
+
+    void SetNum(int32 NumCandidates);
+    int32 Num() const { return Current.Num(); }
+};
+
+namespace VehicleTrafficModel
+{
+    // Reference implementations, one vehicle at a time
+    VEHICLESIMCPP_API void ComputeIDMScalar(const FVehicleIDMParams& Params, FVehicleIDMBatch& Batch, int32 Start, int32 Count);
+    VEHICLESIMCPP_API void ComputeMOBILScalar(const FVehicleMOBILParams& Params, FVehicleMOBILBatch& Batch, int32 Start, int32 Count);
+
+    // Four vehicles per instruction (VectorRegister4Float), scalar tail
+    VEHICLESIMCPP_API void ComputeIDM(const FVehicleIDMParams& Params, FVehicleIDMBatch& Batch, int32 Start, int32 Count);
+    VEHICLESIMCPP_API void ComputeMOBIL(const FVehicleMOBILParams& Params, FVehicleMOBILBatch& Batch, int32 Start, int32 Count);
+
+    // Whole batch, split into chunks across worker threads
+    VEHICLESIMCPP_API void ComputeIDMParallel(const FVehicleIDMParams& Params, FVehicleIDMBatch& Batch, int32 ChunkSize = 2048);
+    VEHICLESIMCPP_API void ComputeMOBILParallel(const FVehicleMOBILParams& Params, FVehicleMOBILBatch& Batch, int32 ChunkSize = 2048);
+
+    // A lane change is worth it when the incentive clears the threshold
+    inline bool ShouldChangeLane(const FVehicleMOBILParams& Params, float Incentive) { return Incentive > Params.Threshold; }
+}
@@ -0,0 +1,64 @@
+#include "VehicleTrafficProcessors.h"
+#include "MassExecutionContext.h"
+
+UVehicleTrafficMovementProcessor::UVehicleTrafficMovementProcessor()
+{
+    // Run explicitly by AVehicleTrafficManager rather than by the Mass simulation phases
+    bAutoRegisterWithProcessingPhases = false;
+    ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+
+    EntityQuery.RegisterWithProcessor(*this);
+}
+
+void UVehicleTrafficMovementProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FVehicleTrafficTransformFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FVehicleTrafficMotionFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FVehicleTrafficInstanceFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddTagRequirement<FVehicleTrafficPromotedTag>(EMassFragmentPresence::None);
+}
+
+void UVehicleTrafficMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    if (Lanes.Num() == 0)
+    {
+        return;
+    }
+
+    EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [this](FMassExecutionContext& ChunkContext)
+    {
+        const float DeltaTime = ChunkContext.GetDeltaTimeSeconds();
+        const TArrayView<FVehicleTrafficTransformFragment> Transforms = ChunkContext.GetMutableFragmentView<FVehicleTrafficTransformFragment>();
+        const TArrayView<FVehicleTrafficMotionFragment> Motions = ChunkContext.GetMutableFragmentView<FVehicleTrafficMotionFragment>();
+        const TConstArrayView<FVehicleTrafficInstanceFragment> Instances = ChunkContext.GetFragmentView<FVehicleTrafficInstanceFragment>();
+
+        for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); EntityIndex++)
+        {
+            FVehicleTrafficMotionFragment& Motion = Motions[EntityIndex];
+            FVehicleTrafficTransformFragment& Transform = Transforms[EntityIndex];
+            const FVehicleTrafficLane& Lane = Lanes[Motion.LaneIndex];
+
+            const int32 InstanceIndex = Instances[EntityIndex].InstanceIndex;
+            const float Acceleration = Accelerations.IsValidIndex(InstanceIndex) ? Accelerations[InstanceIndex] : 0.0f;
+
+            Motion.Speed = FMath::Max(0.0f, Motion.Speed + Acceleration * DeltaTime);
+            Motion.LaneDistance = FMath::Fmod(Motion.LaneDistance + Motion.Speed * DeltaTime, Lane.GetLength());
+
+            const float Angle = Lane.Direction * Motion.LaneDistance / Lane.Radius;
+            float Sin, Cos;
+            FMath::SinCos(&Sin, &Cos, Angle);
+            Transform.Location = Lane.Center + FVector3f(Cos * Lane.Radius, Sin * Lane.Radius, 0.0f);
+            Transform.Yaw = FMath::RadiansToDegrees(Angle) + 90.0f * Lane.Direction;
+
+            if (InstanceTransforms.IsValidIndex(InstanceIndex))
+            {
+                InstanceTransforms[InstanceIndex] = FTransform(FRotator(0.0f, Transform.Yaw, 0.0f), FVector(Transform.Location), InstanceScale);
+            }
+            if (Speeds.IsValidIndex(InstanceIndex))
+            {
+                Speeds[InstanceIndex] = Motion.Speed;
+                LaneDistances[InstanceIndex] = Motion.LaneDistance;
+            }
+        }
+    });
+}
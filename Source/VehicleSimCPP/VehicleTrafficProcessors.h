@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "VehicleTrafficTypes.h"
+#include "VehicleTrafficProcessors.generated.h"
+
+// Advances every non-promoted traffic car along its lane and writes its instance transform.
+// Chunks are processed in parallel; each car only touches its own fragments and instance slot.
+UCLASS()
+class VEHICLESIMCPP_API UVehicleTrafficMovementProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UVehicleTrafficMovementProcessor();
+
+    // Provided by the owning AVehicleTrafficManager before each run, all indexed by instance
+    TConstArrayView<FVehicleTrafficLane> Lanes;
+    TArrayView<FTransform> InstanceTransforms;
+    FVector InstanceScale = FVector::OneVector;
+
+    // Car-following accelerations in, new speeds and lane distances out for the next model step
+    TConstArrayView<float> Accelerations;
+    TArrayView<float> Speeds;
+    TArrayView<float> LaneDistances;
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "VehicleTrafficTypes.generated.h"
+
+// Background traffic cars are Mass entities, not actors. Hot per-frame data is split into
+// small fragments so the movement pass streams through tightly packed chunk memory.
+
+// Where the car is (16 bytes: location + heading)
+USTRUCT()
+struct VEHICLESIMCPP_API FVehicleTrafficTransformFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    FVector3f Location = FVector3f::ZeroVector;
+    float Yaw = 0.0f; // degrees
+};
+
+// How the car moves along its lane
+USTRUCT()
+struct VEHICLESIMCPP_API FVehicleTrafficMotionFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    float Speed = 0.0f;             // units per second
+    float LaneDistance = 0.0f;      // distance travelled along the lane
+    int32 LaneIndex = 0;
+};
+
+// Slot in the traffic manager's instanced mesh
+USTRUCT()
+struct VEHICLESIMCPP_API FVehicleTrafficInstanceFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    int32 InstanceIndex = INDEX_NONE;
+};
+
+// Present while a full AVehicleBase stands in for this car near the player.
+// Promoted cars are skipped by the traffic movement pass.
+USTRUCT()
+struct VEHICLESIMCPP_API FVehicleTrafficPromotedTag : public FMassTag
+{
+    GENERATED_BODY()
+};
+
+// Ring-shaped lanes the background traffic drives on
+struct FVehicleTrafficLane
+{
+    FVector3f Center = FVector3f::ZeroVector;
+    float Radius = 0.0f;
+    float Direction = 1.0f; // +1 counter-clockwise, -1 clockwise
+
+    float GetLength() const { return 2.0f * UE_PI * Radius; }
+};
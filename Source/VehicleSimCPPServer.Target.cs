@@ -0,0 +1,18 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class VehicleSimCPPServerTarget : TargetRules
+{
+    public VehicleSimCPPServerTarget(TargetInfo Target) : base(Target)
+    {
+        Type = TargetType.Server;
+        DefaultBuildSettings = BuildSettingsVersion.V5;
+        IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_4;
+        ExtraModuleNames.Add("VehicleSimCPP");
+
+        // Headless race sessions still need their logs
+        bUseLoggingInShipping = true;
+    }
+}
@@ -0,0 +1,22 @@
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+// Offline analysis of recorded replays; a console program on Core, ApplicationCore and Projects
+public class VehicleTelemetryToolTarget : TargetRules
+{
+    public VehicleTelemetryToolTarget(TargetInfo Target) : base(Target)
+    {
+        Type = TargetType.Program;
+        LinkType = TargetLinkType.Monolithic;
+        DefaultBuildSettings = BuildSettingsVersion.V5;
+        IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_4;
+        LaunchModuleName = "VehicleTelemetryTool";
+
+        bBuildDeveloperTools = false;
+        bCompileAgainstEngine = false;
+        bCompileAgainstCoreUObject = false;
+        bCompileICU = false;
+        bIsBuildingConsoleApplication = true;
+        bUseLoggingInShipping = true;
+    }
+}
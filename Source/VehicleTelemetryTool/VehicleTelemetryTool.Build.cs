@@ -0,0 +1,16 @@
+using System.IO;
+using UnrealBuildTool;
+
+public class VehicleTelemetryTool : ModuleRules
+{
+    public VehicleTelemetryTool(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PrivateDependencyModuleNames.AddRange(new string[]
+        {
+            "Core", "ApplicationCore", "Projects"
+        });
+
+        // VehicleReplayFormat.h is shared with the game module and only needs Core
+        PrivateIncludePaths.Add(Path.Combine(ModuleDirectory, "..", "VehicleSimCPP"));
+    }
+}
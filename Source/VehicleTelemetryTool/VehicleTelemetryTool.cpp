@@ -0,0 +1,1182 @@
+#include "RequiredProgramMainCPPInclude.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Math/VectorRegister.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "VehicleDigestFormat.h"
+#include "VehicleReplayFormat.h"
+
+IMPLEMENT_APPLICATION(VehicleTelemetryTool, "VehicleTelemetryTool");
+
+// Summarises a replay file (Saved/Replays/*.vreplay) without the game:
+//
+//   VehicleTelemetryTool <File.vreplay> [-Out=Path] [-Json] [-Gate=X,Y,Radius] [-HeatmapCell=500] [-SpeedBin=25]
+//
+// The file is memory-mapped and split at its keyframes; every keyframe holds the full vehicle
+// state, so each batch of keyframe intervals is reconstructed independently on a worker
+// thread by running the recorded inputs through the movement model. Batches reduce into
+// fixed-size, time-weighted histograms that merge in order at the end.
+//
+// Writes per-vehicle channel statistics (min/max/mean/p5/p50/p95 for speed, throttle and
+// steering), laps through the -Gate circle, a speed histogram and a track-position heatmap,
+// as <Out>_vehicles/_laps/_speed/_heatmap.csv or one <Out>.json with -Json.
+//
+//   VehicleTelemetryTool -CompareDigests <A.vdigest> <B.vdigest>
+//
+// Compares two determinism digest streams (-VehicleDigest) and logs the first step where the
+// runs diverge with the vehicle fields that differ. Exits with 1 on any difference.
+//
+//   VehicleTelemetryTool -PerfGate <Capture.csv> -Baseline=<File.csv> [-Threshold=5] [-MemoryThreshold=5] [-UpdateBaseline]
+//
+// Checks a -VehiclePerfScenario CSV profile against a stored baseline: exits with 1 when the
+// p95 frame time or the peak memory grew by more than its threshold (percent). Thread times
+// and vehicle counts are reported alongside.
+
+namespace
+{
+    // Mirrors AVehicleBase's movement model
+    constexpr float MaxForwardSpeed = 500.0f;
+    constexpr float MaxYawRate = 90.0f;
+    constexpr float InputDeadZone = 0.1f;
+
+    // Quantized inputs are int8; one histogram bin per value
+    constexpr int32 NumInputBins = 256;
+    static_assert(NumInputBins % 4 == 0, "Histograms are merged four bins at a time");
+
+    // Dst[i] += Src[i] over a whole input histogram, four doubles per vector add
+    void AddBins(double* Dst, const double* Src)
+    {
+        for (int32 i = 0; i < NumInputBins; i += 4)
+        {
+            VectorStore(VectorAdd(VectorLoad(Dst + i), VectorLoad(Src + i)), Dst + i);
+        }
+    }
+
+    struct FOptions
+    {
+        FString Input;
+        FString Output;
+        bool bJson = false;
+        bool bHasGate = false;
+        FVector2D GateCenter = FVector2D::ZeroVector;
+        double GateRadius = 0.0;
+        double HeatmapCellSize = 500.0;
+        double SpeedBinWidth = 25.0;
+    };
+
+    template<typename T>
+    T ReadAt(const uint8* Data)
+    {
+        T Value;
+        FMemory::Memcpy(&Value, Data, sizeof(T));
+        return Value;
+    }
+
+    float GetSpeed(int8 Throttle)
+    {
+        const float Value = Throttle / 127.0f;
+        return FMath::Abs(Value) > InputDeadZone ? FMath::Abs(Value) * MaxForwardSpeed : 0.0f;
+    }
+
+    uint64 GetHeatmapKey(const FVector& Location, double CellSize)
+    {
+        const int32 X = FMath::FloorToInt32(Location.X / CellSize);
+        const int32 Y = FMath::FloorToInt32(Location.Y / CellSize);
+        return (uint64(uint32(X)) << 32) | uint32(Y);
+    }
+
+    // Size of the record at Cursor including its type byte, 0 if it is truncated or unknown
+    int64 GetRecordSize(const uint8* Data, int64 Cursor, int64 End)
+    {
+        using VehicleReplayFormat::ERecord;
+
+        int64 Size = 0;
+        switch (static_cast<ERecord>(Data[Cursor]))
+        {
+        case ERecord::Vehicle:
+            Size = Cursor + 5 <= End ? 5 + ReadAt<uint16>(Data + Cursor + 3) : 0;
+            break;
+        case ERecord::Frame:
+            Size = 1 + VehicleReplayFormat::FrameSize;
+            break;
+        case ERecord::Move:
+            Size = 1 + VehicleReplayFormat::MoveSize;
+            break;
+        case ERecord::Keyframe:
+            Size = Cursor + 1 + VehicleReplayFormat::KeyframeHeaderSize <= End
+                ? 1 + VehicleReplayFormat::KeyframeHeaderSize + ReadAt<uint16>(Data + Cursor + 9) * VehicleReplayFormat::KeyframeStateSize
+                : 0;
+            break;
+        default:
+            break;
+        }
+        return Cursor + Size <= End ? Size : 0;
+    }
+
+    FString ReadName(const uint8* Data, uint16 Length)
+    {
+        FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data), Length);
+        return FString(Converted.Length(), Converted.Get());
+    }
+
+    // A whole file mapped read-only
+    struct FMappedFile
+    {
+        bool Open(const FString& Filename)
+        {
+            Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+            Region.Reset(Handle ? Handle->MapRegion() : nullptr);
+            Data = Region ? Region->GetMappedPtr() : nullptr;
+            Size = Region ? Region->GetMappedSize() : 0;
+            return Region.IsValid();
+        }
+
+        // The region has to go before the handle
+        ~FMappedFile()
+        {
+            Region.Reset();
+            Handle.Reset();
+        }
+
+        const uint8* Data = nullptr;
+        int64 Size = 0;
+
+    private:
+        TUniquePtr<IMappedFileHandle> Handle;
+        TUniquePtr<IMappedFileRegion> Region;
+    };
+
+    class FReplayFile
+    {
+    public:
+        bool Open(const FString& Filename)
+        {
+            if (!Mapping.Open(Filename))
+            {
+                return false;
+            }
+
+            Data = Mapping.Data;
+            DataSize = Mapping.Size;
+            RecordsEnd = DataSize;
+            if (DataSize < VehicleReplayFormat::HeaderSize
+                || ReadAt<uint32>(Data) != VehicleReplayFormat::Magic
+                || ReadAt<uint32>(Data + 4) != VehicleReplayFormat::Version)
+            {
+                return false;
+            }
+
+            if (!ReadIndex())
+            {
+                RebuildIndex();
+            }
+            return Keyframes.Num() > 0;
+        }
+
+        const uint8* Data = nullptr;
+        int64 DataSize = 0;
+        int64 RecordsEnd = 0;
+        TArray<FString> VehicleNames;
+        TArray<VehicleReplayFormat::FKeyframeEntry> Keyframes;
+
+    private:
+        bool ReadIndex()
+        {
+            if (DataSize < VehicleReplayFormat::HeaderSize + VehicleReplayFormat::FooterSize)
+            {
+                return false;
+            }
+
+            const uint8* Footer = Data + DataSize - VehicleReplayFormat::FooterSize;
+            const uint64 IndexOffset = ReadAt<uint64>(Footer);
+            const uint32 NumKeyframes = ReadAt<uint32>(Footer + 8);
+            if (ReadAt<uint32>(Footer + 12) != VehicleReplayFormat::FooterMagic || IndexOffset < uint64(VehicleReplayFormat::HeaderSize) || IndexOffset + 4 > uint64(DataSize))
+            {
+                return false;
+            }
+
+            const int64 IndexEnd = DataSize - VehicleReplayFormat::FooterSize;
+            int64 Cursor = IndexOffset;
+            const int32 NumNames = ReadAt<int32>(Data + Cursor);
+            Cursor += 4;
+            for (int32 i = 0; i < NumNames; i++)
+            {
+                if (Cursor + 2 > IndexEnd)
+                {
+                    return false;
+                }
+                const uint16 Length = ReadAt<uint16>(Data + Cursor);
+                if (Cursor + 2 + Length > IndexEnd)
+                {
+                    return false;
+                }
+                VehicleNames.Add(ReadName(Data + Cursor + 2, Length));
+                Cursor += 2 + Length;
+            }
+
+            if (Cursor + int64(NumKeyframes) * 16 > IndexEnd)
+            {
+                return false;
+            }
+            Keyframes.SetNum(NumKeyframes);
+            for (VehicleReplayFormat::FKeyframeEntry& Entry : Keyframes)
+            {
+                Entry.Time = ReadAt<double>(Data + Cursor);
+                Entry.Offset = ReadAt<uint64>(Data + Cursor + 8);
+                Cursor += 16;
+            }
+
+            RecordsEnd = IndexOffset;
+            return true;
+        }
+
+        void RebuildIndex()
+        {
+            UE_LOG(LogTemp, Warning, TEXT("VehicleTelemetryTool: No index (recording did not finish), scanning the file"));
+
+            VehicleNames.Reset();
+            Keyframes.Reset();
+            RecordsEnd = DataSize;
+
+            int64 Cursor = VehicleReplayFormat::HeaderSize;
+            while (Cursor < RecordsEnd)
+            {
+                const int64 Size = GetRecordSize(Data, Cursor, RecordsEnd);
+                if (Size == 0)
+                {
+                    // Truncated last record
+                    RecordsEnd = Cursor;
+                    break;
+                }
+
+                const VehicleReplayFormat::ERecord Type = static_cast<VehicleReplayFormat::ERecord>(Data[Cursor]);
+                if (Type == VehicleReplayFormat::ERecord::Keyframe)
+                {
+                    Keyframes.Add(VehicleReplayFormat::FKeyframeEntry{ ReadAt<double>(Data + Cursor + 1), uint64(Cursor) });
+                }
+                else if (Type == VehicleReplayFormat::ERecord::Vehicle)
+                {
+                    const uint16 Index = ReadAt<uint16>(Data + Cursor + 1);
+                    if (Index >= VehicleNames.Num())
+                    {
+                        VehicleNames.SetNum(Index + 1);
+                    }
+                    VehicleNames[Index] = ReadName(Data + Cursor + 5, ReadAt<uint16>(Data + Cursor + 3));
+                }
+                Cursor += Size;
+            }
+        }
+
+        FMappedFile Mapping;
+    };
+
+    // Time-weighted accumulators for one vehicle
+    struct FVehicleStats
+    {
+        double Duration = 0.0;
+        double Distance = 0.0;
+        double BrakeTime = 0.0;
+        int64 NumMoves = 0;
+        double ThrottleTime[NumInputBins] = {};     // indexed by quantized value + 128
+        double SteeringTime[NumInputBins] = {};
+
+        void Merge(const FVehicleStats& Other)
+        {
+            Duration += Other.Duration;
+            Distance += Other.Distance;
+            BrakeTime += Other.BrakeTime;
+            NumMoves += Other.NumMoves;
+            AddBins(ThrottleTime, Other.ThrottleTime);
+            AddBins(SteeringTime, Other.SteeringTime);
+        }
+    };
+
+    // A vehicle entering the gate circle; Distance is measured from the start of its batch
+    struct FGateEvent
+    {
+        int32 Vehicle = 0;
+        double Time = 0.0;
+        double Distance = 0.0;
+    };
+
+    struct FBatchResult
+    {
+        TArray<FVehicleStats> Vehicles;
+        TArray<FGateEvent> GateEvents;
+        TMap<uint64, double> Heatmap;
+    };
+
+    struct FVehiclePose
+    {
+        FVector Location = FVector::ZeroVector;
+        double Yaw = 0.0;   // degrees
+        bool bValid = false;
+        bool bInGate = false;
+
+        // Heatmap time is collected per cell and only added to the map when the cell changes
+        uint64 HeatmapKey = 0;
+        double HeatmapTime = 0.0;
+    };
+
+    // Reconstructs the keyframe intervals [FirstKeyframe, EndKeyframe)
+    void ProcessBatch(const FReplayFile& File, const FOptions& Options, int32 FirstKeyframe, int32 EndKeyframe, FBatchResult& Result)
+    {
+        using VehicleReplayFormat::ERecord;
+
+        const uint8* Data = File.Data;
+        int64 Cursor = File.Keyframes[FirstKeyframe].Offset;
+        const int64 End = EndKeyframe < File.Keyframes.Num() ? int64(File.Keyframes[EndKeyframe].Offset) : File.RecordsEnd;
+        double Time = File.Keyframes[FirstKeyframe].Time;
+
+        TArray<FVehiclePose> Poses;
+        auto EnsureVehicle = [&Result, &Poses](int32 Index)
+        {
+            if (Index >= Poses.Num())
+            {
+                Poses.SetNum(Index + 1);
+                Result.Vehicles.SetNum(Index + 1);
+            }
+        };
+        EnsureVehicle(File.VehicleNames.Num() - 1);
+
+        auto IsInGate = [&Options](const FVector& Location)
+        {
+            return Options.bHasGate && FVector2D::DistSquared(FVector2D(Location), Options.GateCenter) < FMath::Square(Options.GateRadius);
+        };
+        auto FlushHeatmap = [&Result](FVehiclePose& Pose)
+        {
+            if (Pose.HeatmapTime > 0.0)
+            {
+                Result.Heatmap.FindOrAdd(Pose.HeatmapKey) += Pose.HeatmapTime;
+                Pose.HeatmapTime = 0.0;
+            }
+        };
+
+        while (Cursor < End)
+        {
+            const int64 Size = GetRecordSize(Data, Cursor, End);
+            if (Size == 0)
+            {
+                break;
+            }
+
+            const uint8* Record = Data + Cursor + 1;
+            switch (static_cast<ERecord>(Data[Cursor]))
+            {
+            case ERecord::Vehicle:
+                EnsureVehicle(ReadAt<uint16>(Record));
+                break;
+
+            case ERecord::Frame:
+                Time = ReadAt<double>(Record);
+                break;
+
+            case ERecord::Move:
+            {
+                const uint16 Index = ReadAt<uint16>(Record);
+                const float DeltaTime = ReadAt<uint16>(Record + 2) * 0.0001f;
+                const int8 Throttle = ReadAt<int8>(Record + 4);
+                const int8 Steering = ReadAt<int8>(Record + 5);
+                EnsureVehicle(Index);
+
+                FVehicleStats& Stats = Result.Vehicles[Index];
+                Stats.Duration += DeltaTime;
+                Stats.NumMoves++;
+                Stats.ThrottleTime[Throttle + 128] += DeltaTime;
+                Stats.SteeringTime[Steering + 128] += DeltaTime;
+                Stats.BrakeTime += Record[6] ? DeltaTime : 0.0f;
+
+                // Vehicles first seen after the batch's keyframe have no pose until the next one
+                FVehiclePose& Pose = Poses[Index];
+                if (!Pose.bValid)
+                {
+                    break;
+                }
+
+                // Same order as AVehicleBase::SimulateMove: drive, then steer. Collisions are
+                // not known here, so a blocked vehicle drifts until the next keyframe.
+                const float Speed = GetSpeed(Throttle);
+                if (Speed > 0.0f)
+                {
+                    const double Step = Speed * DeltaTime;
+                    const double YawRadians = FMath::DegreesToRadians(Pose.Yaw);
+                    Pose.Location += FVector(FMath::Cos(YawRadians), FMath::Sin(YawRadians), 0.0) * (Throttle > 0 ? Step : -Step);
+                    Stats.Distance += Step;
+                }
+                const float SteeringValue = Steering / 127.0f;
+                if (FMath::Abs(SteeringValue) > InputDeadZone)
+                {
+                    Pose.Yaw += SteeringValue * MaxYawRate * DeltaTime;
+                }
+
+                const uint64 HeatmapKey = GetHeatmapKey(Pose.Location, Options.HeatmapCellSize);
+                if (HeatmapKey != Pose.HeatmapKey)
+                {
+                    FlushHeatmap(Pose);
+                    Pose.HeatmapKey = HeatmapKey;
+                }
+                Pose.HeatmapTime += DeltaTime;
+
+                const bool bInGate = IsInGate(Pose.Location);
+                if (bInGate && !Pose.bInGate)
+                {
+                    Result.GateEvents.Add(FGateEvent{ Index, Time, Stats.Distance });
+                }
+                Pose.bInGate = bInGate;
+                break;
+            }
+
+            case ERecord::Keyframe:
+            {
+                Time = ReadAt<double>(Record);
+                const uint16 Count = ReadAt<uint16>(Record + 8);
+                const uint8* State = Record + VehicleReplayFormat::KeyframeHeaderSize;
+                for (int32 i = 0; i < Count; i++, State += VehicleReplayFormat::KeyframeStateSize)
+                {
+                    const uint16 Index = ReadAt<uint16>(State);
+                    EnsureVehicle(Index);
+
+                    const FVector Location(ReadAt<double>(State + 2), ReadAt<double>(State + 10), ReadAt<double>(State + 18));
+                    const FQuat4f Rotation(ReadAt<float>(State + 26), ReadAt<float>(State + 30), ReadAt<float>(State + 34), ReadAt<float>(State + 38));
+
+                    FVehiclePose& Pose = Poses[Index];
+                    FlushHeatmap(Pose);
+                    Pose.Location = Location;
+                    Pose.Yaw = Rotation.Rotator().Yaw;
+                    Pose.HeatmapKey = GetHeatmapKey(Location, Options.HeatmapCellSize);
+                    // Only a pose in the gate at the start of the batch counts as "already in"
+                    Pose.bInGate = Pose.bValid ? Pose.bInGate : IsInGate(Location);
+                    Pose.bValid = true;
+                }
+                break;
+            }
+            }
+
+            Cursor += Size;
+        }
+
+        for (FVehiclePose& Pose : Poses)
+        {
+            FlushHeatmap(Pose);
+        }
+    }
+
+    struct FChannelSummary
+    {
+        double Min = 0.0;
+        double Max = 0.0;
+        double Mean = 0.0;
+        double P5 = 0.0;
+        double P50 = 0.0;
+        double P95 = 0.0;
+    };
+
+    // Summary of a time-weighted distribution given as (value, seconds) pairs
+    FChannelSummary Summarize(TArray<TPair<double, double>>& Weighted)
+    {
+        FChannelSummary Summary;
+        Weighted.RemoveAll([](const TPair<double, double>& Entry) { return Entry.Value <= 0.0; });
+        if (Weighted.Num() == 0)
+        {
+            return Summary;
+        }
+        Weighted.Sort([](const TPair<double, double>& A, const TPair<double, double>& B) { return A.Key < B.Key; });
+
+        double TotalTime = 0.0;
+        double WeightedSum = 0.0;
+        for (const TPair<double, double>& Entry : Weighted)
+        {
+            TotalTime += Entry.Value;
+            WeightedSum += Entry.Key * Entry.Value;
+        }
+
+        auto Percentile = [&Weighted, TotalTime](double Fraction)
+        {
+            double Accumulated = 0.0;
+            for (const TPair<double, double>& Entry : Weighted)
+            {
+                Accumulated += Entry.Value;
+                if (Accumulated >= Fraction * TotalTime)
+                {
+                    return Entry.Key;
+                }
+            }
+            return Weighted.Last().Key;
+        };
+
+        Summary.Min = Weighted[0].Key;
+        Summary.Max = Weighted.Last().Key;
+        Summary.Mean = WeightedSum / TotalTime;
+        Summary.P5 = Percentile(0.05);
+        Summary.P50 = Percentile(0.5);
+        Summary.P95 = Percentile(0.95);
+        return Summary;
+    }
+
+    FChannelSummary SummarizeInput(const double (&Time)[NumInputBins], TFunctionRef<double(int8)> Value)
+    {
+        TArray<TPair<double, double>> Weighted;
+        Weighted.Reserve(NumInputBins);
+        for (int32 i = 0; i < NumInputBins; i++)
+        {
+            Weighted.Emplace(Value(static_cast<int8>(i - 128)), Time[i]);
+        }
+        return Summarize(Weighted);
+    }
+
+    struct FLap
+    {
+        int32 Vehicle = 0;
+        int32 Number = 0;
+        double StartTime = 0.0;
+        double Time = 0.0;
+        double Distance = 0.0;
+    };
+
+    struct FReport
+    {
+        TArray<FString> VehicleNames;
+        TArray<FVehicleStats> Vehicles;
+        TArray<FLap> Laps;
+        TMap<uint64, double> Heatmap;
+    };
+
+    FString FormatSummary(const FChannelSummary& Summary, const TCHAR* Separator)
+    {
+        return FString::Printf(TEXT("%.3f%s%.3f%s%.3f%s%.3f%s%.3f%s%.3f"),
+            Summary.Min, Separator, Summary.Max, Separator, Summary.Mean, Separator, Summary.P5, Separator, Summary.P50, Separator, Summary.P95);
+    }
+
+    FString FormatSummaryJson(const FChannelSummary& Summary)
+    {
+        return FString::Printf(TEXT("{\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f,\"p5\":%.3f,\"p50\":%.3f,\"p95\":%.3f}"),
+            Summary.Min, Summary.Max, Summary.Mean, Summary.P5, Summary.P50, Summary.P95);
+    }
+
+    TArray<double> BuildSpeedHistogram(const FReport& Report, double BinWidth)
+    {
+        TArray<double> Bins;
+        Bins.SetNumZeroed(FMath::FloorToInt32(MaxForwardSpeed / BinWidth) + 1);
+        for (const FVehicleStats& Stats : Report.Vehicles)
+        {
+            for (int32 i = 0; i < NumInputBins; i++)
+            {
+                Bins[FMath::Min(FMath::FloorToInt32(GetSpeed(static_cast<int8>(i - 128)) / BinWidth), Bins.Num() - 1)] += Stats.ThrottleTime[i];
+            }
+        }
+        return Bins;
+    }
+
+    void DecodeHeatmapKey(uint64 Key, double CellSize, double& OutX, double& OutY)
+    {
+        OutX = int32(uint32(Key >> 32)) * CellSize;
+        OutY = int32(uint32(Key)) * CellSize;
+    }
+
+    FString EscapeCsv(const FString& Value)
+    {
+        return Value.Contains(TEXT(",")) || Value.Contains(TEXT("\"")) ? TEXT("\"") + Value.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"") : Value;
+    }
+
+    bool WriteCsv(const FReport& Report, const FOptions& Options)
+    {
+        FString Vehicles = TEXT("vehicle,name,moves,duration,distance,brake_fraction,laps,best_lap,")
+            TEXT("speed_min,speed_max,speed_mean,speed_p5,speed_p50,speed_p95,")
+            TEXT("throttle_min,throttle_max,throttle_mean,throttle_p5,throttle_p50,throttle_p95,")
+            TEXT("steering_min,steering_max,steering_mean,steering_p5,steering_p50,steering_p95\n");
+        for (int32 i = 0; i < Report.Vehicles.Num(); i++)
+        {
+            const FVehicleStats& Stats = Report.Vehicles[i];
+            if (Stats.NumMoves == 0)
+            {
+                continue;
+            }
+
+            int32 NumLaps = 0;
+            double BestLap = 0.0;
+            for (const FLap& Lap : Report.Laps)
+            {
+                if (Lap.Vehicle == i)
+                {
+                    BestLap = NumLaps++ == 0 ? Lap.Time : FMath::Min(BestLap, Lap.Time);
+                }
+            }
+
+            Vehicles += FString::Printf(TEXT("%d,%s,%lld,%.3f,%.1f,%.4f,%d,%.3f,%s,%s,%s\n"),
+                i, *EscapeCsv(Report.VehicleNames.IsValidIndex(i) ? Report.VehicleNames[i] : FString()), Stats.NumMoves, Stats.Duration, Stats.Distance,
+                Stats.Duration > 0.0 ? Stats.BrakeTime / Stats.Duration : 0.0, NumLaps, BestLap,
+                *FormatSummary(SummarizeInput(Stats.ThrottleTime, [](int8 Value) { return double(GetSpeed(Value)); }), TEXT(",")),
+                *FormatSummary(SummarizeInput(Stats.ThrottleTime, [](int8 Value) { return Value / 127.0; }), TEXT(",")),
+                *FormatSummary(SummarizeInput(Stats.SteeringTime, [](int8 Value) { return Value / 127.0; }), TEXT(",")));
+        }
+
+        FString Laps = TEXT("vehicle,lap,start_time,time,distance,mean_speed\n");
+        for (const FLap& Lap : Report.Laps)
+        {
+            Laps += FString::Printf(TEXT("%d,%d,%.3f,%.3f,%.1f,%.1f\n"), Lap.Vehicle, Lap.Number, Lap.StartTime, Lap.Time, Lap.Distance, Lap.Time > 0.0 ? Lap.Distance / Lap.Time : 0.0);
+        }
+
+        FString Speed = TEXT("speed_from,speed_to,seconds\n");
+        const TArray<double> SpeedBins = BuildSpeedHistogram(Report, Options.SpeedBinWidth);
+        for (int32 i = 0; i < SpeedBins.Num(); i++)
+        {
+            Speed += FString::Printf(TEXT("%.1f,%.1f,%.3f\n"), i * Options.SpeedBinWidth, (i + 1) * Options.SpeedBinWidth, SpeedBins[i]);
+        }
+
+        FString Heatmap = TEXT("x,y,seconds\n");
+        for (const TPair<uint64, double>& Cell : Report.Heatmap)
+        {
+            double X, Y;
+            DecodeHeatmapKey(Cell.Key, Options.HeatmapCellSize, X, Y);
+            Heatmap += FString::Printf(TEXT("%.0f,%.0f,%.3f\n"), X, Y, Cell.Value);
+        }
+
+        return FFileHelper::SaveStringToFile(Vehicles, *(Options.Output + TEXT("_vehicles.csv")))
+            && FFileHelper::SaveStringToFile(Laps, *(Options.Output + TEXT("_laps.csv")))
+            && FFileHelper::SaveStringToFile(Speed, *(Options.Output + TEXT("_speed.csv")))
+            && FFileHelper::SaveStringToFile(Heatmap, *(Options.Output + TEXT("_heatmap.csv")));
+    }
+
+    bool WriteJson(const FReport& Report, const FOptions& Options)
+    {
+        FString Json = TEXT("{\"vehicles\":[");
+        bool bFirst = true;
+        for (int32 i = 0; i < Report.Vehicles.Num(); i++)
+        {
+            const FVehicleStats& Stats = Report.Vehicles[i];
+            if (Stats.NumMoves == 0)
+            {
+                continue;
+            }
+
+            const FString Name = Report.VehicleNames.IsValidIndex(i) ? Report.VehicleNames[i].ReplaceCharWithEscapedChar() : FString();
+            Json += FString::Printf(TEXT("%s{\"vehicle\":%d,\"name\":\"%s\",\"moves\":%lld,\"duration\":%.3f,\"distance\":%.1f,\"brake_fraction\":%.4f,\"speed\":%s,\"throttle\":%s,\"steering\":%s}"),
+                bFirst ? TEXT("") : TEXT(","), i, *Name, Stats.NumMoves, Stats.Duration, Stats.Distance, Stats.Duration > 0.0 ? Stats.BrakeTime / Stats.Duration : 0.0,
+                *FormatSummaryJson(SummarizeInput(Stats.ThrottleTime, [](int8 Value) { return double(GetSpeed(Value)); })),
+                *FormatSummaryJson(SummarizeInput(Stats.ThrottleTime, [](int8 Value) { return Value / 127.0; })),
+                *FormatSummaryJson(SummarizeInput(Stats.SteeringTime, [](int8 Value) { return Value / 127.0; })));
+            bFirst = false;
+        }
+
+        Json += TEXT("],\"laps\":[");
+        for (int32 i = 0; i < Report.Laps.Num(); i++)
+        {
+            const FLap& Lap = Report.Laps[i];
+            Json += FString::Printf(TEXT("%s{\"vehicle\":%d,\"lap\":%d,\"start_time\":%.3f,\"time\":%.3f,\"distance\":%.1f}"),
+                i > 0 ? TEXT(",") : TEXT(""), Lap.Vehicle, Lap.Number, Lap.StartTime, Lap.Time, Lap.Distance);
+        }
+
+        Json += FString::Printf(TEXT("],\"speed_histogram\":{\"bin_width\":%.1f,\"seconds\":["), Options.SpeedBinWidth);
+        const TArray<double> SpeedBins = BuildSpeedHistogram(Report, Options.SpeedBinWidth);
+        for (int32 i = 0; i < SpeedBins.Num(); i++)
+        {
+            Json += FString::Printf(TEXT("%s%.3f"), i > 0 ? TEXT(",") : TEXT(""), SpeedBins[i]);
+        }
+
+        Json += FString::Printf(TEXT("]},\"heatmap\":{\"cell_size\":%.1f,\"cells\":["), Options.HeatmapCellSize);
+        bFirst = true;
+        for (const TPair<uint64, double>& Cell : Report.Heatmap)
+        {
+            double X, Y;
+            DecodeHeatmapKey(Cell.Key, Options.HeatmapCellSize, X, Y);
+            Json += FString::Printf(TEXT("%s[%.0f,%.0f,%.3f]"), bFirst ? TEXT("") : TEXT(","), X, Y, Cell.Value);
+            bFirst = false;
+        }
+        Json += TEXT("]}}\n");
+
+        return FFileHelper::SaveStringToFile(Json, *(Options.Output + TEXT(".json")));
+    }
+
+    bool ParseOptions(FOptions& Options)
+    {
+        TArray<FString> Tokens;
+        TArray<FString> Switches;
+        FCommandLine::Parse(FCommandLine::Get(), Tokens, Switches);
+        if (Tokens.Num() == 0)
+        {
+            return false;
+        }
+
+        const TCHAR* CommandLine = FCommandLine::Get();
+        Options.Input = Tokens[0];
+        Options.Output = FPaths::Combine(FPaths::GetPath(Options.Input), FPaths::GetBaseFilename(Options.Input));
+        FParse::Value(CommandLine, TEXT("Out="), Options.Output);
+        Options.bJson = FParse::Param(CommandLine, TEXT("Json"));
+        FParse::Value(CommandLine, TEXT("HeatmapCell="), Options.HeatmapCellSize);
+        FParse::Value(CommandLine, TEXT("SpeedBin="), Options.SpeedBinWidth);
+        Options.HeatmapCellSize = FMath::Max(Options.HeatmapCellSize, 1.0);
+        Options.SpeedBinWidth = FMath::Max(Options.SpeedBinWidth, 1.0);
+
+        FString Gate;
+        if (FParse::Value(CommandLine, TEXT("Gate="), Gate, false))
+        {
+            TArray<FString> Values;
+            Gate.ParseIntoArray(Values, TEXT(","));
+            if (Values.Num() != 3)
+            {
+                return false;
+            }
+            Options.bHasGate = true;
+            Options.GateCenter = FVector2D(FCString::Atod(*Values[0]), FCString::Atod(*Values[1]));
+            Options.GateRadius = FCString::Atod(*Values[2]);
+        }
+        return true;
+    }
+
+    template<typename T>
+    void CompareField(const FString& Name, T ValueA, T ValueB, int32& NumDifferences)
+    {
+        // Bitwise, so -0 vs 0 and differing NaNs count as well
+        if (FMemory::Memcmp(&ValueA, &ValueB, sizeof(T)) != 0)
+        {
+            UE_LOG(LogTemp, Display, TEXT("    %-20s %.17g vs %.17g"), *Name, double(ValueA), double(ValueB));
+            NumDifferences++;
+        }
+    }
+
+    int32 CompareVehicleFields(const VehicleDigestFormat::FVehicleFields& A, const VehicleDigestFormat::FVehicleFields& B)
+    {
+        static const TCHAR* Axes[] = { TEXT("X"), TEXT("Y"), TEXT("Z"), TEXT("W") };
+
+        int32 NumDifferences = 0;
+        CompareField(TEXT("RandomSeed"), A.RandomSeed, B.RandomSeed, NumDifferences);
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            CompareField(FString::Printf(TEXT("Location.%s"), Axes[Axis]), A.Location[Axis], B.Location[Axis], NumDifferences);
+        }
+        for (int32 Axis = 0; Axis < 4; Axis++)
+        {
+            CompareField(FString::Printf(TEXT("Rotation.%s"), Axes[Axis]), A.Rotation[Axis], B.Rotation[Axis], NumDifferences);
+        }
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            CompareField(FString::Printf(TEXT("LinearVelocity.%s"), Axes[Axis]), A.LinearVelocity[Axis], B.LinearVelocity[Axis], NumDifferences);
+            CompareField(FString::Printf(TEXT("AngularVelocity.%s"), Axes[Axis]), A.AngularVelocity[Axis], B.AngularVelocity[Axis], NumDifferences);
+        }
+        CompareField(TEXT("Throttle"), A.Throttle, B.Throttle, NumDifferences);
+        CompareField(TEXT("Steering"), A.Steering, B.Steering, NumDifferences);
+        CompareField(TEXT("Brake"), A.bBrake, B.bBrake, NumDifferences);
+        CompareField(TEXT("NextMoveSequence"), A.NextMoveSequence, B.NextMoveSequence, NumDifferences);
+        CompareField(TEXT("WheelSpinDegrees"), A.WheelSpinDegrees, B.WheelSpinDegrees, NumDifferences);
+        for (int32 Wheel = 0; Wheel < VehicleDigestFormat::MaxWheels; Wheel++)
+        {
+            CompareField(FString::Printf(TEXT("WheelRotation[%d]"), Wheel), A.WheelRotation[Wheel], B.WheelRotation[Wheel], NumDifferences);
+            CompareField(FString::Printf(TEXT("WheelSuspension[%d]"), Wheel), A.WheelSuspension[Wheel], B.WheelSuspension[Wheel], NumDifferences);
+        }
+        return NumDifferences;
+    }
+
+    // Logs the differences of one step. Vehicles are matched by name hash; at most
+    // MaxReported of them are dumped.
+    void ReportDivergence(const VehicleDigestFormat::FStepHeader& HeaderA, const VehicleDigestFormat::FVehicleFields* FieldsA,
+        const VehicleDigestFormat::FStepHeader& HeaderB, const VehicleDigestFormat::FVehicleFields* FieldsB)
+    {
+        constexpr int32 MaxReported = 16;
+
+        UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: Runs diverge at step %llu (digest %016llx vs %016llx)"), HeaderA.Step, HeaderA.Digest, HeaderB.Digest);
+        if (FMemory::Memcmp(&HeaderA.DeltaTime, &HeaderB.DeltaTime, sizeof(double)) != 0)
+        {
+            UE_LOG(LogTemp, Display, TEXT("  Step length %.17g vs %.17g; both runs need the same fixed step"), HeaderA.DeltaTime, HeaderB.DeltaTime);
+        }
+        if (HeaderA.NumVehicles != HeaderB.NumVehicles)
+        {
+            UE_LOG(LogTemp, Display, TEXT("  %u vs %u vehicles"), HeaderA.NumVehicles, HeaderB.NumVehicles);
+        }
+
+        int32 NumReported = 0;
+        for (uint32 i = 0; i < HeaderA.NumVehicles && NumReported < MaxReported; i++)
+        {
+            const VehicleDigestFormat::FVehicleFields& A = FieldsA[i];
+            const VehicleDigestFormat::FVehicleFields* B = nullptr;
+            for (uint32 j = 0; j < HeaderB.NumVehicles && !B; j++)
+            {
+                B = FieldsB[j].NameHash == A.NameHash ? &FieldsB[j] : nullptr;
+            }
+
+            if (!B)
+            {
+                UE_LOG(LogTemp, Display, TEXT("  Vehicle %08x only in the first run"), A.NameHash);
+                NumReported++;
+            }
+            else if (FMemory::Memcmp(&A, B, sizeof(A)) != 0)
+            {
+                UE_LOG(LogTemp, Display, TEXT("  Vehicle %08x:"), A.NameHash);
+                CompareVehicleFields(A, *B);
+                NumReported++;
+            }
+        }
+        for (uint32 j = 0; j < HeaderB.NumVehicles && NumReported < MaxReported; j++)
+        {
+            bool bInA = false;
+            for (uint32 i = 0; i < HeaderA.NumVehicles && !bInA; i++)
+            {
+                bInA = FieldsA[i].NameHash == FieldsB[j].NameHash;
+            }
+            if (!bInA)
+            {
+                UE_LOG(LogTemp, Display, TEXT("  Vehicle %08x only in the second run"), FieldsB[j].NameHash);
+                NumReported++;
+            }
+        }
+    }
+
+    // Walks two digest streams step by step; returns 0 if they are identical
+    int32 CompareDigests(const FString& FilenameA, const FString& FilenameB)
+    {
+        using VehicleDigestFormat::FStepHeader;
+        using VehicleDigestFormat::FVehicleFields;
+
+        auto OpenDigest = [](FMappedFile& File, const FString& Filename)
+        {
+            if (!File.Open(Filename) || File.Size < VehicleDigestFormat::HeaderSize
+                || ReadAt<uint32>(File.Data) != VehicleDigestFormat::Magic || ReadAt<uint32>(File.Data + 4) != VehicleDigestFormat::Version)
+            {
+                UE_LOG(LogTemp, Error, TEXT("VehicleTelemetryTool: %s is not a readable digest stream"), *Filename);
+                return false;
+            }
+            return true;
+        };
+
+        FMappedFile A;
+        FMappedFile B;
+        if (!OpenDigest(A, FilenameA) || !OpenDigest(B, FilenameB))
+        {
+            return 1;
+        }
+
+        // Steps whose header or fields run past the end (a run that was killed) are ignored
+        auto ReadStep = [](const FMappedFile& File, int64 Cursor, FStepHeader& OutHeader, const FVehicleFields*& OutFields)
+        {
+            if (Cursor + int64(sizeof(FStepHeader)) > File.Size)
+            {
+                return false;
+            }
+            OutHeader = ReadAt<FStepHeader>(File.Data + Cursor);
+            OutFields = reinterpret_cast<const FVehicleFields*>(File.Data + Cursor + sizeof(FStepHeader));
+            return Cursor + int64(sizeof(FStepHeader) + OutHeader.NumVehicles * sizeof(FVehicleFields)) <= File.Size;
+        };
+
+        int64 CursorA = VehicleDigestFormat::HeaderSize;
+        int64 CursorB = VehicleDigestFormat::HeaderSize;
+        uint64 NumSteps = 0;
+        for (;;)
+        {
+            FStepHeader HeaderA;
+            FStepHeader HeaderB;
+            const FVehicleFields* FieldsA = nullptr;
+            const FVehicleFields* FieldsB = nullptr;
+            const bool bHasA = ReadStep(A, CursorA, HeaderA, FieldsA);
+            const bool bHasB = ReadStep(B, CursorB, HeaderB, FieldsB);
+            if (!bHasA || !bHasB)
+            {
+                if (bHasA != bHasB)
+                {
+                    UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: Identical for %llu steps, then only the %s run continues"), NumSteps, bHasA ? TEXT("first") : TEXT("second"));
+                    return 1;
+                }
+                UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: Runs are identical over %llu steps"), NumSteps);
+                return 0;
+            }
+
+            if (HeaderA.Digest != HeaderB.Digest || HeaderA.NumVehicles != HeaderB.NumVehicles || FMemory::Memcmp(&HeaderA.DeltaTime, &HeaderB.DeltaTime, sizeof(double)) != 0)
+            {
+                ReportDivergence(HeaderA, FieldsA, HeaderB, FieldsB);
+                return 1;
+            }
+
+            CursorA += sizeof(FStepHeader) + HeaderA.NumVehicles * sizeof(FVehicleFields);
+            CursorB += sizeof(FStepHeader) + HeaderB.NumVehicles * sizeof(FVehicleFields);
+            NumSteps++;
+        }
+    }
+
+    // Columns of a CSV profiler capture (Saved/Profiling/CSV), one value per frame
+    struct FCsvCapture
+    {
+        TArray<FString> Columns;
+        TArray<TArray<double>> Values;
+
+        const TArray<double>* Find(const FString& Column) const
+        {
+            const int32 Index = Columns.IndexOfByKey(Column);
+            return Index != INDEX_NONE && Values[Index].Num() > 0 ? &Values[Index] : nullptr;
+        }
+    };
+
+    bool LoadCsvCapture(const FString& Filename, FCsvCapture& OutCapture)
+    {
+        TArray<FString> Lines;
+        if (!FFileHelper::LoadFileToStringArray(Lines, *Filename) || Lines.Num() < 2)
+        {
+            return false;
+        }
+
+        Lines[0].ParseIntoArray(OutCapture.Columns, TEXT(","), false);
+        OutCapture.Values.SetNum(OutCapture.Columns.Num());
+
+        // The profiler repeats the header and appends metadata after the last frame
+        TArray<FString> Cells;
+        for (int32 Line = 1; Line < Lines.Num() && Lines[Line] != Lines[0] && !Lines[Line].StartsWith(TEXT("[")); Line++)
+        {
+            Lines[Line].ParseIntoArray(Cells, TEXT(","), false);
+            for (int32 Column = 0; Column < FMath::Min(Cells.Num(), OutCapture.Columns.Num()); Column++)
+            {
+                if (Cells[Column].IsNumeric())
+                {
+                    OutCapture.Values[Column].Add(FCString::Atod(*Cells[Column]));
+                }
+            }
+        }
+        return true;
+    }
+
+    double PercentileOf(TArray<double> Values, double Percent)
+    {
+        Values.Sort();
+        const int32 Rank = FMath::CeilToInt32(Percent / 100.0 * Values.Num());
+        return Values[FMath::Clamp(Rank - 1, 0, Values.Num() - 1)];
+    }
+
+    struct FPerfMetric
+    {
+        FString Name;
+        double Value = 0.0;
+        double Threshold = 0.0;     // allowed regression in percent, 0 = reported only
+    };
+
+    // VehicleTelemetryTool -PerfGate <Capture.csv> -Baseline=<File.csv> [-Threshold=5] [-MemoryThreshold=5] [-PhysicsColumn=Name] [-UpdateBaseline]
+    int32 RunPerfGate(const FString& CaptureFilename)
+    {
+        const TCHAR* CommandLine = FCommandLine::Get();
+        FString BaselineFilename;
+        double Threshold = 5.0;
+        double MemoryThreshold = 5.0;
+        FString PhysicsColumn = TEXT("Exclusive/GameThread/Physics");
+        FParse::Value(CommandLine, TEXT("Baseline="), BaselineFilename);
+        FParse::Value(CommandLine, TEXT("Threshold="), Threshold);
+        FParse::Value(CommandLine, TEXT("MemoryThreshold="), MemoryThreshold);
+        FParse::Value(CommandLine, TEXT("PhysicsColumn="), PhysicsColumn, false);
+
+        FCsvCapture Capture;
+        if (BaselineFilename.IsEmpty() || !LoadCsvCapture(CaptureFilename, Capture))
+        {
+            UE_LOG(LogTemp, Error, TEXT("VehicleTelemetryTool: Needs a CSV capture and -Baseline=<File>"));
+            return 1;
+        }
+
+        // Thread times gate at p95 along with the frame time; memory gates on its peak
+        TArray<FPerfMetric> Metrics;
+        auto AddPercentile = [&Capture, &Metrics](const FString& Column, const FString& Name, double MetricThreshold)
+        {
+            if (const TArray<double>* Values = Capture.Find(Column))
+            {
+                Metrics.Add(FPerfMetric{ Name, PercentileOf(*Values, 95.0), MetricThreshold });
+            }
+        };
+        AddPercentile(TEXT("FrameTime"), TEXT("FrameTime.p95"), Threshold);
+        AddPercentile(TEXT("GameThreadTime"), TEXT("GameThreadTime.p95"), 0.0);
+        AddPercentile(TEXT("RenderThreadTime"), TEXT("RenderThreadTime.p95"), 0.0);
+        AddPercentile(TEXT("RHIThreadTime"), TEXT("RHIThreadTime.p95"), 0.0);
+        AddPercentile(TEXT("GPUTime"), TEXT("GPUTime.p95"), 0.0);
+        AddPercentile(PhysicsColumn, TEXT("Physics.p95"), 0.0);
+
+        const TArray<double>* Memory = Capture.Find(TEXT("VehiclePerf/PeakPhysicalUsedMB"));
+        Memory = Memory ? Memory : Capture.Find(TEXT("PhysicalUsedMB"));
+        if (Memory)
+        {
+            Metrics.Add(FPerfMetric{ TEXT("PhysicalUsedMB.peak"), FMath::Max(*Memory), MemoryThreshold });
+        }
+        if (const TArray<double>* Vehicles = Capture.Find(TEXT("VehiclePerf/Vehicles")))
+        {
+            Metrics.Add(FPerfMetric{ TEXT("Vehicles.max"), FMath::Max(*Vehicles), 0.0 });
+        }
+        Metrics.Add(FPerfMetric{ TEXT("Frames"), double(Capture.Values.Num() > 0 ? Capture.Values[0].Num() : 0), 0.0 });
+
+        if (FParse::Param(CommandLine, TEXT("UpdateBaseline")))
+        {
+            FString Baseline = TEXT("metric,value\n");
+            for (const FPerfMetric& Metric : Metrics)
+            {
+                Baseline += FString::Printf(TEXT("%s,%.6f\n"), *Metric.Name, Metric.Value);
+            }
+            if (!FFileHelper::SaveStringToFile(Baseline, *BaselineFilename))
+            {
+                UE_LOG(LogTemp, Error, TEXT("VehicleTelemetryTool: Could not write %s"), *BaselineFilename);
+                return 1;
+            }
+            UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: Baseline %s updated from %s"), *BaselineFilename, *CaptureFilename);
+            return 0;
+        }
+
+        TArray<FString> BaselineLines;
+        TMap<FString, double> BaselineValues;
+        if (!FFileHelper::LoadFileToStringArray(BaselineLines, *BaselineFilename))
+        {
+            UE_LOG(LogTemp, Error, TEXT("VehicleTelemetryTool: No baseline at %s (create one with -UpdateBaseline)"), *BaselineFilename);
+            return 1;
+        }
+        for (const FString& Line : BaselineLines)
+        {
+            FString Name, Value;
+            if (Line.Split(TEXT(","), &Name, &Value) && Value.IsNumeric())
+            {
+                BaselineValues.Add(Name, FCString::Atod(*Value));
+            }
+        }
+
+        int32 NumRegressions = 0;
+        for (const FPerfMetric& Metric : Metrics)
+        {
+            const double* BaselineValue = BaselineValues.Find(Metric.Name);
+            if (!BaselineValue)
+            {
+                UE_LOG(LogTemp, Display, TEXT("  %-22s %12.3f (not in baseline)"), *Metric.Name, Metric.Value);
+                continue;
+            }
+
+            const double ChangePercent = *BaselineValue != 0.0 ? (Metric.Value - *BaselineValue) / *BaselineValue * 100.0 : 0.0;
+            const bool bRegressed = Metric.Threshold > 0.0 && ChangePercent > Metric.Threshold;
+            NumRegressions += bRegressed ? 1 : 0;
+            UE_LOG(LogTemp, Display, TEXT("  %-22s %12.3f baseline %12.3f %+7.2f%%%s"),
+                *Metric.Name, Metric.Value, *BaselineValue, ChangePercent, bRegressed ? TEXT("  REGRESSION") : TEXT(""));
+        }
+
+        if (NumRegressions > 0)
+        {
+            UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: %d gated metrics regressed (frame time threshold %.1f%%, memory %.1f%%)"), NumRegressions, Threshold, MemoryThreshold);
+            return 1;
+        }
+        UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: Performance within thresholds"));
+        return 0;
+    }
+
+    int32 Run()
+    {
+        if (FParse::Param(FCommandLine::Get(), TEXT("PerfGate")))
+        {
+            TArray<FString> Tokens;
+            TArray<FString> Switches;
+            FCommandLine::Parse(FCommandLine::Get(), Tokens, Switches);
+            if (Tokens.Num() != 1)
+            {
+                UE_LOG(LogTemp, Display, TEXT("Usage: VehicleTelemetryTool -PerfGate <Capture.csv> -Baseline=<File.csv> [-Threshold=5] [-MemoryThreshold=5] [-PhysicsColumn=Name] [-UpdateBaseline]"));
+                return 1;
+            }
+            return RunPerfGate(Tokens[0]);
+        }
+
+        // VehicleTelemetryTool -CompareDigests <A.vdigest> <B.vdigest>
+        if (FParse::Param(FCommandLine::Get(), TEXT("CompareDigests")))
+        {
+            TArray<FString> Tokens;
+            TArray<FString> Switches;
+            FCommandLine::Parse(FCommandLine::Get(), Tokens, Switches);
+            if (Tokens.Num() != 2)
+            {
+                UE_LOG(LogTemp, Display, TEXT("Usage: VehicleTelemetryTool -CompareDigests <A.vdigest> <B.vdigest>"));
+                return 1;
+            }
+            return CompareDigests(Tokens[0], Tokens[1]);
+        }
+
+        FOptions Options;
+        if (!ParseOptions(Options))
+        {
+            UE_LOG(LogTemp, Display, TEXT("Usage: VehicleTelemetryTool <File.vreplay> [-Out=Path] [-Json] [-Gate=X,Y,Radius] [-HeatmapCell=500] [-SpeedBin=25]"));
+            return 1;
+        }
+
+        const double StartTime = FPlatformTime::Seconds();
+        FReplayFile File;
+        if (!File.Open(Options.Input))
+        {
+            UE_LOG(LogTemp, Error, TEXT("VehicleTelemetryTool: %s is not a readable replay"), *Options.Input);
+            return 1;
+        }
+
+        // A few batches per worker keeps threads busy when intervals differ in size
+        const int32 NumKeyframes = File.Keyframes.Num();
+        const int32 NumBatches = FMath::Clamp((FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) * 4, 1, NumKeyframes);
+        TArray<FBatchResult> Batches;
+        Batches.SetNum(NumBatches);
+        ParallelFor(NumBatches, [&](int32 Batch)
+        {
+            const int32 First = int64(NumKeyframes) * Batch / NumBatches;
+            const int32 End = int64(NumKeyframes) * (Batch + 1) / NumBatches;
+            ProcessBatch(File, Options, First, End, Batches[Batch]);
+        });
+
+        // Merge in file order, so gate events can be turned into laps per vehicle
+        FReport Report;
+        Report.VehicleNames = File.VehicleNames;
+        TArray<double> DistanceBefore;
+        TArray<TArray<FGateEvent>> Crossings;
+        for (FBatchResult& Batch : Batches)
+        {
+            if (Batch.Vehicles.Num() > Report.Vehicles.Num())
+            {
+                Report.Vehicles.SetNum(Batch.Vehicles.Num());
+                DistanceBefore.SetNumZeroed(Batch.Vehicles.Num());
+                Crossings.SetNum(Batch.Vehicles.Num());
+            }
+
+            for (FGateEvent& Event : Batch.GateEvents)
+            {
+                Event.Distance += DistanceBefore[Event.Vehicle];
+                Crossings[Event.Vehicle].Add(Event);
+            }
+            for (int32 i = 0; i < Batch.Vehicles.Num(); i++)
+            {
+                Report.Vehicles[i].Merge(Batch.Vehicles[i]);
+                DistanceBefore[i] += Batch.Vehicles[i].Distance;
+            }
+            for (const TPair<uint64, double>& Cell : Batch.Heatmap)
+            {
+                Report.Heatmap.FindOrAdd(Cell.Key) += Cell.Value;
+            }
+        }
+
+        for (int32 Vehicle = 0; Vehicle < Crossings.Num(); Vehicle++)
+        {
+            for (int32 i = 1; i < Crossings[Vehicle].Num(); i++)
+            {
+                const FGateEvent& Start = Crossings[Vehicle][i - 1];
+                const FGateEvent& Finish = Crossings[Vehicle][i];
+                Report.Laps.Add(FLap{ Vehicle, i, Start.Time, Finish.Time - Start.Time, Finish.Distance - Start.Distance });
+            }
+        }
+
+        const double ProcessSeconds = FPlatformTime::Seconds() - StartTime;
+        const bool bWritten = Options.bJson ? WriteJson(Report, Options) : WriteCsv(Report, Options);
+        if (!bWritten)
+        {
+            UE_LOG(LogTemp, Error, TEXT("VehicleTelemetryTool: Could not write %s"), *Options.Output);
+            return 1;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("VehicleTelemetryTool: %.1f MB, %d keyframes, %d vehicles, %d laps in %.2f s (%.0f MB/s, %d batches)"),
+            File.DataSize / (1024.0 * 1024.0), NumKeyframes, Report.Vehicles.Num(), Report.Laps.Num(), ProcessSeconds,
+            File.DataSize / (1024.0 * 1024.0) / FMath::Max(ProcessSeconds, 1e-6), NumBatches);
+        return 0;
+    }
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+    if (const int32 InitResult = GEngineLoop.PreInit(ArgC, ArgV))
+    {
+        return InitResult;
+    }
+
+    const int32 Result = Run();
+
+    RequestEngineExit(TEXT("VehicleTelemetryTool finished"));
+    FEngineLoop::AppPreExit();
+    FModuleManager::Get().UnloadModulesAtShutdown();
+    FEngineLoop::AppExit();
+    return Result;
+}